@@ -0,0 +1,162 @@
+#ifndef ADAPTIVEAA_H
+#define ADAPTIVEAA_H
+
+// Adaptive supersampling for the escape-time viewers.
+//
+// The frame is first rendered at one sample per pixel while the iteration
+// counts are kept in a buffer. Pixels whose iteration count differs strongly
+// from a neighbour sit on the fractal boundary, which is where aliasing shows;
+// only those pixels receive extra jittered sub-samples. The total number of
+// extra samples is capped by a budget, and when there are more boundary pixels
+// than the budget allows the contrast threshold is raised so the samples go to
+// the pixels with the largest jumps.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define AA_DEFAULT_CONTRAST 2          // Minimum iteration jump that marks a pixel as noisy
+#define AA_DEFAULT_BUDGET (800 * 800)  // Extra samples per frame (about one per pixel on average)
+#define AA_MIN_SAMPLES 4               // Extra samples given to every refined pixel
+#define AA_MAX_SAMPLES 16              // Upper bound on extra samples per pixel
+#define AA_CONTRAST_LEVELS 256
+
+// Returns the ARGB colour of the fractal at plane coordinate (x, y) and stores the
+// iteration count of the sample in 'iterations'
+typedef uint32_t (*AAPixelFunc)(double x, double y, int* iterations);
+
+typedef struct {
+    int enabled;
+    int contrast_threshold;
+    int sample_budget;
+    int refined_pixels;  // Statistics of the last pass
+    int samples_taken;
+    long long iterations;  // Iterations spent on the extra samples
+} AASettings;
+
+static AASettings aa_default_settings(void) {
+    AASettings settings;
+    settings.enabled = 1;
+    settings.contrast_threshold = AA_DEFAULT_CONTRAST;
+    settings.sample_budget = AA_DEFAULT_BUDGET;
+    settings.refined_pixels = 0;
+    settings.samples_taken = 0;
+    settings.iterations = 0;
+    return settings;
+}
+
+// Largest iteration difference between a pixel and its 4 neighbours
+static int aa_pixel_contrast(const int* iterations, int width, int height, int x, int y) {
+    int center = iterations[y * width + x];
+    int contrast = 0;
+    int diff;
+    if (x > 0 && (diff = abs(iterations[y * width + x - 1] - center)) > contrast) contrast = diff;
+    if (x < width - 1 && (diff = abs(iterations[y * width + x + 1] - center)) > contrast) contrast = diff;
+    if (y > 0 && (diff = abs(iterations[(y - 1) * width + x] - center)) > contrast) contrast = diff;
+    if (y < height - 1 && (diff = abs(iterations[(y + 1) * width + x] - center)) > contrast) contrast = diff;
+    return contrast;
+}
+
+// Small xorshift generator for the sub-sample jitter, seeded per pixel so a frame is reproducible
+static uint32_t aa_next_random(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Refines the noisy pixels of a 1-spp frame in place.
+// 'pixels' and 'iterations' are width x height buffers, pixel (px, py) was sampled at
+// (x_min + px * pixel_w, y_min + py * pixel_h). Returns the number of extra samples taken.
+static int aa_refine(AASettings* settings, uint32_t* pixels, const int* iterations, int width, int height,
+                     double x_min, double y_min, double pixel_w, double pixel_h, AAPixelFunc pixel_func) {
+    settings->refined_pixels = 0;
+    settings->samples_taken = 0;
+    settings->iterations = 0;
+    if (!settings->enabled || settings->sample_budget < AA_MIN_SAMPLES) {
+        return 0;
+    }
+
+    // Histogram of clamped contrast values, used to pick a threshold that fits the budget
+    int histogram[AA_CONTRAST_LEVELS];
+    memset(histogram, 0, sizeof(histogram));
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int contrast = aa_pixel_contrast(iterations, width, height, x, y);
+            if (contrast >= AA_CONTRAST_LEVELS) contrast = AA_CONTRAST_LEVELS - 1;
+            histogram[contrast]++;
+        }
+    }
+
+    int threshold = settings->contrast_threshold < 1 ? 1 : settings->contrast_threshold;
+    if (threshold >= AA_CONTRAST_LEVELS) threshold = AA_CONTRAST_LEVELS - 1;
+    int max_pixels = settings->sample_budget / AA_MIN_SAMPLES;
+    int noisy_pixels = 0;
+    for (int level = threshold; level < AA_CONTRAST_LEVELS; ++level) {
+        noisy_pixels += histogram[level];
+    }
+    while (noisy_pixels > max_pixels && threshold < AA_CONTRAST_LEVELS - 1) {
+        noisy_pixels -= histogram[threshold];
+        threshold++;
+    }
+    if (noisy_pixels == 0) {
+        return 0;
+    }
+
+    int samples_per_pixel = settings->sample_budget / noisy_pixels;
+    if (samples_per_pixel > AA_MAX_SAMPLES) samples_per_pixel = AA_MAX_SAMPLES;
+    if (samples_per_pixel < AA_MIN_SAMPLES) samples_per_pixel = AA_MIN_SAMPLES;
+
+    // Jittered grid: one random sample inside each cell of a grid_size x grid_size stratification
+    int grid_size = 1;
+    while ((grid_size + 1) * (grid_size + 1) <= samples_per_pixel) grid_size++;
+    samples_per_pixel = grid_size * grid_size;
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (settings->samples_taken + samples_per_pixel > settings->sample_budget) {
+                return settings->samples_taken;
+            }
+            int contrast = aa_pixel_contrast(iterations, width, height, x, y);
+            if (contrast < threshold) {
+                continue;
+            }
+
+            // The 1-spp sample counts as the first sample of the average
+            uint32_t base = pixels[y * width + x];
+            unsigned int sum_r = (base >> 16) & 0xFF;
+            unsigned int sum_g = (base >> 8) & 0xFF;
+            unsigned int sum_b = base & 0xFF;
+            uint32_t seed = (uint32_t)(y * width + x) * 2654435761u + 1u;
+
+            for (int s = 0; s < samples_per_pixel; ++s) {
+                int cell_x = s % grid_size;
+                int cell_y = s / grid_size;
+                double jitter_x = (aa_next_random(&seed) & 0xFFFF) / 65536.0;
+                double jitter_y = (aa_next_random(&seed) & 0xFFFF) / 65536.0;
+                // Sub-samples cover the pixel footprint centred on the original sample
+                double sample_x = x_min + (x + (cell_x + jitter_x) / grid_size - 0.5) * pixel_w;
+                double sample_y = y_min + (y + (cell_y + jitter_y) / grid_size - 0.5) * pixel_h;
+                int sample_iterations = 0;
+                uint32_t argb = pixel_func(sample_x, sample_y, &sample_iterations);
+                settings->iterations += sample_iterations;
+                sum_r += (argb >> 16) & 0xFF;
+                sum_g += (argb >> 8) & 0xFF;
+                sum_b += argb & 0xFF;
+            }
+
+            unsigned int count = (unsigned int)samples_per_pixel + 1;
+            pixels[y * width + x] = (base & 0xFF000000) |
+                                    (((sum_r + count / 2) / count) << 16) |
+                                    (((sum_g + count / 2) / count) << 8) |
+                                    ((sum_b + count / 2) / count);
+            settings->refined_pixels++;
+            settings->samples_taken += samples_per_pixel;
+        }
+    }
+    return settings->samples_taken;
+}
+
+#endif
@@ -4,6 +4,10 @@
 #include <math.h>
 #include <SDL2/SDL_ttf.h>
 #include <stdlib.h>
+#include "perfhud.h"
+#include "linebatch.h"
+#include "lineraster.h"
+#include "vecmath.h"
 
 // Window dimensions
 int g_window_width = 800;
@@ -43,6 +47,10 @@ Vec3D g_initial_aizawa_state = {0.1f, 0.0f, 0.0f};
 Vec3D* g_aizawa_points = NULL;
 int g_num_current_aizawa_points = 0;
 
+// The points as a structure of arrays, and the same points in pixels for the current view
+VecSoA g_aizawa_soa;
+VecSoA g_screen_points;
+
 // --- 2D Viewing Parameters ---
 float g_view_x_center = 0.0f; 
 float g_view_y_center = 0.0f; 
@@ -56,6 +64,10 @@ int g_last_mouse_x, g_last_mouse_y;
 SDL_Texture* g_aizawa_texture = NULL;
 SDL_Renderer* g_renderer = NULL;
 TTF_Font* g_font = NULL;
+LineBatch g_line_batch;
+LineRaster g_line_raster;
+bool g_software_lines = true;  // Draw with lineraster.h instead of SDL's lines
+bool g_antialias_lines = false;
 SDL_Window* g_window = NULL;
 
 
@@ -66,7 +78,7 @@ void calculateAizawaPoints();
 void drawAizawaToTexture();
 Vec3D aizawa_deriv(Vec3D current_state);
 void rk4_step_for_point(Vec3D* s, float dt_val); 
-void map_aizawa_to_pixel(float ax, float ay, int* px, int* py);
+void create_view_matrix(Mat4* out);
 void map_pixel_to_aizawa(int px, int py, float* ax, float* ay);
 void reset_aizawa_view_and_params();
 
@@ -101,10 +113,12 @@ void rk4_step_for_point(Vec3D* s, float dt_val) {
     s->z += (dt_val / 6.0f) * (k1.z + 2.0f * k2.z + 2.0f * k3.z + k4.z);
 }
 
-void map_aizawa_to_pixel(float ax, float ay, int* px, int* py) {
-    // Translate, scale, and center the point on the screen.
-    *px = (int)(g_window_width / 2.0f + (ax - g_view_x_center) * g_view_scale);
-    *py = (int)(g_window_height / 2.0f - (ay - g_view_y_center) * g_view_scale);
+// Maps Aizawa coordinates to pixels: translate, scale, and center the point on the
+// screen (y points up). The drawing code transforms all points with it in one batch.
+void create_view_matrix(Mat4* out) {
+    mat4_scale(out, g_view_scale, -g_view_scale, 1.0f);
+    out->c[3][0] = g_window_width / 2.0f - g_view_x_center * g_view_scale;
+    out->c[3][1] = g_window_height / 2.0f + g_view_y_center * g_view_scale;
 }
 
 void map_pixel_to_aizawa(int px, int py, float* ax, float* ay) {
@@ -160,6 +174,7 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename, int window_wid
 }
 
 void calculateAizawaPoints() {
+    perf_begin(PERF_COMPUTE);
     if (g_aizawa_points != NULL) {
         free(g_aizawa_points);
         g_aizawa_points = NULL;
@@ -169,6 +184,7 @@ void calculateAizawaPoints() {
     if (g_aizawa_points == NULL) {
         fprintf(stderr, "Error: Failed to allocate memory for Aizawa points!\n");
         g_num_current_aizawa_points = 0;
+        perf_end(PERF_COMPUTE);
         return;
     }
     g_num_current_aizawa_points = 0; 
@@ -180,21 +196,83 @@ void calculateAizawaPoints() {
         rk4_step_for_point(&s, g_dt);
     }
 
+    if (!vec_soa_gather(&g_aizawa_soa, &g_aizawa_points[0].x, (int)(sizeof(Vec3D) / sizeof(float)), g_num_current_aizawa_points)) {
+        g_num_current_aizawa_points = 0;
+    }
+
+    perf_end(PERF_COMPUTE);
+    perf_add_iterations(g_num_current_aizawa_points);
     printf("Finished calculating %d points.\n", g_num_current_aizawa_points);
 }
 
+// Draws the trajectory with lineraster.h and copies it to the current render target.
+// 'screen' holds the points in pixels. Returns the number of segments, or -1 if the
+// rasterizer is unavailable.
+long long drawAizawaSoftware(const VecSoA* screen) {
+    if (!line_raster_begin(&g_line_raster, g_window_width, g_window_height, 0xFF000000u)) {
+        g_software_lines = false;  // Out of memory; fall back to SDL's lines
+        return -1;
+    }
+    g_line_raster.antialias = g_antialias_lines;
+    line_raster_set_color(&g_line_raster, 255, 255, 255, 255);
+
+    float min_x_draw = -g_window_width * DRAW_BOUND_MULTIPLIER;
+    float max_x_draw = g_window_width * DRAW_BOUND_MULTIPLIER;
+    float min_y_draw = -g_window_height * DRAW_BOUND_MULTIPLIER;
+    float max_y_draw = g_window_height * DRAW_BOUND_MULTIPLIER;
+
+    // Unrounded positions, so anti-aliasing sees the exact lines
+    long long lines_drawn = 0;
+    bool prev_valid = false;
+    for (int i = SKIP_INITIAL_POINTS; i < screen->count; ++i) {
+        float x = screen->x[i], y = screen->y[i];
+        bool valid = x >= min_x_draw && x <= max_x_draw && y >= min_y_draw && y <= max_y_draw;
+        if (valid && prev_valid) {
+            line_raster_add_screen(&g_line_raster, screen->x[i - 1], screen->y[i - 1], 0.0, x, y, 0.0);
+            lines_drawn++;
+        }
+        prev_valid = valid;
+    }
+    line_raster_end(&g_line_raster);
+    line_raster_upload(&g_line_raster);
+    SDL_RenderCopy(g_renderer, g_line_raster.texture, NULL, NULL);
+    perf_add_thread_time(g_line_raster.thread_count, g_line_raster.busy_ms);
+    return lines_drawn;
+}
+
 void drawAizawaToTexture() {
     if (!g_renderer || !g_aizawa_texture || g_aizawa_points == NULL || g_num_current_aizawa_points < 2) {
         fprintf(stderr, "Error: Renderer, Texture, or Aizawa points not ready for drawing.\n");
         return;
     }
 
+    char view[160];
+    snprintf(view, sizeof(view), "a=%.2f b=%.2f c=%.2f d=%.2f e=%.2f f=%.2f dt=%.4f scale=%.1f center=(%.2f,%.2f)",
+             g_a, g_b, g_c, g_d, g_e, g_f, g_dt, g_view_scale, g_view_x_center, g_view_y_center);
+    perf_set_view(view);
+    perf_begin(PERF_COMPUTE);
+    long long lines_drawn = 0;
+
     SDL_SetRenderTarget(g_renderer, g_aizawa_texture);
     SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 0); 
     SDL_RenderClear(g_renderer);
+    Mat4 view_matrix;
+    create_view_matrix(&view_matrix);
+    mat4_transform_points(&view_matrix, &g_aizawa_soa, &g_screen_points);
+    const VecSoA* screen = &g_screen_points;
+
+    lines_drawn = g_software_lines ? drawAizawaSoftware(screen) : -1;
+    if (lines_drawn >= 0) {
+        SDL_SetRenderTarget(g_renderer, NULL);
+        perf_end(PERF_COMPUTE);
+        perf_add_pixels(lines_drawn);
+        return;
+    }
+    lines_drawn = 0;
     SDL_SetRenderDrawColor(g_renderer, 255, 255, 255, 255);
+    line_batch_begin(&g_line_batch, g_renderer);
 
-    int prev_px, prev_py;
+    int prev_px = 0, prev_py = 0;
     bool first_valid_point = true;
 
     float min_x_draw = -g_window_width * DRAW_BOUND_MULTIPLIER; 
@@ -202,10 +280,9 @@ void drawAizawaToTexture() {
     float min_y_draw = -g_window_height * DRAW_BOUND_MULTIPLIER;
     float max_y_draw = g_window_height * DRAW_BOUND_MULTIPLIER;
 
-    for (int i = SKIP_INITIAL_POINTS; i < g_num_current_aizawa_points; ++i) {
-        Vec3D current_point_3d = g_aizawa_points[i];
-        int current_px, current_py;
-        map_aizawa_to_pixel(current_point_3d.x, current_point_3d.y, &current_px, &current_py);
+    for (int i = SKIP_INITIAL_POINTS; i < screen->count; ++i) {
+        int current_px = (int)screen->x[i];
+        int current_py = (int)screen->y[i];
 
         bool current_point_is_valid = 
             current_px >= min_x_draw && current_px <= max_x_draw &&
@@ -219,7 +296,8 @@ void drawAizawaToTexture() {
             }
         } else {
             if (current_point_is_valid) {
-                SDL_RenderDrawLine(g_renderer, prev_px, prev_py, current_px, current_py);
+                line_batch_add(&g_line_batch, prev_px, prev_py, current_px, current_py);
+                lines_drawn++;
                 prev_px = current_px;
                 prev_py = current_py;
             } else {
@@ -227,7 +305,10 @@ void drawAizawaToTexture() {
             }
         }
     }
+    line_batch_end(&g_line_batch);
     SDL_SetRenderTarget(g_renderer, NULL);
+    perf_end(PERF_COMPUTE);
+    perf_add_pixels(lines_drawn);
 }
 
 
@@ -250,7 +331,9 @@ void reset_aizawa_view_and_params() {
     drawAizawaToTexture(); 
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    perf_init(argc, argv);
+
     printf("Left Click + Drag: Pan the view\n");
     printf("Mouse Wheel: Zoom in/out (centered on mouse cursor)\n");
     printf("Up/Down Arrows: Adjust 'A' parameter\n");
@@ -262,6 +345,7 @@ int main() {
     printf("Equals/Plus (+): Increase 'dt' (time step)\n");
     printf("Minus (-): Decrease 'dt' (time step)\n");
     printf("R: Reset view and parameters\n");
+    printf("F1: Toggle performance HUD\n");
     printf("Click 'Save' button to save an image.\n");
 
     // --- VSync/Rendering Hints for smoother output ---
@@ -307,6 +391,7 @@ int main() {
         return 1;
     }
     SDL_SetRenderDrawBlendMode(g_renderer, SDL_BLENDMODE_BLEND);
+    line_raster_init(&g_line_raster, g_renderer);
 
     if (SDL_GL_SetSwapInterval(1) < 0) {
         fprintf(stderr, "Warning: Unable to set VSync! SDL Error: %s\n", SDL_GetError());
@@ -348,6 +433,7 @@ int main() {
         bool re_draw_texture = false;
 
         while (SDL_PollEvent(&event)){
+            if (perf_handle_event(&event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
@@ -363,7 +449,9 @@ int main() {
                             mouseX <= screenshotButtonRect.x + screenshotButtonRect.w &&
                             mouseY >= screenshotButtonRect.y &&
                             mouseY <= screenshotButtonRect.y + screenshotButtonRect.h) {
+                            Uint64 trace_start = trace_begin();
                             saveScreenshot(g_renderer, "aizawa_attractor_screenshot.bmp", g_window_width, g_window_height);
+                            trace_end("screenshot", trace_start);
                         } else if (event.button.button == SDL_BUTTON_LEFT) {
                             g_is_panning = true;
                             g_last_mouse_x = mouseX;
@@ -476,6 +564,12 @@ int main() {
                         g_f += 0.01f;
                         printf("F increased to: %.2f\n", g_f);
                         re_calculate_points = true;
+                    } else if (event.key.keysym.sym == SDLK_b) {
+                        g_software_lines = !g_software_lines;
+                        re_draw_texture = true;
+                    } else if (event.key.keysym.sym == SDLK_l) {
+                        g_antialias_lines = !g_antialias_lines;
+                        re_draw_texture = true;
                     } else if (event.key.keysym.sym == SDLK_g) {
                         g_f -= 0.01f;
                         printf("F decreased to: %.2f\n", g_f);
@@ -528,11 +622,14 @@ int main() {
         // --- Rendering to screen ---
         SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 255);
         SDL_RenderClear(g_renderer);
+        perf_begin(PERF_DRAW);
         SDL_RenderCopy(g_renderer, g_aizawa_texture, NULL, NULL);
+        perf_end(PERF_DRAW);
 
         // Render info texts
         SDL_Rect screenshotButtonRect = {g_window_width - 120, 10, 110, 30};
 
+        perf_begin(PERF_TEXT);
         char text_buffer[200];
         SDL_Color textColor = {255, 255, 255, 255};
 
@@ -551,9 +648,10 @@ int main() {
         snprintf(text_buffer, sizeof(text_buffer), "View Scale: %.1f", g_view_scale);
         renderText(g_renderer, g_font, text_buffer, 10, 90, textColor);
 
+        renderText(g_renderer, g_font, "B: Software/SDL Lines, L: Anti-Aliasing", 10, g_window_height - 90, textColor);
         renderText(g_renderer, g_font, "Left Drag: Pan, Wheel: Zoom (to mouse cursor)", 10, g_window_height - 70, textColor);
         renderText(g_renderer, g_font, "Up/Down: A, Left/Right: B, C/V: C, N/M: D, E/W: E, F/G: F", 10, g_window_height - 50, textColor);
-        renderText(g_renderer, g_font, "+/-: dt, R: Reset View & Params", 10, g_window_height - 30, textColor);
+        renderText(g_renderer, g_font, "+/-: dt, R: Reset View & Params, F1: Perf HUD", 10, g_window_height - 30, textColor);
 
 
         // Draw and render text for the screenshot button
@@ -565,15 +663,24 @@ int main() {
         SDL_Color buttonTextColor = {255, 255, 255, 255};
         snprintf(text_buffer, sizeof(text_buffer), "Save");
         renderText(g_renderer, g_font, text_buffer, screenshotButtonRect.x + 8, screenshotButtonRect.y + 5, buttonTextColor);
+        perf_end(PERF_TEXT);
+        perf_draw_hud(g_renderer, g_font);
 
+        perf_begin(PERF_PRESENT);
         SDL_RenderPresent(g_renderer);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
     }
 
     // --- Cleanup ---
+    perf_shutdown();
+    line_raster_shutdown(&g_line_raster);
     if (g_aizawa_points != NULL) {
         free(g_aizawa_points);
         g_aizawa_points = NULL;
     }
+    vec_soa_free(&g_aizawa_soa);
+    vec_soa_free(&g_screen_points);
     if (g_aizawa_texture != NULL) {
         SDL_DestroyTexture(g_aizawa_texture);
         g_aizawa_texture = NULL;
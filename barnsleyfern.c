@@ -3,14 +3,19 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include <time.h>
 #include <math.h>
+#include "perfhud.h"
+#include "ifs.h"
 
 // Initial Window dimensions
 #define INITIAL_WIDTH 800
 #define INITIAL_HEIGHT 800
 
-#define NUM_FERN_POINTS 8000000
+#define NUM_FERN_POINTS 32000000
+#define FERN_MAX_THREADS 64
 
 #define SKIP_INITIAL_POINTS 20
 
@@ -32,6 +37,14 @@ double g_view_scale = 1.0;
 bool g_is_panning = false;
 int g_last_mouse_x, g_last_mouse_y;
 
+// The classic fern, used unless --ifs names a system file (see ifs/ and ifs.h)
+const char* g_default_ifs =
+    "name Barnsley fern\n"
+    "0.00  0.00  0.00  0.16 0.00 0.00 0.01\n"  // Stem
+    "0.85  0.04 -0.04  0.85 0.00 1.60 0.85\n"  // Successively smaller leaflets
+    "0.20 -0.26  0.23  0.22 0.00 1.60 0.07\n"  // Largest left-hand leaflet
+    "-0.15 0.28  0.26  0.24 0.00 0.44 0.07\n"; // Largest right-hand leaflet
+
 // --- Forward Declarations ---
 void renderText(SDL_Renderer* renderer, TTF_Font* font, const char* text, int x, int y, SDL_Color color);
 void saveScreenshot(SDL_Renderer* renderer, const char* filename, int window_width, int window_height);
@@ -94,6 +107,678 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename, int window_wid
 }
 
 
+// --- Parallel chaos game ---
+// The attractor does not depend on the view, so the orbit is generated once into a
+// point cloud and pan/zoom only re-rasterize it. The cloud is binned on a regular grid
+// over the fern's bounding box and each point is stored as 16-bit offsets inside its
+// bin (4 bytes per point), so a zoomed-in view only reads the bins it can see.
+//
+// Generation runs one walker thread per CPU, each advancing IFS_LANES points of the
+// loaded system (ifs.h) with private PRNGs. It takes two passes over the same random
+// sequence: the first counts points per bin, the second writes each
+// point straight into its slot, so no temporary point list is needed. Rasterizing
+// splits the visible bin rows over the same number of threads, each counting hits in
+// a private histogram; the histograms are summed and the log density is tone-mapped
+// into one texture upload.
+
+// Grid over the system's bounding box, padded so points on its edge fall inside
+#define FERN_GRID_SIZE 256
+#define FERN_BIN_COUNT (FERN_GRID_SIZE * FERN_GRID_SIZE)
+#define FERN_GRID_PADDING 0.01
+
+typedef struct {
+    double x_min, y_min;  // Corner of bin 0
+    double bin_width, bin_height;
+    uint32_t bin_start[FERN_BIN_COUNT + 1];  // Points of bin b are [bin_start[b], bin_start[b + 1])
+    uint16_t* offset_x;  // Position inside the bin in 1/65536 of the bin size
+    uint16_t* offset_y;
+    long long count;
+} FernCloud;
+
+typedef enum {
+    FERN_COUNT_BINS,
+    FERN_WRITE_POINTS,
+    FERN_RASTERIZE,
+    FERN_IFS_PIECES,
+    FERN_ACCUMULATE
+} FernJob;
+
+typedef struct {
+    int index;
+    FernJob job;
+    // Generation
+    uint64_t seed;
+    long long num_points;
+    uint32_t* bin_counts;  // FERN_BIN_COUNT entries: counts, then write cursors
+    // Rasterizing
+    uint32_t* histogram;  // texture_width * texture_height hit counts
+    int texture_width, texture_height;
+    double view_x_center, view_y_center, view_scale;
+    int bin_x_min, bin_x_max, bin_y_min, bin_y_max;  // Visible bins, inclusive
+    // Progressive accumulation
+    IfsLanes* lanes;        // Walkers that persist across batches
+    // Deterministic IFS
+    double weight_scale;    // Histogram units per unit of measure
+    long long leaf_budget;
+    bool truncated;
+    long long points_read;  // Cloud points read, or pieces tested
+    long long hits;         // Cloud points or pieces plotted
+    double busy_ms;
+} FernWorker;
+
+IfsSystem g_ifs;
+FernCloud g_fern_cloud;
+uint32_t* g_fern_bin_counts = NULL;  // One FERN_BIN_COUNT table per worker
+uint32_t* g_fern_histograms = NULL;  // One histogram per worker, back to back
+uint32_t* g_fern_density = NULL;     // Sum of the worker histograms
+uint32_t* g_fern_pixels = NULL;
+size_t g_fern_buffer_pixels = 0;
+int g_fern_thread_count = 1;
+long long g_fern_points_visible = 0;
+
+// Both generation passes replay the same walk from the worker's seed
+void runFernWalker(FernWorker* worker) {
+    IfsLanes lanes;
+    ifs_lanes_init(&lanes, worker->seed);
+    const double bin_scale_x = 1.0 / g_fern_cloud.bin_width;
+    const double bin_scale_y = 1.0 / g_fern_cloud.bin_height;
+
+    for (int i = 0; i < SKIP_INITIAL_POINTS; ++i) {
+        ifs_lanes_step(&g_ifs, &lanes);
+    }
+
+    long long remaining = worker->num_points;
+    while (remaining > 0) {
+        ifs_lanes_step(&g_ifs, &lanes);
+        int lane_count = remaining < IFS_LANES ? (int)remaining : IFS_LANES;
+        remaining -= lane_count;
+
+        for (int lane = 0; lane < lane_count; ++lane) {
+            double gx = (lanes.x[lane] - g_fern_cloud.x_min) * bin_scale_x;
+            double gy = (lanes.y[lane] - g_fern_cloud.y_min) * bin_scale_y;
+            if (!(gx >= 0.0 && gx < FERN_GRID_SIZE && gy >= 0.0 && gy < FERN_GRID_SIZE)) {
+                continue;  // Also drops NaN from nonlinear variations
+            }
+            int bin_x = (int)gx;
+            int bin_y = (int)gy;
+            int bin = bin_y * FERN_GRID_SIZE + bin_x;
+
+            if (worker->job == FERN_COUNT_BINS) {
+                worker->bin_counts[bin]++;
+            } else {
+                uint32_t slot = worker->bin_counts[bin]++;
+                g_fern_cloud.offset_x[slot] = (uint16_t)((gx - bin_x) * 65536.0);
+                g_fern_cloud.offset_y[slot] = (uint16_t)((gy - bin_y) * 65536.0);
+            }
+        }
+    }
+}
+
+// Projects the cloud points of the visible bin rows assigned to this worker
+void rasterizeFernBins(FernWorker* worker) {
+    int width = worker->texture_width;
+    int height = worker->texture_height;
+    memset(worker->histogram, 0, sizeof(uint32_t) * width * height);
+
+    double scale = worker->view_scale;
+    double step_x = g_fern_cloud.bin_width / 65536.0 * scale;
+    double step_y = g_fern_cloud.bin_height / 65536.0 * scale;
+    long long points_read = 0;
+    long long hits = 0;
+
+    for (int bin_y = worker->bin_y_min + worker->index; bin_y <= worker->bin_y_max; bin_y += g_fern_thread_count) {
+        // Pixel position of the bin's corner; +0.5 so truncation rounds to the nearest pixel
+        double origin_fy = height / 2.0 + 0.5 - (g_fern_cloud.y_min + bin_y * g_fern_cloud.bin_height - worker->view_y_center) * scale;
+        for (int bin_x = worker->bin_x_min; bin_x <= worker->bin_x_max; ++bin_x) {
+            int bin = bin_y * FERN_GRID_SIZE + bin_x;
+            uint32_t first = g_fern_cloud.bin_start[bin];
+            uint32_t last = g_fern_cloud.bin_start[bin + 1];
+            double origin_fx = width / 2.0 + 0.5 + (g_fern_cloud.x_min + bin_x * g_fern_cloud.bin_width - worker->view_x_center) * scale;
+            points_read += last - first;
+
+            for (uint32_t i = first; i < last; ++i) {
+                double fx = origin_fx + (g_fern_cloud.offset_x[i] + 0.5) * step_x;
+                double fy = origin_fy - (g_fern_cloud.offset_y[i] + 0.5) * step_y;
+                if (fx >= 0.0 && fx < width && fy >= 0.0 && fy < height) {
+                    worker->histogram[(int)fy * width + (int)fx]++;
+                    hits++;
+                }
+            }
+        }
+    }
+    worker->points_read = points_read;
+    worker->hits = hits;
+}
+
+// Runs the worker's persistent walkers for another batch, adding the hits inside the
+// view to its histogram
+void accumulateFernPoints(FernWorker* worker) {
+    int width = worker->texture_width;
+    int height = worker->texture_height;
+    double scale = worker->view_scale;
+    // Pixel position of the world origin; +0.5 so truncation rounds to the nearest pixel
+    double origin_fx = width / 2.0 + 0.5 - worker->view_x_center * scale;
+    double origin_fy = height / 2.0 + 0.5 + worker->view_y_center * scale;
+    IfsLanes* lanes = worker->lanes;
+    long long steps = (worker->num_points + IFS_LANES - 1) / IFS_LANES;
+    long long hits = 0;
+
+    for (long long step = 0; step < steps; ++step) {
+        ifs_lanes_step(&g_ifs, lanes);
+        for (int lane = 0; lane < IFS_LANES; ++lane) {
+            double fx = origin_fx + lanes->x[lane] * scale;
+            double fy = origin_fy - lanes->y[lane] * scale;
+            if (fx >= 0.0 && fx < width && fy >= 0.0 && fy < height) {
+                worker->histogram[(int)fy * width + (int)fx]++;
+                hits++;
+            }
+        }
+    }
+    worker->points_read = steps * IFS_LANES;
+    worker->hits = hits;
+}
+
+// --- Deterministic IFS ---
+// Deep zooms starve the chaos game: almost every cloud point lands off-screen. This mode
+// instead walks the address tree of the maps. The piece with address i1 i2 ... ik is
+// f_i1(f_i2(...f_ik(fern))), so it lies inside the image of the system's bounding box under
+// that composition. A piece whose box misses the viewport is culled with its whole subtree,
+// and one whose box is smaller than a pixel is plotted, weighted by the product of its map
+// probabilities (the share of chaos-game points it would receive). The work depends on the
+// number of visible pixel-sized pieces, not on the zoom level. It needs a box that provably
+// contains the attractor, so it is only offered for contracting affine systems.
+//
+// The pieces are composed with the view transform, so boxes are tested in pixel space. The
+// main thread expands the tree breadth-first into a list of seed pieces, and the workers
+// pull seeds from the list and finish each subtree depth-first into their own histograms.
+
+#define FERN_IFS_MAX_DEPTH 256
+#define FERN_IFS_SEEDS_PER_THREAD 16
+#define FERN_IFS_MAX_SEEDS (4 * FERN_IFS_SEEDS_PER_THREAD * FERN_MAX_THREADS)
+#define FERN_IFS_MAX_LEAVES 16000000  // Upper bound on plotted pieces per frame, split over the workers
+
+typedef struct {
+    IfsAffine map;  // View transform after the maps along the address
+    double measure;  // Product of the map probabilities along the address
+    int depth;
+} FernPiece;
+
+typedef enum {
+    FERN_PIECE_CULLED,
+    FERN_PIECE_LEAF,
+    FERN_PIECE_SPLIT
+} FernPieceClass;
+
+bool g_fern_deterministic = false;
+FernPiece g_fern_seeds[FERN_IFS_MAX_SEEDS];
+FernPiece g_fern_seed_scratch[FERN_IFS_MAX_SEEDS];
+int g_fern_seed_count = 0;
+SDL_atomic_t g_fern_next_seed;
+bool g_fern_ifs_truncated = false;
+
+// Tests the piece's pixel-space box against the texture. For leaves, (*px, *py) is the box centre.
+FernPieceClass classifyFernPiece(const FernPiece* piece, int width, int height, double* px, double* py) {
+    double cx, cy, hx, hy;
+    ifs_transform_box(&piece->map, (g_ifs.x_min + g_ifs.x_max) / 2.0, (g_ifs.y_min + g_ifs.y_max) / 2.0,
+                      (g_ifs.x_max - g_ifs.x_min) / 2.0, (g_ifs.y_max - g_ifs.y_min) / 2.0, &cx, &cy, &hx, &hy);
+
+    if (cx + hx < 0.0 || cx - hx >= width || cy + hy < 0.0 || cy - hy >= height) {
+        return FERN_PIECE_CULLED;
+    }
+    if ((hx < 0.5 && hy < 0.5) || piece->depth >= FERN_IFS_MAX_DEPTH) {
+        *px = cx;
+        *py = cy;
+        return FERN_PIECE_LEAF;
+    }
+    return FERN_PIECE_SPLIT;
+}
+
+void makeFernChild(const FernPiece* parent, int map_index, FernPiece* child) {
+    ifs_compose(&parent->map, &g_ifs.maps[map_index].affine, &child->map);
+    child->measure = parent->measure * g_ifs.probability[map_index];
+    child->depth = parent->depth + 1;
+}
+
+void plotFernLeaf(FernWorker* worker, const FernPiece* piece, double px, double py) {
+    if (px < 0.0 || px >= worker->texture_width || py < 0.0 || py >= worker->texture_height) {
+        return;  // Box overlaps the texture but its centre does not
+    }
+    // +1 so pieces far below the quantization step still light their pixel
+    worker->histogram[(int)py * worker->texture_width + (int)px] += (uint32_t)(piece->measure * worker->weight_scale) + 1;
+    worker->hits++;
+}
+
+// Depth-first over the children of a piece that needs splitting
+void recurseFernPiece(FernWorker* worker, const FernPiece* piece) {
+    for (int i = 0; i < g_ifs.map_count; ++i) {
+        if (worker->hits >= worker->leaf_budget) {
+            worker->truncated = true;
+            return;
+        }
+        FernPiece child;
+        double px, py;
+        makeFernChild(piece, i, &child);
+        worker->points_read++;
+
+        FernPieceClass piece_class = classifyFernPiece(&child, worker->texture_width, worker->texture_height, &px, &py);
+        if (piece_class == FERN_PIECE_LEAF) {
+            plotFernLeaf(worker, &child, px, py);
+        } else if (piece_class == FERN_PIECE_SPLIT) {
+            recurseFernPiece(worker, &child);
+        }
+    }
+}
+
+// Finishes seed pieces until the shared list is exhausted
+void renderFernPieces(FernWorker* worker) {
+    memset(worker->histogram, 0, sizeof(uint32_t) * worker->texture_width * worker->texture_height);
+    worker->points_read = 0;
+    worker->hits = 0;
+    worker->truncated = false;
+
+    for (;;) {
+        int seed = SDL_AtomicAdd(&g_fern_next_seed, 1);
+        if (seed >= g_fern_seed_count) {
+            break;
+        }
+        const FernPiece* piece = &g_fern_seeds[seed];
+        double px, py;
+        FernPieceClass piece_class = classifyFernPiece(piece, worker->texture_width, worker->texture_height, &px, &py);
+        if (piece_class == FERN_PIECE_LEAF) {
+            plotFernLeaf(worker, piece, px, py);
+        } else if (piece_class == FERN_PIECE_SPLIT) {
+            recurseFernPiece(worker, piece);
+        }
+    }
+}
+
+// Expands the visible part of the tree breadth-first until there are enough seeds to
+// share between the workers. Returns the summed measure of the seeds.
+double expandFernSeeds(int texture_width, int texture_height) {
+    FernPiece root;
+    double px, py;
+    // World to pixel, y pointing down; +0.5 so truncation rounds to the nearest pixel
+    root.map = (IfsAffine){g_view_scale, 0.0, 0.0, -g_view_scale,
+                            texture_width / 2.0 + 0.5 - g_view_x_center * g_view_scale,
+                            texture_height / 2.0 + 0.5 + g_view_y_center * g_view_scale};
+    root.measure = 1.0;
+    root.depth = 0;
+
+    g_fern_seed_count = 0;
+    if (classifyFernPiece(&root, texture_width, texture_height, &px, &py) != FERN_PIECE_CULLED) {
+        g_fern_seeds[g_fern_seed_count++] = root;
+    }
+
+    int target = FERN_IFS_SEEDS_PER_THREAD * g_fern_thread_count;
+    bool split_any = true;
+    while (split_any && g_fern_seed_count < target && g_fern_seed_count * g_ifs.map_count <= FERN_IFS_MAX_SEEDS) {
+        int count = 0;
+        split_any = false;
+        for (int s = 0; s < g_fern_seed_count; ++s) {
+            const FernPiece* piece = &g_fern_seeds[s];
+            if (classifyFernPiece(piece, texture_width, texture_height, &px, &py) != FERN_PIECE_SPLIT) {
+                g_fern_seed_scratch[count++] = *piece;  // Leaves are plotted by whichever worker takes them
+                continue;
+            }
+            split_any = true;
+            for (int i = 0; i < g_ifs.map_count; ++i) {
+                FernPiece* child = &g_fern_seed_scratch[count];
+                makeFernChild(piece, i, child);
+                if (classifyFernPiece(child, texture_width, texture_height, &px, &py) != FERN_PIECE_CULLED) {
+                    count++;
+                }
+            }
+        }
+        memcpy(g_fern_seeds, g_fern_seed_scratch, sizeof(FernPiece) * count);
+        g_fern_seed_count = count;
+    }
+
+    double measure = 0.0;
+    for (int s = 0; s < g_fern_seed_count; ++s) {
+        measure += g_fern_seeds[s].measure;
+    }
+    SDL_AtomicSet(&g_fern_next_seed, 0);
+    return measure;
+}
+
+int fernWorkerThread(void* data) {
+    FernWorker* worker = (FernWorker*)data;
+    Uint64 start = SDL_GetPerformanceCounter();
+    char lane_name[32];
+    snprintf(lane_name, sizeof(lane_name), "fern worker %d", worker->index);
+    trace_set_thread_name(lane_name);
+
+    const char* trace_name;
+    switch (worker->job) {
+        case FERN_RASTERIZE:
+            rasterizeFernBins(worker);
+            trace_name = "rasterize";
+            break;
+        case FERN_IFS_PIECES:
+            renderFernPieces(worker);
+            trace_name = "ifs_pieces";
+            break;
+        case FERN_ACCUMULATE:
+            accumulateFernPoints(worker);
+            trace_name = "accumulate";
+            break;
+        case FERN_COUNT_BINS:
+            runFernWalker(worker);
+            trace_name = "count_bins";
+            break;
+        default:
+            runFernWalker(worker);
+            trace_name = "write_points";
+            break;
+    }
+
+    Uint64 end = SDL_GetPerformanceCounter();
+    worker->busy_ms = perf_ms_between(start, end);
+    trace_record(trace_name, start, end);
+    return 0;
+}
+
+// Runs worker 0 on this thread and the others on their own threads. Returns the summed busy time.
+double runFernWorkers(FernWorker* workers) {
+    SDL_Thread* threads[FERN_MAX_THREADS];
+    for (int t = 1; t < g_fern_thread_count; ++t) {
+        threads[t] = SDL_CreateThread(fernWorkerThread, "fern worker", &workers[t]);
+        if (threads[t] == NULL) {
+            fernWorkerThread(&workers[t]);  // Fall back to running it inline
+        }
+    }
+    fernWorkerThread(&workers[0]);
+    trace_set_thread_name("main");
+
+    double busy_ms = workers[0].busy_ms;
+    for (int t = 1; t < g_fern_thread_count; ++t) {
+        if (threads[t] != NULL) {
+            SDL_WaitThread(threads[t], NULL);
+        }
+        busy_ms += workers[t].busy_ms;
+    }
+    return busy_ms;
+}
+
+// Generates the binned point cloud. Called once; returns false if memory runs out.
+bool generateFernCloud() {
+    printf("Generating %s point cloud with %d points on %d threads...\n", g_ifs.name, NUM_FERN_POINTS, g_fern_thread_count);
+    perf_set_view("generate point cloud");
+    perf_begin(PERF_COMPUTE);
+
+    double pad_x = (g_ifs.x_max - g_ifs.x_min) * FERN_GRID_PADDING;
+    double pad_y = (g_ifs.y_max - g_ifs.y_min) * FERN_GRID_PADDING;
+    g_fern_cloud.x_min = g_ifs.x_min - pad_x;
+    g_fern_cloud.y_min = g_ifs.y_min - pad_y;
+    g_fern_cloud.bin_width = (g_ifs.x_max - g_ifs.x_min + 2.0 * pad_x) / FERN_GRID_SIZE;
+    g_fern_cloud.bin_height = (g_ifs.y_max - g_ifs.y_min + 2.0 * pad_y) / FERN_GRID_SIZE;
+
+    g_fern_bin_counts = (uint32_t*)calloc((size_t)FERN_BIN_COUNT * g_fern_thread_count, sizeof(uint32_t));
+    g_fern_cloud.offset_x = (uint16_t*)malloc(sizeof(uint16_t) * NUM_FERN_POINTS);
+    g_fern_cloud.offset_y = (uint16_t*)malloc(sizeof(uint16_t) * NUM_FERN_POINTS);
+    if (g_fern_bin_counts == NULL || g_fern_cloud.offset_x == NULL || g_fern_cloud.offset_y == NULL) {
+        fprintf(stderr, "Failed to allocate the Barnsley Fern point cloud.\n");
+        free(g_fern_bin_counts);
+        free(g_fern_cloud.offset_x);
+        free(g_fern_cloud.offset_y);
+        g_fern_bin_counts = NULL;
+        g_fern_cloud.offset_x = NULL;
+        g_fern_cloud.offset_y = NULL;
+        perf_end(PERF_COMPUTE);
+        return false;
+    }
+
+    uint64_t base_seed = ((uint64_t)time(NULL) << 20) ^ 0x9E3779B97F4A7C15ull;
+    FernWorker workers[FERN_MAX_THREADS];
+    memset(workers, 0, sizeof(workers));
+    for (int t = 0; t < g_fern_thread_count; ++t) {
+        workers[t].index = t;
+        workers[t].job = FERN_COUNT_BINS;
+        workers[t].seed = (base_seed + (uint64_t)t * 0xD1B54A32D192ED03ull) | 1;  // xorshift state must be non-zero
+        workers[t].num_points = NUM_FERN_POINTS / g_fern_thread_count + (t < NUM_FERN_POINTS % g_fern_thread_count);
+        workers[t].bin_counts = g_fern_bin_counts + (size_t)t * FERN_BIN_COUNT;
+    }
+    double busy_ms = runFernWorkers(workers);
+
+    // Turn the per-worker counts into write cursors: bin by bin, worker by worker
+    uint32_t total = 0;
+    for (int bin = 0; bin < FERN_BIN_COUNT; ++bin) {
+        g_fern_cloud.bin_start[bin] = total;
+        for (int t = 0; t < g_fern_thread_count; ++t) {
+            uint32_t count = workers[t].bin_counts[bin];
+            workers[t].bin_counts[bin] = total;
+            total += count;
+        }
+    }
+    g_fern_cloud.bin_start[FERN_BIN_COUNT] = total;
+    g_fern_cloud.count = total;
+
+    for (int t = 0; t < g_fern_thread_count; ++t) {
+        workers[t].job = FERN_WRITE_POINTS;
+    }
+    busy_ms += runFernWorkers(workers);
+
+    free(g_fern_bin_counts);
+    g_fern_bin_counts = NULL;
+
+    perf_end(PERF_COMPUTE);
+    perf_add_iterations(2LL * NUM_FERN_POINTS);
+    perf_add_pixels(g_fern_cloud.count);
+    perf_add_thread_time(g_fern_thread_count, busy_ms);
+    perf_add_cache(0);
+    printf("Point cloud ready: %lld points in %d bins (%.1f MB).\n", g_fern_cloud.count, FERN_BIN_COUNT,
+           (g_fern_cloud.count * 2.0 * sizeof(uint16_t) + sizeof(g_fern_cloud.bin_start)) / (1024.0 * 1024.0));
+    return true;
+}
+
+// Grows the histogram and pixel buffers for the current texture size. Returns false on failure.
+bool ensureFernBuffers(int texture_width, int texture_height) {
+    size_t pixel_count = (size_t)texture_width * texture_height;
+    if (pixel_count <= g_fern_buffer_pixels && g_fern_histograms != NULL) {
+        return true;
+    }
+    free(g_fern_histograms);
+    free(g_fern_density);
+    free(g_fern_pixels);
+    g_fern_histograms = (uint32_t*)malloc(sizeof(uint32_t) * pixel_count * g_fern_thread_count);
+    g_fern_density = (uint32_t*)malloc(sizeof(uint32_t) * pixel_count);
+    g_fern_pixels = (uint32_t*)malloc(sizeof(uint32_t) * pixel_count);
+    if (g_fern_histograms == NULL || g_fern_density == NULL || g_fern_pixels == NULL) {
+        fprintf(stderr, "Failed to allocate Barnsley Fern histograms for %dx%d.\n", texture_width, texture_height);
+        free(g_fern_histograms);
+        free(g_fern_density);
+        free(g_fern_pixels);
+        g_fern_histograms = NULL;
+        g_fern_density = NULL;
+        g_fern_pixels = NULL;
+        g_fern_buffer_pixels = 0;
+        return false;
+    }
+    g_fern_buffer_pixels = pixel_count;
+    return true;
+}
+
+// Clamps the bins covering world coordinates [lo, hi] to the grid; returns false if none overlap
+bool fernBinRange(double lo, double hi, double origin, double bin_size, int* first, int* last) {
+    double first_bin = floor((lo - origin) / bin_size);
+    double last_bin = floor((hi - origin) / bin_size);
+    if (last_bin < 0 || first_bin >= FERN_GRID_SIZE) {
+        return false;
+    }
+    *first = first_bin < 0 ? 0 : (int)first_bin;
+    *last = last_bin >= FERN_GRID_SIZE ? FERN_GRID_SIZE - 1 : (int)last_bin;
+    return true;
+}
+
+// Sums the worker histograms into g_fern_density and tone-maps it into g_fern_pixels.
+// With 'estimate_noise', also returns the relative shot noise 1/sqrt(n) of a dim pixel:
+// n is the 10th percentile of the lit pixels' counts (to a power of two). Returns 1 otherwise.
+double toneMapFernDensity(int pixel_count, bool estimate_noise) {
+    // Merge and find the peak density
+    Uint64 merge_start = trace_begin();
+    uint32_t max_count = 0;
+    int lit_pixels = 0;
+    int count_buckets[32] = {0};  // Lit pixels by floor(log2(count))
+    for (int i = 0; i < pixel_count; ++i) {
+        uint32_t count = 0;
+        for (int t = 0; t < g_fern_thread_count; ++t) {
+            count += g_fern_histograms[(size_t)t * pixel_count + i];
+        }
+        g_fern_density[i] = count;
+        if (count > max_count) max_count = count;
+        if (estimate_noise && count > 0) {
+            int bucket = 0;
+            while (count >> (bucket + 1)) bucket++;
+            count_buckets[bucket]++;
+            lit_pixels++;
+        }
+    }
+    trace_end("merge", merge_start);
+
+    // Logarithmic tone map: single hits stay visible, the dense stem does not saturate everything
+    Uint64 tone_start = trace_begin();
+    double log_max = log(1.0 + max_count);
+    for (int i = 0; i < pixel_count; ++i) {
+        if (g_fern_density[i] == 0) {
+            g_fern_pixels[i] = 0xFF000000;
+            continue;
+        }
+        double t = log(1.0 + g_fern_density[i]) / log_max;
+        Uint8 green = (Uint8)(60 + 195 * t);
+        Uint8 highlight = (Uint8)(160 * t * t * t);
+        g_fern_pixels[i] = 0xFF000000 | ((Uint32)highlight << 16) | ((Uint32)green << 8) | highlight;
+    }
+    trace_end("tone_map", tone_start);
+
+    if (!estimate_noise || lit_pixels == 0) {
+        return 1.0;
+    }
+    int dim_pixels = lit_pixels / 10;
+    int bucket = 0;
+    for (int seen = count_buckets[0]; seen <= dim_pixels && bucket < 31; seen += count_buckets[++bucket]) {
+    }
+    return 1.0 / sqrt((double)(1u << bucket));
+}
+
+// --- Progressive accumulation ---
+// Instead of projecting the fixed cloud, the chaos game keeps running for the current
+// view: every frame adds a batch of points (sized to take about FERN_PROGRESS_FRAME_MS)
+// to per-worker histograms that persist while the view stays put. The texture is
+// refreshed every FERN_PROGRESS_REFRESH_MS, and accumulation stops once the shot noise
+// of the dim pixels drops below the target. Any view change starts over.
+
+#define FERN_PROGRESS_FIRST_BATCH (1 << 18)
+#define FERN_PROGRESS_MAX_BATCH (1 << 26)
+#define FERN_PROGRESS_FRAME_MS 15.0
+#define FERN_PROGRESS_REFRESH_MS 100.0
+#define FERN_PROGRESS_MAX_POINTS 2000000000LL  // Keeps every pixel count below 2^32
+#define FERN_DEFAULT_NOISE_TARGET 0.05
+
+bool g_fern_progressive = false;
+bool g_fern_progress_done = false;
+double g_fern_noise_target = FERN_DEFAULT_NOISE_TARGET;
+double g_fern_noise = 1.0;
+long long g_fern_progress_points = 0;
+long long g_fern_progress_batch = FERN_PROGRESS_FIRST_BATCH;
+Uint64 g_fern_progress_refreshed = 0;
+IfsLanes g_fern_progress_lanes[FERN_MAX_THREADS];
+bool g_fern_progress_seeded = false;
+
+// Clears the accumulated density for a new view. The walkers keep their positions.
+void resetFernProgress(int pixel_count) {
+    if (!g_fern_progress_seeded) {
+        uint64_t base_seed = ((uint64_t)time(NULL) << 20) ^ 0xD1B54A32D192ED03ull;
+        for (int t = 0; t < FERN_MAX_THREADS; ++t) {
+            ifs_lanes_init(&g_fern_progress_lanes[t], base_seed + (uint64_t)t * 0x9E3779B97F4A7C15ull);
+            for (int i = 0; i < SKIP_INITIAL_POINTS; ++i) {
+                ifs_lanes_step(&g_ifs, &g_fern_progress_lanes[t]);
+            }
+        }
+        g_fern_progress_seeded = true;
+    }
+    memset(g_fern_histograms, 0, sizeof(uint32_t) * pixel_count * g_fern_thread_count);
+    g_fern_progress_points = 0;
+    g_fern_points_visible = 0;
+    g_fern_progress_batch = FERN_PROGRESS_FIRST_BATCH;
+    g_fern_progress_done = false;
+    g_fern_noise = 1.0;
+}
+
+// Adds one batch for the current view and refreshes the texture when due. Called every frame.
+void advanceFernProgress() {
+    if (!g_fern_progressive || g_fern_deterministic || g_fern_progress_done || !g_fern_texture ||
+        g_fern_histograms == NULL) {
+        return;
+    }
+    int texture_width, texture_height;
+    SDL_QueryTexture(g_fern_texture, NULL, NULL, &texture_width, &texture_height);
+    int pixel_count = texture_width * texture_height;
+    if ((size_t)pixel_count > g_fern_buffer_pixels) {
+        return;  // Resized; the redraw that follows resets the buffers
+    }
+
+    perf_begin(PERF_COMPUTE);
+    Uint64 batch_start = SDL_GetPerformanceCounter();
+    FernWorker workers[FERN_MAX_THREADS];
+    memset(workers, 0, sizeof(workers));
+    for (int t = 0; t < g_fern_thread_count; ++t) {
+        FernWorker* worker = &workers[t];
+        worker->index = t;
+        worker->job = FERN_ACCUMULATE;
+        worker->lanes = &g_fern_progress_lanes[t];
+        worker->num_points = g_fern_progress_batch / g_fern_thread_count;
+        worker->histogram = g_fern_histograms + (size_t)t * pixel_count;
+        worker->texture_width = texture_width;
+        worker->texture_height = texture_height;
+        worker->view_x_center = g_view_x_center;
+        worker->view_y_center = g_view_y_center;
+        worker->view_scale = g_view_scale;
+    }
+    double busy_ms = runFernWorkers(workers);
+
+    long long points = 0;
+    long long hits = 0;
+    for (int t = 0; t < g_fern_thread_count; ++t) {
+        points += workers[t].points_read;
+        hits += workers[t].hits;
+    }
+    bool first_batch = g_fern_progress_points == 0;
+    g_fern_progress_points += points;
+    g_fern_points_visible += hits;
+
+    // Size the next batch so a frame keeps roughly the same compute time
+    Uint64 now = SDL_GetPerformanceCounter();
+    double batch_ms = perf_ms_between(batch_start, now);
+    g_fern_progress_batch = (long long)(g_fern_progress_batch * FERN_PROGRESS_FRAME_MS / fmax(batch_ms, 0.1));
+    if (g_fern_progress_batch < FERN_PROGRESS_FIRST_BATCH / 4) g_fern_progress_batch = FERN_PROGRESS_FIRST_BATCH / 4;
+    if (g_fern_progress_batch > FERN_PROGRESS_MAX_BATCH) g_fern_progress_batch = FERN_PROGRESS_MAX_BATCH;
+    if (g_fern_progress_points + g_fern_progress_batch > FERN_PROGRESS_MAX_POINTS) {
+        g_fern_progress_batch = FERN_PROGRESS_MAX_POINTS - g_fern_progress_points;
+    }
+
+    bool refresh = first_batch || g_fern_progress_batch <= 0 ||
+                   perf_ms_between(g_fern_progress_refreshed, now) >= FERN_PROGRESS_REFRESH_MS;
+    if (refresh) {
+        g_fern_noise = toneMapFernDensity(pixel_count, true);
+        g_fern_progress_refreshed = SDL_GetPerformanceCounter();
+        if (g_fern_noise <= g_fern_noise_target || g_fern_progress_batch <= 0) {
+            g_fern_progress_done = true;
+            printf("Progressive render finished: %lld points, %lld in view, noise %.1f%%\n",
+                   g_fern_progress_points, g_fern_points_visible, 100.0 * g_fern_noise);
+        }
+    }
+    perf_end(PERF_COMPUTE);
+    perf_add_iterations(points);
+    perf_add_pixels(hits);
+    perf_add_thread_time(g_fern_thread_count, busy_ms);
+
+    if (refresh) {
+        perf_begin(PERF_UPLOAD);
+        SDL_UpdateTexture(g_fern_texture, NULL, g_fern_pixels, texture_width * sizeof(uint32_t));
+        perf_end(PERF_UPLOAD);
+    }
+}
+
 // --- Function to draw the Barnsley Fern onto g_fern_texture ---
 void drawBarnsleyFernToTexture() {
     if (!g_renderer || !g_fern_texture) {
@@ -101,53 +786,103 @@ void drawBarnsleyFernToTexture() {
         return;
     }
 
-    printf("Generating and drawing Barnsley Fern with %d points...\n", NUM_FERN_POINTS);
-
     int texture_width, texture_height;
     SDL_QueryTexture(g_fern_texture, NULL, NULL, &texture_width, &texture_height);
+    if (!ensureFernBuffers(texture_width, texture_height)) {
+        return;
+    }
+    int pixel_count = texture_width * texture_height;
 
-    SDL_SetRenderTarget(g_renderer, g_fern_texture);
-    SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 255);
-    SDL_RenderClear(g_renderer);
-    SDL_SetRenderDrawColor(g_renderer, 0, 180, 0, 255);
-
-    double x = 0.0;
-    double y = 0.0;
-    double next_x, next_y;
-    int px, py;
-
-    srand(time(NULL));
-
-    for (long i = 0; i < NUM_FERN_POINTS; ++i) {
-        int r = rand() % 100;
-
-        if (r == 0) {
-            next_x = 0;
-            next_y = 0.16 * y;
-        } else if (r >= 1 && r <= 85) {
-            next_x = 0.85 * x + 0.04 * y;
-            next_y = -0.04 * x + 0.85 * y + 1.6;
-        } else if (r >= 86 && r <= 92) {
-            next_x = 0.20 * x - 0.26 * y;
-            next_y = 0.23 * x + 0.22 * y + 1.6;
-        } else {
-            next_x = -0.15 * x + 0.28 * y;
-            next_y = 0.26 * x + 0.24 * y + 0.44;
-        }
+    // The cloud is only built when a view first needs it
+    if (!g_fern_deterministic && !g_fern_progressive && g_fern_cloud.offset_x == NULL && !generateFernCloud()) {
+        printf("Falling back to progressive accumulation.\n");
+        g_fern_progressive = true;
+    }
 
-        x = next_x;
-        y = next_y;
+    char view[160];
+    snprintf(view, sizeof(view), "center:(%.10g, %.10g) scale:%.6g mode=%s threads=%d",
+             g_view_x_center, g_view_y_center, g_view_scale,
+             g_fern_deterministic ? "ifs" : g_fern_progressive ? "progressive" : "chaos", g_fern_thread_count);
+    perf_set_view(view);
 
-        if (i >= SKIP_INITIAL_POINTS) {
-            map_world_to_pixel(x, y, &px, &py, texture_width, texture_height);
-            if (px >= -1 && px < texture_width + 1 && py >= -1 && py < texture_height + 1) {
-                SDL_RenderDrawPoint(g_renderer, px, py);
-            }
+    if (g_fern_progressive && !g_fern_deterministic) {
+        resetFernProgress(pixel_count);
+        advanceFernProgress();
+        return;
+    }
+
+    perf_begin(PERF_COMPUTE);
+
+    FernWorker workers[FERN_MAX_THREADS];
+    memset(workers, 0, sizeof(workers));
+    for (int t = 0; t < g_fern_thread_count; ++t) {
+        FernWorker* worker = &workers[t];
+        worker->index = t;
+        worker->histogram = g_fern_histograms + (size_t)t * pixel_count;
+        worker->texture_width = texture_width;
+        worker->texture_height = texture_height;
+    }
+
+    if (g_fern_deterministic) {
+        double measure = expandFernSeeds(texture_width, texture_height);
+        // A pixel can hold at most the seeds' total measure, so it maps to 2^31 and the
+        // per-piece +1 (bounded by the leaf budget) cannot overflow the merged counts
+        double weight_scale = measure > 0.0 ? 2147483648.0 / measure : 0.0;
+        for (int t = 0; t < g_fern_thread_count; ++t) {
+            workers[t].job = FERN_IFS_PIECES;
+            workers[t].weight_scale = weight_scale;
+            workers[t].leaf_budget = FERN_IFS_MAX_LEAVES / g_fern_thread_count;
+        }
+    } else {
+        perf_add_cache(1);  // The cloud is reused, only the projection is redone
+
+        // Bins overlapping the viewport, with one pixel of slack for rounding
+        double half_world_w = (texture_width / 2.0 + 1.0) / g_view_scale;
+        double half_world_h = (texture_height / 2.0 + 1.0) / g_view_scale;
+        int bin_x_min, bin_x_max, bin_y_min, bin_y_max;
+        bool visible = fernBinRange(g_view_x_center - half_world_w, g_view_x_center + half_world_w,
+                                    g_fern_cloud.x_min, g_fern_cloud.bin_width, &bin_x_min, &bin_x_max) &&
+                       fernBinRange(g_view_y_center - half_world_h, g_view_y_center + half_world_h,
+                                    g_fern_cloud.y_min, g_fern_cloud.bin_height, &bin_y_min, &bin_y_max);
+        if (!visible) {
+            bin_x_min = bin_y_min = 0;  // Empty ranges: workers only clear their histograms
+            bin_x_max = bin_y_max = -1;
+        }
+
+        for (int t = 0; t < g_fern_thread_count; ++t) {
+            FernWorker* worker = &workers[t];
+            worker->job = FERN_RASTERIZE;
+            worker->view_x_center = g_view_x_center;
+            worker->view_y_center = g_view_y_center;
+            worker->view_scale = g_view_scale;
+            worker->bin_x_min = bin_x_min;
+            worker->bin_x_max = bin_x_max;
+            worker->bin_y_min = bin_y_min;
+            worker->bin_y_max = bin_y_max;
         }
     }
+    double busy_ms = runFernWorkers(workers);
+
+    long long points_read = 0;
+    long long points_drawn = 0;
+    g_fern_ifs_truncated = false;
+    for (int t = 0; t < g_fern_thread_count; ++t) {
+        points_read += workers[t].points_read;
+        points_drawn += workers[t].hits;
+        if (workers[t].truncated) g_fern_ifs_truncated = true;
+    }
+    g_fern_points_visible = points_drawn;
+
+    toneMapFernDensity(pixel_count, false);
+
+    perf_end(PERF_COMPUTE);
+    perf_add_iterations(points_read);
+    perf_add_pixels(points_drawn);
+    perf_add_thread_time(g_fern_thread_count, busy_ms);
 
-    SDL_SetRenderTarget(g_renderer, NULL);
-    printf("Finished drawing Barnsley Fern to texture.\n");
+    perf_begin(PERF_UPLOAD);
+    SDL_UpdateTexture(g_fern_texture, NULL, g_fern_pixels, texture_width * sizeof(uint32_t));
+    perf_end(PERF_UPLOAD);
 }
 
 // --- Reset View Function ---
@@ -170,10 +905,36 @@ void reset_view() {
 }
 
 
-int main() {
+int main(int argc, char* argv[]) {
+    perf_init(argc, argv);
+
+    const char* ifs_path = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--ifs") == 0 && i + 1 < argc) {
+            ifs_path = argv[++i];
+        } else if (strcmp(argv[i], "--progressive") == 0) {
+            g_fern_progressive = true;
+        } else if (strcmp(argv[i], "--noise-target") == 0 && i + 1 < argc) {
+            g_fern_noise_target = atof(argv[++i]) / 100.0;
+        }
+    }
+    int ifs_status = ifs_path != NULL ? ifs_load(ifs_path, &g_ifs) : ifs_parse(g_default_ifs, "built-in fern", &g_ifs);
+    if (ifs_status != 0) {
+        return 1;
+    }
+    g_world_x_min = g_ifs.x_min;
+    g_world_x_max = g_ifs.x_max;
+    g_world_y_min = g_ifs.y_min;
+    g_world_y_max = g_ifs.y_max;
+    printf("%s: %d maps, bounds x [%g, %g] y [%g, %g]%s\n", g_ifs.name, g_ifs.map_count,
+           g_ifs.x_min, g_ifs.x_max, g_ifs.y_min, g_ifs.y_max, g_ifs.exact_bounds ? "" : " (estimated)");
+
     printf("Left Click + Drag: Pan the view\n");
     printf("Mouse Wheel: Zoom in/out\n");
     printf("R: Reset View\n");
+    printf("D: Toggle deterministic IFS rendering (detail at any zoom)\n");
+    printf("P: Toggle progressive accumulation (--progressive to start with it)\n");
+    printf("F1: Toggle performance HUD\n");
     printf("Click 'Save' button to save an image.\n");
 
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -188,7 +949,7 @@ int main() {
     }
 
     g_window = SDL_CreateWindow(
-        "Barnsley Fern",
+        g_ifs.name,
         SDL_WINDOWPOS_UNDEFINED,
         SDL_WINDOWPOS_UNDEFINED,
         INITIAL_WIDTH,
@@ -213,6 +974,10 @@ int main() {
     }
     SDL_SetRenderDrawBlendMode(g_renderer, SDL_BLENDMODE_BLEND);
 
+    g_fern_thread_count = SDL_GetCPUCount();
+    if (g_fern_thread_count < 1) g_fern_thread_count = 1;
+    if (g_fern_thread_count > FERN_MAX_THREADS) g_fern_thread_count = FERN_MAX_THREADS;
+
     g_font = TTF_OpenFont("/usr/share/fonts/truetype/dejavu/DejaVuSans-Bold.ttf", 16);
     if (g_font == NULL) {
         fprintf(stderr, "Failed to load font! Please check font path: /usr/share/fonts/truetype/dejavu/DejaVuSans-Bold.ttf\nSDL_ttf Error: %s\n", TTF_GetError());
@@ -223,7 +988,7 @@ int main() {
     SDL_GetWindowSize(g_window, &window_width, &window_height);
     g_fern_texture = SDL_CreateTexture(g_renderer,
                                           SDL_PIXELFORMAT_ARGB8888,
-                                          SDL_TEXTUREACCESS_TARGET,
+                                          SDL_TEXTUREACCESS_STREAMING,
                                           window_width, window_height);
     if (g_fern_texture == NULL) {
         fprintf(stderr, "Failed to create Barnsley Fern texture: %s\n", SDL_GetError());
@@ -250,6 +1015,7 @@ int main() {
         screenshotButtonRect = (SDL_Rect){current_window_width - 120, 10, 110, 30};
 
         while (SDL_PollEvent(&event)){
+            if (perf_handle_event(&event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
@@ -265,7 +1031,7 @@ int main() {
                         }
                         g_fern_texture = SDL_CreateTexture(g_renderer,
                                                               SDL_PIXELFORMAT_ARGB8888,
-                                                              SDL_TEXTUREACCESS_TARGET,
+                                                              SDL_TEXTUREACCESS_STREAMING,
                                                               new_width, new_height);
                         if (g_fern_texture == NULL) {
                             fprintf(stderr, "Failed to recreate fern texture after resize: %s\n", SDL_GetError());
@@ -283,7 +1049,9 @@ int main() {
                             mouseX <= screenshotButtonRect.x + screenshotButtonRect.w &&
                             mouseY >= screenshotButtonRect.y &&
                             mouseY <= screenshotButtonRect.y + screenshotButtonRect.h) {
+                            Uint64 trace_start = trace_begin();
                             saveScreenshot(g_renderer, "barnsley_fern_screenshot.bmp", current_window_width, current_window_height);
+                            trace_end("screenshot", trace_start);
                         } else if (event.button.button == SDL_BUTTON_LEFT) {
                             g_is_panning = true;
                             g_last_mouse_x = mouseX;
@@ -339,6 +1107,20 @@ int main() {
                 case SDL_KEYDOWN:
                     if (event.key.keysym.sym == SDLK_r) {
                         reset_view();
+                    } else if (event.key.keysym.sym == SDLK_d) {
+                        if (!g_ifs.exact_bounds) {
+                            printf("Deterministic IFS rendering needs contracting affine maps.\n");
+                            break;
+                        }
+                        g_fern_deterministic = !g_fern_deterministic;
+                        printf("Rendering mode: %s\n", g_fern_deterministic ? "deterministic IFS" :
+                               g_fern_progressive ? "progressive accumulation" : "chaos game");
+                        re_draw_fern_texture = true;
+                    } else if (event.key.keysym.sym == SDLK_p) {
+                        g_fern_progressive = g_fern_deterministic || !g_fern_progressive;
+                        g_fern_deterministic = false;
+                        printf("Rendering mode: %s\n", g_fern_progressive ? "progressive accumulation" : "chaos game");
+                        re_draw_fern_texture = true;
                     }
                     break;
             }
@@ -346,17 +1128,32 @@ int main() {
 
         if (re_draw_fern_texture) {
             drawBarnsleyFernToTexture();
+        } else {
+            advanceFernProgress();
         }
 
         // --- Rendering ---
+        perf_begin(PERF_DRAW);
         SDL_RenderCopy(g_renderer, g_fern_texture, NULL, NULL);
+        perf_end(PERF_DRAW);
 
         // Render UI elements on top
+        perf_begin(PERF_TEXT);
         if (g_font != NULL) {
             char text_buffer[200];
             SDL_Color textColor = {255, 255, 255, 255};
 
-            snprintf(text_buffer, sizeof(text_buffer), "Points: %dM", (int)(NUM_FERN_POINTS / 1000000));
+            if (g_fern_deterministic) {
+                snprintf(text_buffer, sizeof(text_buffer), "Deterministic IFS: %lld pieces%s, Threads: %d",
+                         g_fern_points_visible, g_fern_ifs_truncated ? " (budget reached)" : "", g_fern_thread_count);
+            } else if (g_fern_progressive) {
+                snprintf(text_buffer, sizeof(text_buffer), "Progressive: %.1fM points, noise %.1f%% (target %.1f%%)%s, Threads: %d",
+                         g_fern_progress_points / 1e6, 100.0 * g_fern_noise, 100.0 * g_fern_noise_target,
+                         g_fern_progress_done ? " done" : "", g_fern_thread_count);
+            } else {
+                snprintf(text_buffer, sizeof(text_buffer), "Points: %dM (%lld in view), Threads: %d",
+                         (int)(NUM_FERN_POINTS / 1000000), g_fern_points_visible, g_fern_thread_count);
+            }
             renderText(g_renderer, g_font, text_buffer, 10, 10, textColor);
 
             snprintf(text_buffer, sizeof(text_buffer), "View Scale: %.2f (px/unit)", g_view_scale);
@@ -365,8 +1162,11 @@ int main() {
             snprintf(text_buffer, sizeof(text_buffer), "View Center: (%.2f, %.2f)", g_view_x_center, g_view_y_center);
             renderText(g_renderer, g_font, text_buffer, 10, 50, textColor);
 
+            snprintf(text_buffer, sizeof(text_buffer), "IFS: %s (%d maps)", g_ifs.name, g_ifs.map_count);
+            renderText(g_renderer, g_font, text_buffer, 10, 70, textColor);
+
             renderText(g_renderer, g_font, "Left Drag: Pan, Wheel: Zoom", 10, current_window_height - 50, textColor);
-            renderText(g_renderer, g_font, "R: Reset View", 10, current_window_height - 20, textColor);
+            renderText(g_renderer, g_font, "R: Reset View, D: Deterministic IFS, P: Progressive", 10, current_window_height - 20, textColor);
 
             SDL_SetRenderDrawColor(g_renderer, 50, 50, 50, 255);
             SDL_RenderFillRect(g_renderer, &screenshotButtonRect);
@@ -376,11 +1176,22 @@ int main() {
             SDL_Color buttonTextColor = {255, 255, 255, 255};
             renderText(g_renderer, g_font, "Save", screenshotButtonRect.x + 8, screenshotButtonRect.y + 5, buttonTextColor);
         }
+        perf_end(PERF_TEXT);
+        perf_draw_hud(g_renderer, g_font);
 
+        perf_begin(PERF_PRESENT);
         SDL_RenderPresent(g_renderer);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
     }
 
     // --- Cleanup ---
+    perf_shutdown();
+    free(g_fern_histograms);
+    free(g_fern_density);
+    free(g_fern_pixels);
+    free(g_fern_cloud.offset_x);
+    free(g_fern_cloud.offset_y);
     if (g_fern_texture != NULL) {
         SDL_DestroyTexture(g_fern_texture);
     }
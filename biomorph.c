@@ -4,6 +4,9 @@
 #include <math.h>
 #include <complex.h>
 #include <SDL2/SDL_ttf.h>
+#include "tileexport.h"
+#include "golden.h"
+#include "perfhud.h"
 
 #define WIDTH 800
 #define HEIGHT 800
@@ -98,13 +101,66 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename) {
     SDL_FreeSurface(screenshot_surface);
 }
 
+// Iterates z_n+1 = z_n^5 + c from z, returning the iteration count and the value at escape
+int biomorphIterations(double complex z, int max_iterations, double complex* final_z) {
+    int iterations = 0;
+
+    while (cabs(z) < 2.0 && iterations < max_iterations) {
+        // z_n+1 = z_n^5 + c
+        // Calculate z_n^5
+        double complex z_sq = z * z;
+        double complex z_cube = z_sq * z;
+        double complex z_fourth = z_cube * z;
+        z = z * z_fourth + g_biomorph_c;
+
+        iterations++;
+    }
+    *final_z = z;
+    return iterations;
+}
+
+// ARGB colour of a single point, used by the strip exporter
+uint32_t biomorphPixel(double re, double im) {
+    double complex final_z;
+    int iterations = biomorphIterations(re + im * I, g_current_max_iterations, &final_z);
+    SDL_Color color = getColor(iterations, g_current_max_iterations, final_z);
+    return (color.a << 24) | (color.r << 16) | (color.g << 8) | color.b;
+}
+
+// Smoothed escape count at (re, im) in 1/256 steps for the golden checksum. getColor()
+// uses both the iteration count and the value at escape, so both are pinned.
+int biomorphGoldenSample(double re, double im, int max_iterations) {
+    double complex final_z;
+    int iterations = biomorphIterations(re + im * I, max_iterations, &final_z);
+    if (iterations == max_iterations) {
+        return iterations * 256;
+    }
+    double mu = (double)iterations + 1.0 - log(log(cabs(final_z))) / log(5.0);
+    return (int)floor(mu * 256.0);
+}
+
+// Fixed views pinned by 'make golden' (name, x_min, x_max, y_min, y_max, iterations)
+const GoldenView g_golden_views[] = {
+    {"full", -2.0, 2.0, -1.5, 1.5, 100},
+    {"detail", 0.5, 1.1, 0.3, 0.75, 100},
+};
+
 // Function to calculate and render the Biomorph fractal
 void calculateAndRenderBiomorph(SDL_Renderer* renderer, SDL_Texture* texture, uint32_t* pixels) {
+    char view[160];
+    snprintf(view, sizeof(view), "R:[%.10g, %.10g] I:[%.10g, %.10g] C:%.5f%+.5fi it=%d",
+             g_real_min, g_real_max, g_imag_min, g_imag_max, creal(g_biomorph_c), cimag(g_biomorph_c), g_current_max_iterations);
+    perf_set_view(view);
+
     int pitch;
+    perf_begin(PERF_UPLOAD);
     SDL_LockTexture(texture, NULL, (void**)&pixels, &pitch);
+    perf_end(PERF_UPLOAD);
 
     double real_width = g_real_max - g_real_min;
     double imag_height = g_imag_max - g_imag_min;
+    long long total_iterations = 0;
+    perf_begin(PERF_COMPUTE);
 
     for (int y = 0; y < HEIGHT; ++y) {
         for (int x = 0; x < WIDTH; ++x) {
@@ -112,31 +168,42 @@ void calculateAndRenderBiomorph(SDL_Renderer* renderer, SDL_Texture* texture, ui
             double z_real_initial = g_real_min + (double)x / WIDTH * real_width;
             double z_imag_initial = g_imag_min + (double)y / HEIGHT * imag_height;
 
-            double complex z = z_real_initial + z_imag_initial * I;
-
-            int iterations = 0;
-            double complex final_z_at_escape = 0.0 + 0.0 * I;
-
-            while (cabs(z) < 2.0 && iterations < g_current_max_iterations) {
-                // z_n+1 = z_n^5 + c
-                // Calculate z_n^5
-                double complex z_sq = z * z;
-                double complex z_cube = z_sq * z;
-                double complex z_fourth = z_cube * z;
-                z = z * z_fourth + g_biomorph_c;
-
-                iterations++;
-            }
-            final_z_at_escape = z;
+            double complex final_z_at_escape;
+            int iterations = biomorphIterations(z_real_initial + z_imag_initial * I, g_current_max_iterations, &final_z_at_escape);
+            total_iterations += iterations;
 
             SDL_Color color = getColor(iterations, g_current_max_iterations, final_z_at_escape);
             pixels[y * (pitch / sizeof(uint32_t)) + x] = (color.a << 24) | (color.r << 16) | (color.g << 8) | color.b;
         }
     }
+    perf_end(PERF_COMPUTE);
+    perf_add_iterations(total_iterations);
+    perf_add_pixels((long long)WIDTH * HEIGHT);
+
+    perf_begin(PERF_UPLOAD);
     SDL_UnlockTexture(texture);
+    perf_end(PERF_UPLOAD);
 }
 
 int main(int argc, char* argv[]) {
+    // Golden-image regression check: render the fixed views headlessly and compare
+    GoldenOptions golden_options;
+    int golden_status = golden_parse_args(argc, argv, &golden_options);
+    if (golden_status != 0) {
+        if (golden_status < 0) return 1;
+        return golden_run(&golden_options, "biomorph", g_golden_views, GOLDEN_VIEW_COUNT(g_golden_views), biomorphGoldenSample);
+    }
+
+    // Headless poster export: render straight to disk without opening a window
+    ExportJob export_job = export_default_job(g_real_min, g_real_max, g_imag_min, g_imag_max, g_current_max_iterations);
+    int export_status = export_parse_args(argc, argv, &export_job);
+    if (export_status != 0) {
+        if (export_status < 0) return 1;
+        g_current_max_iterations = export_job.max_iterations;
+        return export_run(&export_job, biomorphPixel);
+    }
+    perf_init(argc, argv);
+
     // --- SDL Initialization ---
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         fprintf(stderr, "SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
@@ -205,6 +272,7 @@ int main(int argc, char* argv[]) {
 
     while (application_running) {
         while (SDL_PollEvent(&event)) {
+            if (perf_handle_event(&event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
@@ -217,7 +285,9 @@ int main(int argc, char* argv[]) {
                         event.button.x <= screenshotButtonRect.x + screenshotButtonRect.w &&
                         event.button.y >= screenshotButtonRect.y &&
                         event.button.y <= screenshotButtonRect.y + screenshotButtonRect.h) {
+                        Uint64 trace_start = trace_begin();
                         saveScreenshot(g_renderer, "biomorph_fractal_screenshot.bmp");
+                        trace_end("screenshot", trace_start);
                     } else if (event.button.button == SDL_BUTTON_LEFT) {
                         g_is_panning = true;
                         g_mouse_down_x = event.button.x;
@@ -291,9 +361,12 @@ int main(int argc, char* argv[]) {
         // --- Rendering ---
         SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 255);
         SDL_RenderClear(g_renderer);
+        perf_begin(PERF_DRAW);
         SDL_RenderCopy(g_renderer, g_fractal_texture, NULL, NULL);
+        perf_end(PERF_DRAW);
 
         // Render text overlays
+        perf_begin(PERF_TEXT);
         if (g_font != NULL) {
             char text_buffer[200];
             SDL_Color textColor = {255, 255, 255, 255};
@@ -322,11 +395,17 @@ int main(int argc, char* argv[]) {
             SDL_Color buttonTextColor = {255, 255, 255, 255};
             renderText(g_renderer, g_font, "Save", screenshotButtonRect.x + 8, screenshotButtonRect.y + 7, buttonTextColor);
         }
+        perf_end(PERF_TEXT);
+        perf_draw_hud(g_renderer, g_font);
 
+        perf_begin(PERF_PRESENT);
         SDL_RenderPresent(g_renderer);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
     }
 
     // --- Cleanup ---
+    perf_shutdown();
     if (g_pixels != NULL) {
         free(g_pixels);
     }
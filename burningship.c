@@ -4,6 +4,9 @@
 #include <math.h>
 #include <complex.h>
 #include <SDL2/SDL_ttf.h>
+#include "tileexport.h"
+#include "golden.h"
+#include "perfhud.h"
 
 #define WIDTH 800
 #define HEIGHT 800
@@ -43,6 +46,38 @@ SDL_Color getColor(int iterations, int current_max_iterations_limit) {
     return color;
 }
 
+// Returns the number of iterations before the orbit of c = cr + i*ci escapes
+int burningShipIterations(double cr, double ci, int max_iterations) {
+    double zr = 0.0; // Real part of z
+    double zi = 0.0; // Imaginary part of z
+    int iterations = 0;
+
+    // Burning Ship iteration: z_n+1 = (|re(z_n)| + i * |im(z_n)|)^2 + c
+    // Keep iterating as long as the magnitude of Z squared is less than 4.0
+    while ((zr * zr + zi * zi < 4.0) && (iterations < max_iterations)) {
+        double abs_zr = fabs(zr);
+        double abs_zi = fabs(zi);
+
+        double temp_zr = abs_zr * abs_zr - abs_zi * abs_zi + cr; // New real part
+        zi = 2.0 * abs_zr * abs_zi + ci;                          // New imaginary part
+        zr = temp_zr;
+        iterations++;
+    }
+    return iterations;
+}
+
+// ARGB colour of a single point, used by the strip exporter
+uint32_t burningShipPixel(double cr, double ci) {
+    SDL_Color color = getColor(burningShipIterations(cr, ci, g_current_max_iterations), g_current_max_iterations);
+    return (color.a << 24) | (color.r << 16) | (color.g << 8) | color.b;
+}
+
+// Fixed views pinned by 'make golden' (name, x_min, x_max, y_min, y_max, iterations)
+const GoldenView g_golden_views[] = {
+    {"full", -2.2, 1.0, -2.0, 0.4, 100},
+    {"ship", -1.8, -1.7, -0.0825, -0.0075, 500},
+};
+
 // Function to calculate and render the Burning Ship fractal
 void calculateAndRenderBurningShip(SDL_Renderer* renderer, SDL_Texture* texture, uint32_t* pixels) {
     printf("Calculating Burning Ship for view: R:[%f, %f], I:[%f, %f], Iterations: %d\n",
@@ -50,6 +85,13 @@ void calculateAndRenderBurningShip(SDL_Renderer* renderer, SDL_Texture* texture,
 
     double complex_width = g_real_max - g_real_min;
     double complex_height = g_imag_max - g_imag_min;
+    long long total_iterations = 0;
+
+    char view[160];
+    snprintf(view, sizeof(view), "R:[%.10g, %.10g] I:[%.10g, %.10g] it=%d",
+             g_real_min, g_real_max, g_imag_min, g_imag_max, g_current_max_iterations);
+    perf_set_view(view);
+    perf_begin(PERF_COMPUTE);
 
     for (int y = 0; y < HEIGHT; y++) {
         for (int x = 0; x < WIDTH; x++) {
@@ -57,23 +99,8 @@ void calculateAndRenderBurningShip(SDL_Renderer* renderer, SDL_Texture* texture,
             double cr = g_real_min + (x / (double)WIDTH) * complex_width;
             double ci = g_imag_min + (y / (double)HEIGHT) * complex_height;
 
-            double complex c = cr + I * ci;
-
-            double zr = 0.0; // Real part of z
-            double zi = 0.0; // Imaginary part of z
-            int iterations = 0;
-
-            // Burning Ship iteration: z_n+1 = (|re(z_n)| + i * |im(z_n)|)^2 + c
-            // Keep iterating as long as the magnitude of Z squared is less than 4.0
-            while ((zr * zr + zi * zi < 4.0) && (iterations < g_current_max_iterations)) {
-                double abs_zr = fabs(zr);
-                double abs_zi = fabs(zi);
-
-                double temp_zr = abs_zr * abs_zr - abs_zi * abs_zi + cr; // New real part
-                zi = 2.0 * abs_zr * abs_zi + ci;                          // New imaginary part
-                zr = temp_zr;
-                iterations++;
-            }
+            int iterations = burningShipIterations(cr, ci, g_current_max_iterations);
+            total_iterations += iterations;
 
             // Get the color for the current pixel
             SDL_Color pixel_color = getColor(iterations, g_current_max_iterations);
@@ -85,7 +112,13 @@ void calculateAndRenderBurningShip(SDL_Renderer* renderer, SDL_Texture* texture,
                                     (pixel_color.b);
         }
     }
+    perf_end(PERF_COMPUTE);
+    perf_add_iterations(total_iterations);
+    perf_add_pixels((long long)WIDTH * HEIGHT);
+
+    perf_begin(PERF_UPLOAD);
     SDL_UpdateTexture(texture, NULL, pixels, WIDTH * sizeof(uint32_t));
+    perf_end(PERF_UPLOAD);
     printf("Burning Ship calculation complete.\n");
 }
 
@@ -145,11 +178,30 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename) {
 }
 
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Golden-image regression check: render the fixed views headlessly and compare
+    GoldenOptions golden_options;
+    int golden_status = golden_parse_args(argc, argv, &golden_options);
+    if (golden_status != 0) {
+        if (golden_status < 0) return 1;
+        return golden_run(&golden_options, "burningship", g_golden_views, GOLDEN_VIEW_COUNT(g_golden_views), burningShipIterations);
+    }
+
+    // Headless poster export: render straight to disk without opening a window
+    ExportJob export_job = export_default_job(g_real_min, g_real_max, g_imag_min, g_imag_max, g_current_max_iterations);
+    int export_status = export_parse_args(argc, argv, &export_job);
+    if (export_status != 0) {
+        if (export_status < 0) return 1;
+        g_current_max_iterations = export_job.max_iterations;
+        return export_run(&export_job, burningShipPixel);
+    }
+    perf_init(argc, argv);
+
     printf("Burning Ship Fractal Viewer\n");
     printf("Left click to zoom in.\n");
     printf("Right click to zoom out.\n");
     printf("Press 'R' to reset view.\n");
+    printf("Press 'F1' to toggle the performance HUD.\n");
     printf("Click 'Screenshot' button in top-right to save an image.\n");
 
     SDL_SetHint(SDL_HINT_RENDER_DRIVER, "wayland");
@@ -229,6 +281,7 @@ int main() {
 
     while (application_running) {
         while (SDL_PollEvent(&event)){
+            if (perf_handle_event(&event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
@@ -243,7 +296,9 @@ int main() {
                         mouseX <= screenshotButtonRect.x + screenshotButtonRect.w &&
                         mouseY >= screenshotButtonRect.y &&
                         mouseY <= screenshotButtonRect.y + screenshotButtonRect.h) {
+                        Uint64 trace_start = trace_begin();
                         saveScreenshot(renderer, "burningship_screenshot.bmp");
+                        trace_end("screenshot", trace_start);
                     } else {
                         // Original fractal zoom/pan logic
                         double current_complex_real = g_real_min + (mouseX / (double)WIDTH) * (g_real_max - g_real_min);
@@ -302,9 +357,12 @@ int main() {
         // --- Rendering ---
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
+        perf_begin(PERF_DRAW);
         SDL_RenderCopy(renderer, fractalTexture, NULL, NULL);
+        perf_end(PERF_DRAW);
 
         // Render current view information
+        perf_begin(PERF_TEXT);
         if (font != NULL) {
             char text_buffer[200];
             SDL_Color textColor = {255, 255, 255, 255}; // White color for text
@@ -327,11 +385,17 @@ int main() {
             SDL_Color buttonTextColor = {255, 255, 255, 255};
             renderText(renderer, font, "Save", screenshotButtonRect.x + 8, screenshotButtonRect.y + 5, buttonTextColor);
         }
+        perf_end(PERF_TEXT);
+        perf_draw_hud(renderer, font);
 
+        perf_begin(PERF_PRESENT);
         SDL_RenderPresent(renderer);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
     }
 
     // --- Cleanup ---
+    perf_shutdown();
     SDL_DestroyTexture(fractalTexture);
     if (font != NULL) {
         TTF_CloseFont(font);
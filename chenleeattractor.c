@@ -4,6 +4,11 @@
 #include <math.h>
 #include <SDL2/SDL_ttf.h>
 #include <stdlib.h>
+#include "perfhud.h"
+#include "linebatch.h"
+#include "lineraster.h"
+#include "vecmath.h"
+#include "framesched.h"
 
 #ifndef M_PIF
 #define M_PIF 3.14159265358979323846f
@@ -22,6 +27,11 @@
 // Define a reasonable boundary multiplier for projected points
 #define DRAW_BOUND_MULTIPLIER 2.0f
 
+// Range of the perspective denominator the software rasterizer keeps. Points with a
+// smaller one are behind the camera (project_to_2d() clamps the factor at 100 instead).
+#define CLIP_NEAR 0.01f
+#define CLIP_FAR 1000.0f
+
 // --- Chen-Lee Attractor Parameters ---
 float g_a = 5.0f;
 float g_b = -10.0f;
@@ -56,6 +66,11 @@ float g_view_scale = 10.0f;
 // Attractor's calculated centroid
 Vec3D g_attractor_centroid = {0.0f, 0.0f, 0.0f};
 
+// The trajectory as a structure of arrays, and the same points transformed to camera
+// or clip space for the current frame
+VecSoA g_attractor_soa;
+VecSoA g_view_points;
+
 // --- Interaction State Variables ---
 bool g_is_rotating = false;
 bool g_is_panning = false;
@@ -65,14 +80,19 @@ int g_last_mouse_x, g_last_mouse_y;
 SDL_Window* g_window = NULL;
 SDL_Renderer* g_renderer = NULL;
 TTF_Font* g_font = NULL;
+LineBatch g_line_batch;
+LineRaster g_line_raster;
+bool g_software_lines = true;  // Draw with lineraster.h instead of SDL's lines
+bool g_antialias_lines = false;
 
 // --- Forward Declarations ---
 void renderText(SDL_Renderer* renderer, TTF_Font* font, const char* text, int x, int y, SDL_Color color);
 void saveScreenshot(SDL_Renderer* renderer, const char* filename, int window_width, int window_height);
 void calculateAttractorPoints();
-void drawAttractor();
+void drawAttractor(bool scene_changed);
 Vec3D chen_lee_deriv(Vec3D current_state);
-Vec3D apply_rotation(Vec3D p);
+void create_camera_matrix(Mat4* out);
+void create_clip_matrix(Mat4* out);
 Vec3D project_to_2d(Vec3D p);
 
 
@@ -88,6 +108,7 @@ Vec3D chen_lee_deriv(Vec3D current_state) {
 // Also calculates the centroid of the stable part of the attractor.
 void calculateAttractorPoints() {
     printf("Calculating Chen-Lee Attractor points...\n");
+    perf_begin(PERF_COMPUTE);
 
     if (g_attractor_points != NULL) {
         free(g_attractor_points);
@@ -98,6 +119,7 @@ void calculateAttractorPoints() {
     if (g_attractor_points == NULL) {
         fprintf(stderr, "Error: Failed to allocate memory for attractor points!\n");
         g_num_current_attractor_points = 0;
+        perf_end(PERF_COMPUTE);
         return;
     }
     g_num_current_attractor_points = 0; 
@@ -161,41 +183,46 @@ void calculateAttractorPoints() {
         printf("Could not calculate centroid (not enough points after skip).\n");
     }
 
+    if (!vec_soa_gather(&g_attractor_soa, &g_attractor_points[0].x, (int)(sizeof(Vec3D) / sizeof(float)), g_num_current_attractor_points)) {
+        g_num_current_attractor_points = 0;
+    }
+
+    perf_end(PERF_COMPUTE);
+    perf_add_iterations(g_num_current_attractor_points);
     printf("Finished calculating %d points.\n", g_num_current_attractor_points);
 }
 
 
-Vec3D apply_rotation(Vec3D p) {
-    Vec3D rotated_p = p;
-    float temp_y, temp_z;
-
-    temp_y = rotated_p.y * cosf(g_rotation_x) - rotated_p.z * sinf(g_rotation_x);
-    temp_z = rotated_p.y * sinf(g_rotation_x) + rotated_p.z * cosf(g_rotation_x);
-    rotated_p.y = temp_y;
-    rotated_p.z = temp_z;
-
-    float temp_x, temp_z2;
-    temp_x = rotated_p.x * cosf(g_rotation_y) + rotated_p.z * sinf(g_rotation_y);
-    temp_z2 = -rotated_p.x * sinf(g_rotation_y) + rotated_p.z * cosf(g_rotation_y);
-    rotated_p.x = temp_x;
-    rotated_p.z = temp_z2;
+// Camera space: the point offset by the attractor's centroid (to centre it) and by the
+// camera position, then rotated about x and then y. The trigonometry is evaluated once
+// per frame here instead of for every point.
+void create_camera_matrix(Mat4* out) {
+    Mat4 translation, rot_x, rot_y;
+    mat4_translation(&translation, -(g_attractor_centroid.x + g_camera_x),
+                     -(g_attractor_centroid.y + g_camera_y), -(g_attractor_centroid.z + g_camera_z));
+    mat4_rotation_x(&rot_x, g_rotation_x);
+    mat4_rotation_y(&rot_y, g_rotation_y);
+    mat4_multiply(out, &rot_y, &rot_x);
+    mat4_multiply(out, out, &translation);
+}
 
-    return rotated_p;
+// Same projection as project_to_2d() as clip coordinates for the software rasterizer:
+// the perspective denominator becomes w, so lines are cut where it reaches CLIP_NEAR
+// instead of being mirrored behind the camera. It is linear in camera space, so it
+// folds into the camera matrix.
+void create_clip_matrix(Mat4* out) {
+    Mat4 camera, projection;
+    create_camera_matrix(&camera);
+    mat4_scale(&projection, g_view_scale / (WINDOW_WIDTH / 2.0f), -g_view_scale / (WINDOW_HEIGHT / 2.0f), 1.0f);
+    float depth_scale = CLIP_FAR / (CLIP_FAR - CLIP_NEAR);
+    projection.c[2][2] = depth_scale / 300.0f;
+    projection.c[3][2] = (1.0f - CLIP_NEAR) * depth_scale;
+    projection.c[2][3] = 1.0f / 300.0f;  // w = 1 + z / 300
+    mat4_multiply(out, &projection, &camera);
 }
 
+// Projects a camera-space point to the window
 Vec3D project_to_2d(Vec3D p) {
-    // Offset the point by the attractor's centroid to effectively center it.
-    p.x -= g_attractor_centroid.x;
-    p.y -= g_attractor_centroid.y;
-    p.z -= g_attractor_centroid.z;
-
-    // Translate the point relative to the camera's position
-    p.x -= g_camera_x;
-    p.y -= g_camera_y;
-    p.z -= g_camera_z;
-
-    p = apply_rotation(p);
-
     float perspective_denominator = (1.0f + p.z / 300.0f); 
     float perspective_factor;
 
@@ -222,14 +249,75 @@ Vec3D project_to_2d(Vec3D p) {
 }
 
 
-void drawAttractor() {
+// Draws the trajectory with lineraster.h and copies the result to the window
+void drawAttractorSoftware() {
+    long long lines_drawn = 0;
+    if (!line_raster_begin(&g_line_raster, WINDOW_WIDTH, WINDOW_HEIGHT, 0xFF14141Eu)) {
+        g_software_lines = false;  // Out of memory; fall back to SDL's lines
+        perf_end(PERF_COMPUTE);
+        return;
+    }
+    g_line_raster.antialias = g_antialias_lines;
+    line_raster_set_color(&g_line_raster, 200, 200, 255, 255);
+
+    Mat4 clip_matrix;
+    create_clip_matrix(&clip_matrix);
+    mat4_transform_points(&clip_matrix, &g_attractor_soa, &g_view_points);
+    const VecSoA* clip = &g_view_points;
+
+    bool prev_valid = false;
+    for (int i = SKIP_INITIAL_POINTS; i < clip->count; ++i) {
+        bool valid = isfinite(clip->x[i]) && isfinite(clip->y[i]) && isfinite(clip->w[i]);
+        if (valid && prev_valid) {
+            line_raster_add_clip(&g_line_raster, clip->x[i - 1], clip->y[i - 1], clip->z[i - 1], clip->w[i - 1],
+                                 clip->x[i], clip->y[i], clip->z[i], clip->w[i]);
+            lines_drawn++;
+        }
+        prev_valid = valid;
+    }
+    line_raster_end(&g_line_raster);
+    perf_end(PERF_COMPUTE);
+    perf_add_pixels(lines_drawn);
+    perf_add_thread_time(g_line_raster.thread_count, g_line_raster.busy_ms);
+
+    perf_begin(PERF_UPLOAD);
+    line_raster_upload(&g_line_raster);
+    perf_end(PERF_UPLOAD);
+    perf_begin(PERF_DRAW);
+    SDL_Rect target = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+    SDL_RenderCopy(g_renderer, g_line_raster.texture, NULL, &target);
+    perf_end(PERF_DRAW);
+}
+
+// Draws the attractor into the window. Unless 'scene_changed', the software
+// rasterizer's last picture is copied instead of drawn again.
+void drawAttractor(bool scene_changed) {
     if (g_attractor_points == NULL || g_num_current_attractor_points < 2) {
         return;
     }
+    if (!scene_changed && g_software_lines && g_line_raster.texture != NULL) {
+        perf_begin(PERF_DRAW);
+        SDL_Rect target = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
+        SDL_RenderCopy(g_renderer, g_line_raster.texture, NULL, &target);
+        perf_end(PERF_DRAW);
+        return;
+    }
+
+    char view[160];
+    snprintf(view, sizeof(view), "a=%.2f b=%.2f c=%.2f dt=%.4f cam=(%.0f,%.0f,%.0f) scale=%.1f",
+             g_a, g_b, g_c, g_dt, g_camera_x, g_camera_y, g_camera_z, g_view_scale);
+    perf_set_view(view);
+    perf_begin(PERF_COMPUTE);
+    if (g_software_lines) {
+        drawAttractorSoftware();
+        return;
+    }
+    long long lines_drawn = 0;
 
     SDL_SetRenderDrawColor(g_renderer, 200, 200, 255, 255); 
+    line_batch_begin(&g_line_batch, g_renderer);
 
-    Vec3D prev_projected_p;
+    Vec3D prev_projected_p = {0};
     bool first_valid_point = true; 
 
     float min_x_draw = -WINDOW_WIDTH * DRAW_BOUND_MULTIPLIER;
@@ -237,9 +325,13 @@ void drawAttractor() {
     float min_y_draw = -WINDOW_HEIGHT * DRAW_BOUND_MULTIPLIER;
     float max_y_draw = WINDOW_HEIGHT * DRAW_BOUND_MULTIPLIER;
 
-    for (int i = SKIP_INITIAL_POINTS; i < g_num_current_attractor_points; ++i) {
-        Vec3D current_point_3d = g_attractor_points[i];
-        Vec3D current_projected_p = project_to_2d(current_point_3d);
+    Mat4 camera_matrix;
+    create_camera_matrix(&camera_matrix);
+    mat4_transform_points(&camera_matrix, &g_attractor_soa, &g_view_points);
+    const VecSoA* camera = &g_view_points;
+
+    for (int i = SKIP_INITIAL_POINTS; i < camera->count; ++i) {
+        Vec3D current_projected_p = project_to_2d((Vec3D){camera->x[i], camera->y[i], camera->z[i]});
 
         bool current_point_is_valid = 
             current_projected_p.x >= min_x_draw && current_projected_p.x <= max_x_draw &&
@@ -252,15 +344,19 @@ void drawAttractor() {
             }
         } else {
             if (current_point_is_valid) {
-                SDL_RenderDrawLine(g_renderer,
-                                   (int)prev_projected_p.x, (int)prev_projected_p.y,
-                                   (int)current_projected_p.x, (int)current_projected_p.y);
+                line_batch_add(&g_line_batch,
+                               (int)prev_projected_p.x, (int)prev_projected_p.y,
+                               (int)current_projected_p.x, (int)current_projected_p.y);
+                lines_drawn++;
                 prev_projected_p = current_projected_p;
             } else {
                 first_valid_point = true;
             }
         }
     }
+    line_batch_end(&g_line_batch);
+    perf_end(PERF_COMPUTE);
+    perf_add_pixels(lines_drawn);
 }
 
 
@@ -313,6 +409,8 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename, int window_wid
 
 
 int main(int argc, char* argv[]) {
+    perf_init(argc, argv);
+
     SDL_Window* window = NULL;
     SDL_Renderer* renderer = NULL;
 
@@ -364,6 +462,7 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     g_renderer = renderer; 
+    line_raster_init(&g_line_raster, g_renderer);
 
     g_font = TTF_OpenFont("/usr/share/fonts/truetype/dejavu/DejaVuSans-Bold.ttf", 16);
     if (g_font == NULL) {
@@ -382,11 +481,17 @@ int main(int argc, char* argv[]) {
 
     bool application_running = true;
     SDL_Event event; 
-    bool needs_redraw = true;
+    FrameScheduler frame_sched;
+    frame_sched_init(&frame_sched, FRAME_SCHED_MAX_FPS);
 
     printf("Entering main loop.\n");
     while (application_running) {
-        while (SDL_PollEvent(&event)) {
+        while (application_running && frame_sched_next_event(&frame_sched, &event)) {
+            if (perf_handle_event(&event)) {
+                frame_sched_damage(&frame_sched, FRAME_DAMAGE_OVERLAY);
+                continue;
+            }
+            if (frame_sched_window_event(&frame_sched, &event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
@@ -399,7 +504,9 @@ int main(int argc, char* argv[]) {
                         event.button.y <= screenshotButtonRect.y + screenshotButtonRect.h) {
                         int current_window_width, current_window_height;
                         SDL_GetWindowSize(g_window, &current_window_width, &current_window_height);
+                        Uint64 trace_start = trace_begin();
                         saveScreenshot(g_renderer, "chenlee_attractor_screenshot.bmp", current_window_width, current_window_height);
+                        trace_end("screenshot", trace_start);
                     } else if (event.button.button == SDL_BUTTON_LEFT) {
                         g_is_rotating = true;
                         g_last_mouse_x = event.button.x;
@@ -427,7 +534,7 @@ int main(int argc, char* argv[]) {
 
                         g_last_mouse_x = event.motion.x;
                         g_last_mouse_y = event.motion.y;
-                        needs_redraw = true;
+                        frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE);
                     } else if (g_is_panning) {
                         float delta_x = (float)(event.motion.x - g_last_mouse_x);
                         float delta_y = (float)(event.motion.y - g_last_mouse_y);
@@ -438,7 +545,7 @@ int main(int argc, char* argv[]) {
 
                         g_last_mouse_x = event.motion.x;
                         g_last_mouse_y = event.motion.y;
-                        needs_redraw = true;
+                        frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE);
                     }
                     break;
                 case SDL_MOUSEWHEEL:
@@ -449,7 +556,7 @@ int main(int argc, char* argv[]) {
                     }
                     if (g_camera_z < -500.0f) g_camera_z = -500.0f;
                     if (g_camera_z > 500.0f) g_camera_z = 500.0f;
-                    needs_redraw = true;
+                    frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE);
                     break;
                 case SDL_KEYDOWN:
                     switch (event.key.keysym.sym) {
@@ -467,21 +574,23 @@ int main(int argc, char* argv[]) {
                             g_dt = 0.01f; 
                             g_current_state = (Vec3D){1.0f, 0.0f, 4.5f}; 
                             calculateAttractorPoints(); 
-                            needs_redraw = true;
+                            frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE);
                             break;
-                        case SDLK_w: g_camera_y -= 5.0f; needs_redraw = true; break;
-                        case SDLK_s: g_camera_y += 5.0f; needs_redraw = true; break;
-                        case SDLK_a: g_camera_x -= 5.0f; needs_redraw = true; break;
-                        case SDLK_d: g_camera_x += 5.0f; needs_redraw = true; break;
-                        case SDLK_q: g_view_scale += 1.0f; needs_redraw = true; break;
-                        case SDLK_e: g_view_scale -= 1.0f; if (g_view_scale < 1.0f) g_view_scale = 1.0f; needs_redraw = true; break; 
+                        case SDLK_b: g_software_lines = !g_software_lines; frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE); break;
+                        case SDLK_l: g_antialias_lines = !g_antialias_lines; frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE); break;
+                        case SDLK_w: g_camera_y -= 5.0f; frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE); break;
+                        case SDLK_s: g_camera_y += 5.0f; frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE); break;
+                        case SDLK_a: g_camera_x -= 5.0f; frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE); break;
+                        case SDLK_d: g_camera_x += 5.0f; frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE); break;
+                        case SDLK_q: g_view_scale += 1.0f; frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE); break;
+                        case SDLK_e: g_view_scale -= 1.0f; if (g_view_scale < 1.0f) g_view_scale = 1.0f; frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE); break; 
                         case SDLK_KP_PLUS: 
                         case SDLK_PLUS:
                              g_dt += 0.001f; 
                              if (g_dt > 0.1f) g_dt = 0.1f; 
                              printf("Calling calculateAttractorPoints from dt+...\n");
                              calculateAttractorPoints(); 
-                             needs_redraw = true;
+                             frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE);
                              break;
                         case SDLK_KP_MINUS: 
                         case SDLK_MINUS:
@@ -489,29 +598,22 @@ int main(int argc, char* argv[]) {
                              if (g_dt < 0.0001f) g_dt = 0.0001f; 
                              printf("Calling calculateAttractorPoints from dt-...\n");
                              calculateAttractorPoints(); 
-                             needs_redraw = true;
+                             frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE);
                              break;
                     }
                     break;
-                case SDL_WINDOWEVENT:
-                    if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
-                        needs_redraw = true;
-                    }
-                    break;
             }
         }
 
-        if (needs_redraw) {
-            SDL_SetRenderDrawColor(g_renderer, 20, 20, 30, 255); 
-            SDL_RenderClear(g_renderer);
-            drawAttractor();
-            needs_redraw = false;
-        }
+        SDL_SetRenderDrawColor(g_renderer, 20, 20, 30, 255); 
+        SDL_RenderClear(g_renderer);
+        drawAttractor(frame_sched_scene_damaged(&frame_sched));
 
         int current_window_width, current_window_height;
         SDL_GetWindowSize(g_window, &current_window_width, &current_window_height);
         screenshotButtonRect.x = current_window_width - 120; 
 
+        perf_begin(PERF_TEXT);
         SDL_Color textColor = {255, 255, 255, 255}; 
         char text_buffer[200];
 
@@ -533,13 +635,16 @@ int main(int argc, char* argv[]) {
         snprintf(text_buffer, sizeof(text_buffer), "View Scale: %.1f", g_view_scale);
         renderText(g_renderer, g_font, text_buffer, 10, 90, textColor);
 
+        snprintf(text_buffer, sizeof(text_buffer), "B: Software/SDL Lines, L: Anti-Aliasing");
+        renderText(g_renderer, g_font, text_buffer, 10, current_window_height - 90, textColor);
+
         snprintf(text_buffer, sizeof(text_buffer), "Left Drag: Rotate, Middle Drag: Pan, Wheel: Zoom Z");
         renderText(g_renderer, g_font, text_buffer, 10, current_window_height - 70, textColor);
 
         snprintf(text_buffer, sizeof(text_buffer), "WASD: Move Cam, Q/E: Scale, +/-: dt");
         renderText(g_renderer, g_font, text_buffer, 10, current_window_height - 50, textColor);
 
-        snprintf(text_buffer, sizeof(text_buffer), "R: Reset View & Params");
+        snprintf(text_buffer, sizeof(text_buffer), "R: Reset View & Params, F1: Perf HUD");
         renderText(g_renderer, g_font, text_buffer, 10, current_window_height - 30, textColor);
 
         SDL_SetRenderDrawColor(g_renderer, 50, 50, 50, 255);
@@ -550,15 +655,25 @@ int main(int argc, char* argv[]) {
         SDL_Color buttonTextColor = {255, 255, 255, 255}; 
         snprintf(text_buffer, sizeof(text_buffer), "Save");
         renderText(g_renderer, g_font, text_buffer, screenshotButtonRect.x + 8, screenshotButtonRect.y + 5, buttonTextColor);
-
-        SDL_RenderPresent(g_renderer); 
+        perf_end(PERF_TEXT);
+        perf_draw_hud(g_renderer, g_font);
+
+        perf_begin(PERF_PRESENT);
+        SDL_RenderPresent(g_renderer);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
+        frame_sched_presented(&frame_sched);
     }
 
+    perf_shutdown();
+    line_raster_shutdown(&g_line_raster);
     if (g_attractor_points != NULL) {
         free(g_attractor_points);
         g_attractor_points = NULL;
         printf("Freed g_attractor_points.\n");
     }
+    vec_soa_free(&g_attractor_soa);
+    vec_soa_free(&g_view_points);
     if (g_font != NULL) {
         TTF_CloseFont(g_font);
         g_font = NULL;
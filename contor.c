@@ -5,54 +5,143 @@
 #include <stdbool.h>
 #include <math.h>
 #include <SDL2/SDL_ttf.h>
+#include "perfhud.h"
+#include "framesched.h"
+#include "golden.h"
 
 // Window dimensions
 #define WIDTH 960
 #define HEIGHT 960
 
-// L-System rules
-const char* RULE_A = "ABA";
-const char* RULE_B = "BBB";
-const char* INITIAL_STATE = "A";
+#define MAX_ITERATIONS 100
+
+// Gaps narrower than this many pixels at a ring's outer edge are merged away
+#define CANTOR_MERGE_PIXELS 0.5
+
+// One kept interval of the Cantor set, in fractions of a full turn. Level j is the
+// set after j removals (the 'A' runs of the L-system A -> ABA, B -> BBB).
+typedef struct {
+    double start, end;
+} CantorInterval;
+
+CantorInterval* g_cantor_intervals = NULL;  // All levels back to back, each sorted
+int g_cantor_level_start[MAX_ITERATIONS + 1];
+int g_cantor_interval_count = 0;
+int g_cantor_interval_capacity = 0;
+int g_cantor_levels = -1;                   // Iteration count the lists were built for
+
+uint32_t* g_cantor_pixels = NULL;
+
+// --- Cantor Interval Lists ---
+// Appends to the level that starts at `level_first`, merging with the previous
+// interval when the gap between them is below `min_gap`
+bool append_cantor_interval(int level_first, double start, double end, double min_gap) {
+    if (g_cantor_interval_count > level_first &&
+        start - g_cantor_intervals[g_cantor_interval_count - 1].end < min_gap) {
+        g_cantor_intervals[g_cantor_interval_count - 1].end = end;
+        return true;
+    }
+    if (g_cantor_interval_count == g_cantor_interval_capacity) {
+        int new_capacity = g_cantor_interval_capacity > 0 ? g_cantor_interval_capacity * 2 : 1024;
+        CantorInterval* temp = (CantorInterval*)realloc(g_cantor_intervals, new_capacity * sizeof(CantorInterval));
+        if (!temp) {
+            perror("Failed to allocate memory for Cantor intervals");
+            return false;
+        }
+        g_cantor_intervals = temp;
+        g_cantor_interval_capacity = new_capacity;
+    }
+    g_cantor_intervals[g_cantor_interval_count++] = (CantorInterval){start, end};
+    return true;
+}
 
-// --- L-System String Generation Functions ---
-const char* get_rule_expansion(char c) {
-    if (c == 'A') return RULE_A;
-    if (c == 'B') return RULE_B;
-    return "";
+// Emits the level-`depth` descendants of [start, end) in order. Once the widest gap
+// inside a subtree ((end - start) / 3) is below `min_gap`, every gap in it would be
+// merged anyway, so the subtree is emitted as one interval.
+bool emit_cantor_intervals(int level_first, double start, double end, int depth, double min_gap) {
+    double third = (end - start) / 3.0;
+    if (depth == 0 || third < min_gap) {
+        return append_cantor_interval(level_first, start, end, min_gap);
+    }
+    return emit_cantor_intervals(level_first, start, start + third, depth - 1, min_gap) &&
+           emit_cantor_intervals(level_first, end - third, end, depth - 1, min_gap);
 }
 
-char* expand_lsystem_iteration(const char* current_str) {
-    if (!current_str) return NULL;
+// Builds the interval list of every ring once per iteration count. Ring j shows level j;
+// gaps narrower than CANTOR_MERGE_PIXELS at its outer radius cannot show, so the lists
+// stay proportional to the ring's circumference instead of 2^j.
+bool build_cantor_intervals(int num_iterations) {
+    if (g_cantor_levels == num_iterations) {
+        return true;
+    }
+    g_cantor_levels = -1;
+    g_cantor_interval_count = 0;
 
-    size_t current_len = strlen(current_str);
-    size_t estimated_new_len = current_len * 3 + 1;
-    char* new_str = (char*)malloc(estimated_new_len);
-    if (!new_str) {
-        perror("Failed to allocate memory for new L-system string");
-        return NULL;
+    double band_height = (WIDTH / 2.0) / num_iterations;
+    for (int j = 0; j < num_iterations; ++j) {
+        double outer_radius = j * band_height + band_height + 1;
+        double min_gap = CANTOR_MERGE_PIXELS / (2 * M_PI * outer_radius);
+        g_cantor_level_start[j] = g_cantor_interval_count;
+        if (!emit_cantor_intervals(g_cantor_interval_count, 0.0, 1.0, j, min_gap)) {
+            return false;
+        }
     }
-    new_str[0] = '\0';
-
-    size_t current_pos = 0;
-    for (size_t i = 0; i < current_len; ++i) {
-        const char* expansion = get_rule_expansion(current_str[i]);
-        size_t expansion_len = strlen(expansion);
-
-        while (current_pos + expansion_len + 1 >= estimated_new_len) {
-            estimated_new_len += 500;
-            char* temp = (char*)realloc(new_str, estimated_new_len);
-            if (!temp) {
-                perror("Failed to reallocate memory for new L-system string");
-                free(new_str);
-                return NULL;
-            }
-            new_str = temp;
+    g_cantor_level_start[num_iterations] = g_cantor_interval_count;
+    g_cantor_levels = num_iterations;
+    return true;
+}
+
+// Fraction of a full turn at (dx, dy), matching the original angle origin at -pi
+double cantor_turn_at(double dx, double dy) {
+    return (atan2(dy, dx) + M_PI) / (2 * M_PI);
+}
+
+// dx on the row dy where the angle is `turn`. atan2 is monotonic along a row, so each
+// interval of a level maps to one span of x.
+double cantor_dx_at(double turn, double dy) {
+    return dy / tan(turn * 2 * M_PI - M_PI);
+}
+
+// Fills the pixels in columns [x_first, x_last] of a row whose horizontal extent
+// overlaps a level-j interval
+long long fill_cantor_span(uint32_t* row, int j, double dy, int x_first, int x_last) {
+    const double center_x = WIDTH / 2;
+    double span_lo = x_first - center_x;
+    double span_hi = x_last + 1 - center_x;
+    double turn_a = cantor_turn_at(span_lo, dy);
+    double turn_b = cantor_turn_at(span_hi, dy);
+    double turn_min = fmin(turn_a, turn_b);
+    double turn_max = fmax(turn_a, turn_b);
+
+    // First interval ending after turn_min
+    int lo = g_cantor_level_start[j];
+    int hi = g_cantor_level_start[j + 1];
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (g_cantor_intervals[mid].end <= turn_min) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
-        strcpy(new_str + current_pos, expansion);
-        current_pos += expansion_len;
     }
-    return new_str;
+
+    long long filled = 0;
+    for (int i = lo; i < g_cantor_level_start[j + 1] && g_cantor_intervals[i].start < turn_max; ++i) {
+        double dx_a = cantor_dx_at(fmax(g_cantor_intervals[i].start, turn_min), dy);
+        double dx_b = cantor_dx_at(fmin(g_cantor_intervals[i].end, turn_max), dy);
+        double from = fmax(fmin(dx_a, dx_b), span_lo);
+        double to = fmin(fmax(dx_a, dx_b), span_hi);
+        if (from > to) continue;
+        int x_from = (int)floor(from + center_x);
+        int x_to = (int)floor(to + center_x);
+        if (x_from < x_first) x_from = x_first;
+        if (x_to > x_last) x_to = x_last;
+        for (int x = x_from; x <= x_to; ++x) {
+            row[x] = 0xFF000000;
+        }
+        filled += x_to - x_from + 1;
+    }
+    return filled;
 }
 
 // Function to render text on the screen
@@ -111,76 +200,105 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename) {
 }
 
 // --- Main Drawing Function ---
-void draw_lsystem_fractal(SDL_Renderer* renderer, int num_iterations) {
-    int draw_origin_x = WIDTH / 2;
-    int draw_origin_y = HEIGHT / 2;
-
-    // Clear with white background before drawing fractal
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    SDL_RenderClear(renderer);
-
-    // Set draw color for the fractal (black)
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-
-    double band_height = (WIDTH / 2.0) / num_iterations;
-    char* current_lsystem_str = strdup(INITIAL_STATE);
-    if (!current_lsystem_str) {
-        fprintf(stderr, "Failed to duplicate initial state string.\n");
-        return;
+// Rasterizes the rings into g_cantor_pixels and returns the number of ring pixels
+long long fill_cantor_rings(int num_iterations) {
+    const double center_x = WIDTH / 2;
+    const double center_y = HEIGHT / 2;
+    long long pixels_filled = 0;
+
+    // White background
+    for (int i = 0; i < WIDTH * HEIGHT; ++i) {
+        g_cantor_pixels[i] = 0xFFFFFFFF;
     }
 
-    for (int j = 0; j < num_iterations; ++j) {
-        // printf("Generating and drawing iteration %d (current string length: %zu)\n", j, strlen(current_lsystem_str));
-
-        double inner_radius = j * band_height;
-        double outer_radius = inner_radius + band_height + 1;
-
-        size_t str_length = strlen(current_lsystem_str);
-
-        for (size_t i = 0; i < str_length; ++i) {
-            if (current_lsystem_str[i] == 'A') {
-                double start_angle_rad = (double)i / str_length * (2 * M_PI) - M_PI;
-                double end_angle_rad = (double)(i + 1) / str_length * (2 * M_PI) - M_PI;
-                double angle_span = end_angle_rad - start_angle_rad;
-
-                int num_steps_for_segment = fmax(2, (int)(fabs(angle_span) * 500.0 / M_PI));
-                num_steps_for_segment = fmin(num_steps_for_segment, 50);
-
-                for (double r = inner_radius; r <= outer_radius; r += 1.0) {
-                    for (int k = 0; k < num_steps_for_segment; ++k) {
-                        double current_angle = start_angle_rad + (double)k / num_steps_for_segment * angle_span;
-                        int x_coord = (int)(draw_origin_x + r * cos(current_angle));
-                        int y_coord = (int)(draw_origin_y + r * sin(current_angle));
-                        SDL_RenderDrawPoint(renderer, x_coord, y_coord);
-                    }
+    if (num_iterations > 0 && build_cantor_intervals(num_iterations)) {
+        double band_height = (WIDTH / 2.0) / num_iterations;
+        for (int y = 0; y < HEIGHT; ++y) {
+            uint32_t* row = g_cantor_pixels + (size_t)y * WIDTH;
+            double dy = y + 0.5 - center_y;
+            for (int j = 0; j < num_iterations; ++j) {
+                double inner_radius = j * band_height;
+                double outer_radius = inner_radius + band_height + 1;
+                if (fabs(dy) >= outer_radius) continue;
+
+                // Pixel centres with inner_radius <= r < outer_radius (the rings overlap by a pixel)
+                double outer_dx = sqrt(outer_radius * outer_radius - dy * dy);
+                double inner_dx = fabs(dy) < inner_radius ? sqrt(inner_radius * inner_radius - dy * dy) : 0.0;
+                int left_from = (int)floor(center_x - outer_dx - 0.5) + 1;
+                int left_to = (int)floor(center_x - inner_dx - 0.5);
+                int right_from = (int)ceil(center_x + inner_dx - 0.5);
+                int right_to = (int)ceil(center_x + outer_dx - 0.5) - 1;
+                if (left_from < 0) left_from = 0;
+                if (right_to >= WIDTH) right_to = WIDTH - 1;
+                if (inner_dx == 0.0) {
+                    // The row misses the inner disc: one span through the middle
+                    left_to = right_to;
+                    right_from = right_to + 1;
+                }
+                if (left_from <= left_to) {
+                    pixels_filled += fill_cantor_span(row, j, dy, left_from, left_to);
+                }
+                if (right_from <= right_to) {
+                    pixels_filled += fill_cantor_span(row, j, dy, right_from, right_to);
                 }
-            }
-        }
-
-        if (j < num_iterations - 1) {
-            char* next_lsystem_str = expand_lsystem_iteration(current_lsystem_str);
-            free(current_lsystem_str);
-            current_lsystem_str = next_lsystem_str;
-            if (!current_lsystem_str) {
-                fprintf(stderr, "Failed to expand L-system string for next iteration.\n");
-                break;
             }
         }
     }
+    return pixels_filled;
+}
 
-    free(current_lsystem_str);
+// Rasterizes the rings and uploads them. Only called when the iteration count changes;
+// frames in between just copy the texture.
+void draw_cantor_rings(SDL_Texture* texture, int num_iterations) {
+    perf_begin(PERF_COMPUTE);
+    long long pixels_filled = fill_cantor_rings(num_iterations);
+    perf_end(PERF_COMPUTE);
+
+    perf_begin(PERF_UPLOAD);
+    SDL_UpdateTexture(texture, NULL, g_cantor_pixels, WIDTH * sizeof(uint32_t));
+    perf_end(PERF_UPLOAD);
+    perf_add_iterations(g_cantor_interval_count);
+    perf_add_pixels(pixels_filled);
+}
+
+// Fixed ring counts pinned by 'make golden' (name, unused bounds, iterations); the
+// rings have no camera
+const GoldenView g_golden_views[] = {
+    {"rings5", 0.0, 0.0, 0.0, 0.0, 5},
+    {"rings24", 0.0, 0.0, 0.0, 0.0, 24},
+    {"rings100", 0.0, 0.0, 0.0, 0.0, MAX_ITERATIONS},
+};
+
+// Renders a golden view through the same rasterizer as the window
+const uint32_t* render_cantor_golden_view(const GoldenView* view, int* pixel_count) {
+    if (g_cantor_pixels == NULL) {
+        g_cantor_pixels = (uint32_t*)malloc(sizeof(uint32_t) * WIDTH * HEIGHT);
+        if (g_cantor_pixels == NULL) return NULL;
+    }
+    fill_cantor_rings(view->max_iterations);
+    *pixel_count = WIDTH * HEIGHT;
+    return g_cantor_pixels;
 }
 
 // --- Main Program ---
-int main() {
+int main(int argc, char* argv[]) {
+    // Golden-image regression check: render the fixed views headlessly and compare
+    GoldenOptions golden_options;
+    int golden_status = golden_parse_args(argc, argv, &golden_options);
+    if (golden_status != 0) {
+        if (golden_status < 0) return 1;
+        return golden_run_frames(&golden_options, "contor", g_golden_views, GOLDEN_VIEW_COUNT(g_golden_views),
+                                 render_cantor_golden_view);
+    }
+
+    perf_init(argc, argv);
+
     int num_iterations;
-    printf("Higher numbers will take significantly longer to generate and may consume a lot of memory.\n");
-    printf("Recommended max iterations: 10-11 for quick results.\n");
-    printf("Values above 12-13 can be very slow or crash due to memory usage.\n");
+    printf("Each iteration adds one ring; sub-pixel gaps are merged, so memory stays small.\n");
 
 
     while (true) {
-        printf("Enter the number of iterations (0 to ~13 recommended): ");
+        printf("Enter the number of iterations (0 to %d): ", MAX_ITERATIONS);
         if (scanf("%d", &num_iterations) == 1) {
             if (num_iterations >= 0) {
                 break;
@@ -193,7 +311,12 @@ int main() {
         }
     }
 
+    if (num_iterations > MAX_ITERATIONS) {
+        printf("Limiting iterations to %d.\n", MAX_ITERATIONS);
+        num_iterations = MAX_ITERATIONS;
+    }
     printf("Generating L-System Fractal with %d iterations...\n", num_iterations);
+    printf("Up/Down Arrows: Adjust iterations\n");
 
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
@@ -235,15 +358,37 @@ int main() {
         // Handle error: application can still run without font, but text won't display
     }
 
+    // The rings are rasterized on the CPU and kept in this texture between changes
+    SDL_Texture* cantor_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                                    SDL_TEXTUREACCESS_STREAMING, WIDTH, HEIGHT);
+    g_cantor_pixels = (uint32_t*)malloc(sizeof(uint32_t) * WIDTH * HEIGHT);
+    if (cantor_texture == NULL || g_cantor_pixels == NULL) {
+        printf("Failed to create the Cantor texture! SDL_Error: %s\n", SDL_GetError());
+        free(g_cantor_pixels);
+        if (cantor_texture != NULL) SDL_DestroyTexture(cantor_texture);
+        if (font != NULL) TTF_CloseFont(font);
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(pwindow);
+        TTF_Quit();
+        SDL_Quit();
+        return 1;
+    }
     // Define the screenshot button's position and size
     SDL_Rect screenshotButtonRect = {WIDTH - 120, 10, 110, 30};
 
     // --- Event Loop to keep window open ---
     bool application_running = true;
     SDL_Event event;
+    FrameScheduler frame_sched;
+    frame_sched_init(&frame_sched, FRAME_SCHED_MAX_FPS);
 
     while (application_running) {
-        while (SDL_PollEvent(&event)) {
+        while (application_running && frame_sched_next_event(&frame_sched, &event)) {
+            if (perf_handle_event(&event)) {
+                frame_sched_damage(&frame_sched, FRAME_DAMAGE_OVERLAY);
+                continue;
+            }
+            if (frame_sched_window_event(&frame_sched, &event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
@@ -254,18 +399,34 @@ int main() {
                             event.button.x <= screenshotButtonRect.x + screenshotButtonRect.w &&
                             event.button.y >= screenshotButtonRect.y &&
                             event.button.y <= screenshotButtonRect.y + screenshotButtonRect.h) {
+                            Uint64 trace_start = trace_begin();
                             saveScreenshot(renderer, "lsystem_fractal_screenshot.bmp");
+                            trace_end("screenshot", trace_start);
                         }
                     }
                     break;
+                case SDL_KEYDOWN:
+                    if (event.key.keysym.sym == SDLK_UP && num_iterations < MAX_ITERATIONS) {
+                        num_iterations++;
+                        frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE);
+                    } else if (event.key.keysym.sym == SDLK_DOWN && num_iterations > 0) {
+                        num_iterations--;
+                        frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE);
+                    }
+                    break;
             }
         }
 
         // --- Rendering ---
-        // Redraw the fractal in every frame
-        draw_lsystem_fractal(renderer, num_iterations);
+        if (frame_sched_scene_damaged(&frame_sched)) {
+            draw_cantor_rings(cantor_texture, num_iterations);
+        }
+        perf_begin(PERF_DRAW);
+        SDL_RenderCopy(renderer, cantor_texture, NULL, NULL);
+        perf_end(PERF_DRAW);
 
         // Render current iteration count
+        perf_begin(PERF_TEXT);
         if (font != NULL) {
             char text_buffer[100];
             SDL_Color textColor = {0, 0, 0, 255};
@@ -282,12 +443,21 @@ int main() {
             SDL_Color buttonTextColor = {255, 255, 255, 255};
             renderText(renderer, font, "Save", screenshotButtonRect.x + 8, screenshotButtonRect.y + 5, buttonTextColor);
         }
+        perf_end(PERF_TEXT);
+        perf_draw_hud(renderer, font);
 
+        perf_begin(PERF_PRESENT);
         SDL_RenderPresent(renderer);
-        SDL_Delay(10);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
+        frame_sched_presented(&frame_sched);
     }
 
     // --- Cleanup ---
+    perf_shutdown();
+    free(g_cantor_intervals);
+    free(g_cantor_pixels);
+    SDL_DestroyTexture(cantor_texture);
     if (font != NULL) {
         TTF_CloseFont(font);
     }
@@ -0,0 +1,184 @@
+#ifndef DEEPVIEW_H
+#define DEEPVIEW_H
+
+// Deep-zoom camera for the grid-structured fractals (Vicsek, Sierpinski).
+//
+// The fractal lives in a root cell [0, 1) x [0, 1) that is split into a
+// base x base grid at every level. Instead of storing the view in root
+// coordinates, which run out of double precision after ~50 doublings, the
+// camera stores the address of an anchor cell (one digit per level and axis)
+// and an affine map from screen pixels to coordinates local to that cell.
+// deep_view_normalize() moves the anchor down while zooming in and back up
+// while zooming out, so the local coordinates stay close to [-1, 2) and keep
+// full precision at any depth.
+//
+// A view spans at most DEEP_VIEW_SPAN anchor cells per axis, so the only
+// cells it can touch are the anchor and its eight neighbours.
+//
+// Functions are 'static inline' like perfhud.h.
+
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define DEEP_VIEW_MAX_LEVELS 4096
+#define DEEP_VIEW_SPAN 2.0
+
+typedef struct {
+    int base;
+    int levels;  // Length of the anchor address
+    unsigned char x_digits[DEEP_VIEW_MAX_LEVELS];  // Most significant first
+    unsigned char y_digits[DEEP_VIEW_MAX_LEVELS];
+    // Local coordinates of screen point (sx, sy):
+    //   x = x0 + sx * xx + sy * xy,  y = y0 + sx * yx + sy * yy
+    double x0, xx, xy;
+    double y0, yx, yy;
+    int width, height;  // Screen size in pixels
+} DeepView;
+
+static inline void deep_view_init(DeepView* view, int base, int width, int height,
+                                  double x0, double xx, double xy,
+                                  double y0, double yx, double yy) {
+    view->base = base;
+    view->levels = 0;
+    view->x0 = x0; view->xx = xx; view->xy = xy;
+    view->y0 = y0; view->yx = yx; view->yy = yy;
+    view->width = width;
+    view->height = height;
+}
+
+static inline void deep_view_local(const DeepView* view, double sx, double sy, double* x, double* y) {
+    *x = view->x0 + sx * view->xx + sy * view->xy;
+    *y = view->y0 + sx * view->yx + sy * view->yy;
+}
+
+static inline void deep_view_screen(const DeepView* view, double x, double y, double* sx, double* sy) {
+    double det = view->xx * view->yy - view->xy * view->yx;
+    double dx = x - view->x0, dy = y - view->y0;
+    *sx = (dx * view->yy - dy * view->xy) / det;
+    *sy = (dy * view->xx - dx * view->yx) / det;
+}
+
+// Bounding box of the screen in local coordinates
+static inline void deep_view_extent(const DeepView* view, double* x_min, double* x_max, double* y_min, double* y_max) {
+    double corners[4][2] = {{0, 0}, {view->width, 0}, {0, view->height}, {view->width, view->height}};
+    deep_view_local(view, corners[0][0], corners[0][1], x_min, y_min);
+    *x_max = *x_min;
+    *y_max = *y_min;
+    for (int i = 1; i < 4; ++i) {
+        double x, y;
+        deep_view_local(view, corners[i][0], corners[i][1], &x, &y);
+        if (x < *x_min) *x_min = x;
+        if (x > *x_max) *x_max = x;
+        if (y < *y_min) *y_min = y;
+        if (y > *y_max) *y_max = y;
+    }
+}
+
+// Moves the content by (dx, dy) pixels
+static inline void deep_view_pan(DeepView* view, double dx, double dy) {
+    view->x0 -= dx * view->xx + dy * view->xy;
+    view->y0 -= dx * view->yx + dy * view->yy;
+}
+
+// Magnifies by 'factor' (> 1 zooms in) keeping screen point (sx, sy) fixed
+static inline void deep_view_zoom(DeepView* view, double sx, double sy, double factor) {
+    double x, y;
+    deep_view_local(view, sx, sy, &x, &y);
+    view->xx /= factor; view->xy /= factor;
+    view->yx /= factor; view->yy /= factor;
+    view->x0 = x - sx * view->xx - sy * view->xy;
+    view->y0 = y - sx * view->yx - sy * view->yy;
+}
+
+// Adds 'delta' (-1 or +1) to the address 'digits' of length 'levels'. Returns false,
+// leaving it unchanged, if the result falls outside the root cell.
+static inline bool deep_view_step(unsigned char* digits, int levels, int base, int delta) {
+    int k = levels - 1;
+    while (k >= 0 && digits[k] == (delta > 0 ? base - 1 : 0)) {
+        k--;
+    }
+    if (k < 0) {
+        return false;
+    }
+    digits[k] = (unsigned char)(digits[k] + delta);
+    memset(digits + k + 1, delta > 0 ? 0 : base - 1, (size_t)(levels - k - 1));
+    return true;
+}
+
+// Address of the cell 'offset' (-1, 0 or 1) cells away from the anchor along one axis
+static inline bool deep_view_neighbor(const DeepView* view, const unsigned char* digits, int offset, unsigned char* out) {
+    memcpy(out, digits, (size_t)view->levels);
+    return offset == 0 || deep_view_step(out, view->levels, view->base, offset);
+}
+
+// Re-roots the camera at the cell of the current level-of-detail that holds the
+// view centre: descends while the view spans at most DEEP_VIEW_SPAN child cells,
+// ascends while it spans more than DEEP_VIEW_SPAN anchor cells
+static inline void deep_view_normalize(DeepView* view) {
+    for (;;) {
+        double x_min, x_max, y_min, y_max;
+        deep_view_extent(view, &x_min, &x_max, &y_min, &y_max);
+        double span = fmax(x_max - x_min, y_max - y_min);
+        double cx = (x_min + x_max) / 2.0, cy = (y_min + y_max) / 2.0;
+
+        // Follow the centre into a neighbouring cell
+        if (view->levels > 0) {
+            int dx = cx < 0.0 ? -1 : (cx >= 1.0 ? 1 : 0);
+            int dy = cy < 0.0 ? -1 : (cy >= 1.0 ? 1 : 0);
+            bool moved = false;
+            if (dx != 0 && deep_view_step(view->x_digits, view->levels, view->base, dx)) {
+                view->x0 -= dx;
+                moved = true;
+            }
+            if (dy != 0 && deep_view_step(view->y_digits, view->levels, view->base, dy)) {
+                view->y0 -= dy;
+                moved = true;
+            }
+            if (moved) continue;
+        }
+
+        if (span > DEEP_VIEW_SPAN && view->levels > 0) {
+            view->levels--;
+            double digit_x = view->x_digits[view->levels], digit_y = view->y_digits[view->levels];
+            view->x0 = (view->x0 + digit_x) / view->base;
+            view->y0 = (view->y0 + digit_y) / view->base;
+            view->xx /= view->base; view->xy /= view->base;
+            view->yx /= view->base; view->yy /= view->base;
+        } else if (span * view->base <= DEEP_VIEW_SPAN && view->levels < DEEP_VIEW_MAX_LEVELS) {
+            int digit_x = (int)floor(cx * view->base);
+            int digit_y = (int)floor(cy * view->base);
+            if (digit_x < 0) digit_x = 0;
+            if (digit_x >= view->base) digit_x = view->base - 1;
+            if (digit_y < 0) digit_y = 0;
+            if (digit_y >= view->base) digit_y = view->base - 1;
+            view->x_digits[view->levels] = (unsigned char)digit_x;
+            view->y_digits[view->levels] = (unsigned char)digit_y;
+            view->levels++;
+            view->x0 = view->x0 * view->base - digit_x;
+            view->y0 = view->y0 * view->base - digit_y;
+            view->xx *= view->base; view->xy *= view->base;
+            view->yx *= view->base; view->yy *= view->base;
+        } else {
+            return;
+        }
+    }
+}
+
+// Root coordinates of local point (x, y), rounded to double (for display only)
+static inline void deep_view_root(const DeepView* view, double x, double y, double* root_x, double* root_y) {
+    for (int k = view->levels - 1; k >= 0; --k) {
+        x = (x + view->x_digits[k]) / view->base;
+        y = (y + view->y_digits[k]) / view->base;
+    }
+    *root_x = x;
+    *root_y = y;
+}
+
+// log10 of the magnification along x relative to 'root_pixels' pixels per root cell
+static inline double deep_view_zoom_log10(const DeepView* view, double root_pixels) {
+    double pixels = 1.0 / hypot(view->xx, view->yx);
+    return view->levels * log10((double)view->base) + log10(pixels / root_pixels);
+}
+
+#endif
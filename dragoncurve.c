@@ -5,6 +5,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <stdint.h>
+#include <limits.h>
+#include "perfhud.h"
+#include "golden.h"
 
 // PI for degrees to radians conversion
 #ifndef M_PI
@@ -15,23 +19,37 @@
 #define INITIAL_WIDTH 800
 #define INITIAL_HEIGHT 800
 
-// Turtle graphics state
+// Unit steps for the four quarter-turn headings
+const int DRAGON_STEP_X[4] = {1, 0, -1, 0};
+const int DRAGON_STEP_Y[4] = {0, 1, 0, -1};
+
+// Number of iterations (2^n segments)
+#define MAX_L_SYSTEM_ITERATIONS 32
+
+#define DRAGON_MAX_THREADS 64
+
+// Lattice point of the curve (segments have unit length)
 typedef struct {
-    double x, y;
-    double angle;
-} TurtleState;
+    long long x, y;
+} DragonPoint;
 
-// L-System parameters
-const char* AXIOM = "FX";
-const char* RULE_X = "X+YF+";
-const char* RULE_Y = "-FX-Y";
-const double ANGLE_INCREMENT = M_PI / 2.0;
+// Blocks of at most 2^DRAGON_LEAF_LEVEL segments are walked step by step
+#define DRAGON_LEAF_LEVEL 8
 
-// Number of iterations
-#define MAX_L_SYSTEM_ITERATIONS 20
+typedef struct {
+    long long min_x, max_x, min_y, max_y;
+} DragonBounds;
 
-// Maximum string length to prevent excessive memory allocation
-#define MAX_L_SYSTEM_STRING_BUFFER_LENGTH 400000
+// One contiguous range of segments. Every worker starts from the closed-form vertex and
+// heading of its first segment, so no worker depends on another.
+typedef struct {
+    int index;
+    unsigned long long first_segment;
+    unsigned long long end_segment;
+    uint32_t* coverage;  // One bit per pixel
+    long long segments_drawn;
+    double busy_ms;
+} DragonWorker;
 
 // Global renderer, window, and font pointers
 SDL_Renderer* g_renderer = NULL;
@@ -48,104 +66,383 @@ double g_view_scale = 1.0;
 bool g_is_panning = false;
 int g_last_mouse_x, g_last_mouse_y;
 
-// Global variable for the L-System string
-char* g_l_system_string = NULL;
 int g_current_iterations = 14;
 
+DragonBounds g_dragon_bounds[MAX_L_SYSTEM_ITERATIONS + 1];  // Extents of the first 2^m segments
+bool g_dragon_bounds_ready = false;
+
+int g_dragon_thread_count = 1;
+uint32_t* g_dragon_coverage = NULL;  // One coverage bitmap per worker, back to back
+uint32_t* g_dragon_pixels = NULL;
+size_t g_dragon_buffer_pixels = 0;
+int g_dragon_width = 0;   // Size of the frame being rasterized
+int g_dragon_height = 0;
+
 // --- FORWARD DECLARATIONS ---
-char* generateLSystemString(int iterations);
 void renderText(SDL_Renderer* renderer, TTF_Font* font, const char* text, int x, int y, SDL_Color color);
 
 
-void getDragonCurveBoundingBox(int iterations, double* min_x, double* max_x, double* min_y, double* max_y) {
-    *min_x = *min_y = 1e10;
-    *max_x = *max_y = -1e10;
-
-    TurtleState turtle = {
-        .x = 0.0,
-        .y = 0.0,
-        .angle = 0.0
-    };
-
-    char* temp_l_system_string = generateLSystemString(iterations);
-    if (temp_l_system_string == NULL) return;
-
-    // Approximate step size for bounding box calculation.
-    double step_size = 1.0;
-
-    for (size_t i = 0; i < strlen(temp_l_system_string); ++i) {
-        char symbol = temp_l_system_string[i];
-
-        switch (symbol) {
-            case 'F':
-                turtle.x += step_size * cos(turtle.angle);
-                turtle.y += step_size * sin(turtle.angle);
-                break;
-            case '+':
-                turtle.angle += ANGLE_INCREMENT;
-                break;
-            case '-':
-                turtle.angle -= ANGLE_INCREMENT;
-                break;
+// --- Closed-Form Segment Generator ---
+// The curve is the L-system FX, X -> X+YF+, Y -> -FX-Y with quarter turns, but every
+// segment is derived from the bits of its index instead of rewriting a string.
+
+// Heading of segment k in quarter turns: popcount of its Gray code, mod 4
+int dragonHeading(unsigned long long k) {
+    unsigned long long gray = k ^ (k >> 1);
+    int count = 0;
+    while (gray != 0) {
+        gray &= gray - 1;
+        count++;
+    }
+    return count & 3;
+}
+
+// Turn at vertex k >= 1: left (+1) unless the bit above the lowest set bit is set (-1)
+int dragonTurn(unsigned long long k) {
+    return (((k & (~k + 1)) << 1) & k) ? 3 : 1;
+}
+
+// Vertex k of the curve. Segments [2^m, 2^(m+1)) retrace [0, 2^m) backwards, turned a
+// quarter turn clockwise about the end point E = (1+i)^m, so P(k) = E - i (P(2^(m+1) - k) - E).
+// Folding k into the lower half until it is 0, 1 or a power of two gives P(k) in O(log k)
+// as a chain of Gaussian-integer maps z -> a z + b.
+DragonPoint dragonVertex(unsigned long long k) {
+    long long ax = 1, ay = 0;
+    long long bx = 0, by = 0;
+    long long zx = (long long)k, zy = 0;
+
+    while (k > 1) {
+        int m = 0;
+        while ((k >> (m + 1)) != 0) {
+            m++;
+        }
+        long long ex = 1, ey = 0;
+        for (int i = 0; i < m; ++i) {
+            long long t = ex - ey;
+            ey = ex + ey;
+            ex = t;
         }
-        *min_x = fmin(*min_x, turtle.x);
-        *max_x = fmax(*max_x, turtle.x);
-        *min_y = fmin(*min_y, turtle.y);
-        *max_y = fmax(*max_y, turtle.y);
+        if (k == 1ULL << m) {
+            zx = ex;
+            zy = ey;
+            break;
+        }
+        // b += a (E + i E), a *= -i
+        long long cx = ex - ey, cy = ex + ey;
+        bx += ax * cx - ay * cy;
+        by += ax * cy + ay * cx;
+        long long t = ay;
+        ay = -ax;
+        ax = t;
+        k = (1ULL << (m + 1)) - k;
+        zx = (long long)k;
+        zy = 0;
     }
-    free(temp_l_system_string);
+
+    DragonPoint p = {ax * zx - ay * zy + bx, ax * zy + ay * zx + by};
+    return p;
 }
 
+// Fills g_dragon_bounds. The first 2^m segments are the first 2^(m-1) plus their copy turned
+// about E = (1+i)^(m-1), and a quarter turn maps a box to a box, so each level's extents
+// follow exactly from the previous one without walking the curve.
+void buildDragonBounds() {
+    if (g_dragon_bounds_ready) return;
+
+    g_dragon_bounds[0] = (DragonBounds){0, 1, 0, 0};
+    long long ex = 1, ey = 0;
+    for (int m = 1; m <= MAX_L_SYSTEM_ITERATIONS; ++m) {
+        DragonBounds b = g_dragon_bounds[m - 1];
+        // z -> E - i (z - E) sends (x, y) to (ex + y - ey, ey - x + ex)
+        long long turned_min_x = ex + b.min_y - ey;
+        long long turned_max_x = ex + b.max_y - ey;
+        long long turned_min_y = ey - b.max_x + ex;
+        long long turned_max_y = ey - b.min_x + ex;
+        if (turned_min_x < b.min_x) b.min_x = turned_min_x;
+        if (turned_max_x > b.max_x) b.max_x = turned_max_x;
+        if (turned_min_y < b.min_y) b.min_y = turned_min_y;
+        if (turned_max_y > b.max_y) b.max_y = turned_max_y;
+        g_dragon_bounds[m] = b;
+
+        long long t = ex - ey;
+        ey = ex + ey;
+        ex = t;
+    }
+    g_dragon_bounds_ready = true;
+}
 
-// --- Function to generate the L-System string ---
-char* generateLSystemString(int iterations) {
-    char* current_s = (char*)malloc(MAX_L_SYSTEM_STRING_BUFFER_LENGTH);
-    if (current_s == NULL) {
-        fprintf(stderr, "Memory allocation failed for L-System string.\n");
-        return NULL;
+// Extents of segments [s, s + 2^m) for s a multiple of 2^m. Such a block is the first 2^m
+// segments moved by a quarter-turn rotation, either traced forwards from `start` or
+// backwards from `end`; the heading of its first segment tells which.
+DragonBounds dragonBlockBounds(unsigned long long s, int m, DragonPoint start, DragonPoint end) {
+    DragonBounds b = g_dragon_bounds[m];
+    if (m == 0) {
+        b.min_x = start.x < end.x ? start.x : end.x;
+        b.max_x = start.x < end.x ? end.x : start.x;
+        b.min_y = start.y < end.y ? start.y : end.y;
+        b.max_y = start.y < end.y ? end.y : start.y;
+        return b;
+    }
+
+    // Rotation u with end - start = u (1+i)^m
+    long long ex = 1, ey = 0;
+    for (int i = 0; i < m; ++i) {
+        long long t = ex - ey;
+        ey = ex + ey;
+        ex = t;
+    }
+    long long dx = end.x - start.x, dy = end.y - start.y;
+    int u = 0;
+    while (!(ex == dx && ey == dy)) {
+        long long t = -ey;  // Multiply (ex, ey) by i
+        ey = ex;
+        ex = t;
+        u++;
     }
-    strcpy(current_s, AXIOM);
 
-    for (int i = 0; i < iterations; ++i) {
-        char* next_s = (char*)malloc(MAX_L_SYSTEM_STRING_BUFFER_LENGTH);
-        if (next_s == NULL) {
-            fprintf(stderr, "Memory allocation failed for next L-System string.\n");
-            free(current_s);
-            return NULL;
+    // Forward copies start in direction u; backward copies are the rotation -u about `end`
+    DragonPoint anchor = start;
+    if (dragonHeading(s) != u) {
+        anchor = end;
+        u = (u + 2) & 3;
+    }
+    long long corner_x[2] = {b.min_x, b.max_x};
+    long long corner_y[2] = {b.min_y, b.max_y};
+    DragonBounds out = {LLONG_MAX, LLONG_MIN, LLONG_MAX, LLONG_MIN};
+    for (int i = 0; i < 4; ++i) {
+        long long x = corner_x[i & 1], y = corner_y[i >> 1];
+        for (int r = 0; r < u; ++r) {
+            long long t = -y;
+            y = x;
+            x = t;
         }
-        next_s[0] = '\0'; // Ensure it's an empty string
-
-        size_t current_len = strlen(current_s);
-        for (size_t j = 0; j < current_len; ++j) {
-            char symbol = current_s[j];
-            if (symbol == 'X') {
-                if (strlen(next_s) + strlen(RULE_X) >= MAX_L_SYSTEM_STRING_BUFFER_LENGTH) {
-                    fprintf(stderr, "L-System string buffer full during X expansion. Truncating.\n");
-                    goto end_generation;
-                }
-                strcat(next_s, RULE_X);
-            } else if (symbol == 'Y') {
-                if (strlen(next_s) + strlen(RULE_Y) >= MAX_L_SYSTEM_STRING_BUFFER_LENGTH) {
-                    fprintf(stderr, "L-System string buffer full during Y expansion. Truncating.\n");
-                    goto end_generation;
-                }
-                strcat(next_s, RULE_Y);
-            } else {
-                if (strlen(next_s) + 1 >= MAX_L_SYSTEM_STRING_BUFFER_LENGTH) {
-                    fprintf(stderr, "L-System string buffer full during copy. Truncating.\n");
-                    goto end_generation;
-                }
-                size_t next_len = strlen(next_s);
-                next_s[next_len] = symbol;
-                next_s[next_len + 1] = '\0';
-            }
+        x += anchor.x;
+        y += anchor.y;
+        if (x < out.min_x) out.min_x = x;
+        if (x > out.max_x) out.max_x = x;
+        if (y < out.min_y) out.min_y = y;
+        if (y > out.max_y) out.max_y = y;
+    }
+    return out;
+}
+
+// --- Worker Threads ---
+void setDragonPixel(uint32_t* coverage, int x, int y) {
+    size_t bit = (size_t)y * g_dragon_width + x;
+    coverage[bit >> 5] |= 1u << (bit & 31);
+}
+
+void plotDragonRow(uint32_t* coverage, int y, int x0, int x1) {
+    if (y < 0 || y >= g_dragon_height) return;
+    int from = x0 < x1 ? x0 : x1;
+    int to = x0 < x1 ? x1 : x0;
+    if (from < 0) from = 0;
+    if (to >= g_dragon_width) to = g_dragon_width - 1;
+    for (int x = from; x <= to; ++x) {
+        setDragonPixel(coverage, x, y);
+    }
+}
+
+void plotDragonColumn(uint32_t* coverage, int x, int y0, int y1) {
+    if (x < 0 || x >= g_dragon_width) return;
+    int from = y0 < y1 ? y0 : y1;
+    int to = y0 < y1 ? y1 : y0;
+    if (from < 0) from = 0;
+    if (to >= g_dragon_height) to = g_dragon_height - 1;
+    for (int y = from; y <= to; ++y) {
+        setDragonPixel(coverage, x, y);
+    }
+}
+
+// Pixel of a lattice coordinate, clamped to a small margin around the texture. Segments
+// are axis-aligned, so clamping keeps the visible part exact and avoids int overflow at
+// deep zoom.
+int dragonPixel(double origin, double scale, long long coordinate, int size) {
+    return (int)floor(fmin(fmax(origin + coordinate * scale, -16.0), size + 16.0) + 0.5);
+}
+
+// Lattice range [*low, *high] that lands on the given (clamped) pixel
+void dragonPixelCell(double origin, double scale, int pixel, int size, double* low, double* high) {
+    double a = (pixel - 0.5 - origin) / scale;
+    double b = (pixel + 0.5 - origin) / scale;
+    *low = fmin(a, b);
+    *high = fmax(a, b);
+    if (pixel <= -16) {
+        if (scale > 0.0) *low = -INFINITY; else *high = INFINITY;
+    }
+    if (pixel >= size + 16) {
+        if (scale > 0.0) *high = INFINITY; else *low = -INFINITY;
+    }
+}
+
+// Walks segments [s, s + count) from vertex `p`. Steps that stay inside the pen's pixel
+// cell cost four compares; leaving it draws the path from the old pixel to the new one.
+void walkDragonSegments(DragonWorker* worker, unsigned long long s, unsigned long long count, DragonPoint p) {
+    const double origin_x = g_dragon_width / 2.0 - g_view_x_center * g_view_scale;
+    const double origin_y = g_dragon_height / 2.0 + g_view_y_center * g_view_scale;
+    const double scale_x = g_view_scale;
+    const double scale_y = -g_view_scale;  // Screen y points down
+
+    int heading = dragonHeading(s);
+    int pen_px = dragonPixel(origin_x, scale_x, p.x, g_dragon_width);
+    int pen_py = dragonPixel(origin_y, scale_y, p.y, g_dragon_height);
+    double cell_x_low, cell_x_high, cell_y_low, cell_y_high;
+    dragonPixelCell(origin_x, scale_x, pen_px, g_dragon_width, &cell_x_low, &cell_x_high);
+    dragonPixelCell(origin_y, scale_y, pen_py, g_dragon_height, &cell_y_low, &cell_y_high);
+    plotDragonRow(worker->coverage, pen_py, pen_px, pen_px);
+    long long segments_drawn = 0;
+
+    for (unsigned long long k = s; k < s + count; ++k) {
+        if (k != s) {
+            heading = (heading + dragonTurn(k)) & 3;
+        }
+        p.x += DRAGON_STEP_X[heading];
+        p.y += DRAGON_STEP_Y[heading];
+
+        double x = (double)p.x, y = (double)p.y;
+        if (x >= cell_x_low && x <= cell_x_high && y >= cell_y_low && y <= cell_y_high) {
+            continue;
         }
-        free(current_s);
-        current_s = next_s;
+        int current_px = dragonPixel(origin_x, scale_x, p.x, g_dragon_width);
+        int current_py = dragonPixel(origin_y, scale_y, p.y, g_dragon_height);
+        if (current_px == pen_px && current_py == pen_py) {
+            continue;  // Rounding at a cell edge
+        }
+        // Normally only one of these moves; both legs keep the path connected if a cell
+        // edge rounded the other way
+        plotDragonRow(worker->coverage, pen_py, pen_px, current_px);
+        plotDragonColumn(worker->coverage, current_px, pen_py, current_py);
+        segments_drawn++;
+        pen_px = current_px;
+        pen_py = current_py;
+        dragonPixelCell(origin_x, scale_x, pen_px, g_dragon_width, &cell_x_low, &cell_x_high);
+        dragonPixelCell(origin_y, scale_y, pen_py, g_dragon_height, &cell_y_low, &cell_y_high);
+    }
+    worker->segments_drawn += segments_drawn;
+}
+
+// Draws the block of segments [s, s + 2^m) between vertices `start` and `end`. Blocks
+// outside the texture are skipped and blocks inside a single pixel plot that pixel, so
+// only the visible, resolvable part of the curve is walked.
+void rasterizeDragonBlock(DragonWorker* worker, unsigned long long s, int m, DragonPoint start, DragonPoint end) {
+    const double origin_x = g_dragon_width / 2.0 - g_view_x_center * g_view_scale;
+    const double origin_y = g_dragon_height / 2.0 + g_view_y_center * g_view_scale;
+
+    DragonBounds b = dragonBlockBounds(s, m, start, end);
+    int left = dragonPixel(origin_x, g_view_scale, b.min_x, g_dragon_width);
+    int right = dragonPixel(origin_x, g_view_scale, b.max_x, g_dragon_width);
+    int top = dragonPixel(origin_y, -g_view_scale, b.max_y, g_dragon_height);
+    int bottom = dragonPixel(origin_y, -g_view_scale, b.min_y, g_dragon_height);
+    if (right < 0 || left >= g_dragon_width || bottom < 0 || top >= g_dragon_height) {
+        return;
+    }
+    if (left == right && top == bottom) {
+        setDragonPixel(worker->coverage, left, top);
+        worker->segments_drawn++;
+        return;
+    }
+    if (m <= DRAGON_LEAF_LEVEL) {
+        walkDragonSegments(worker, s, 1ULL << m, start);
+        return;
     }
 
-end_generation:
-    return current_s;
+    unsigned long long mid = s + (1ULL << (m - 1));
+    DragonPoint middle = dragonVertex(mid);
+    rasterizeDragonBlock(worker, s, m - 1, start, middle);
+    rasterizeDragonBlock(worker, mid, m - 1, middle, end);
+}
+
+// Splits the worker's range into aligned power-of-two blocks
+void rasterizeDragonSegments(DragonWorker* worker) {
+    unsigned long long s = worker->first_segment;
+    DragonPoint start = dragonVertex(s);
+    while (s < worker->end_segment) {
+        int m = 0;
+        while (m < MAX_L_SYSTEM_ITERATIONS && (s & (1ULL << m)) == 0 && s + (2ULL << m) <= worker->end_segment) {
+            m++;
+        }
+        DragonPoint end = dragonVertex(s + (1ULL << m));
+        rasterizeDragonBlock(worker, s, m, start, end);
+        s += 1ULL << m;
+        start = end;
+    }
+}
+
+int dragonWorkerThread(void* data) {
+    DragonWorker* worker = (DragonWorker*)data;
+    Uint64 start = SDL_GetPerformanceCounter();
+    char lane_name[32];
+    snprintf(lane_name, sizeof(lane_name), "dragon worker %d", worker->index);
+    trace_set_thread_name(lane_name);
+
+    rasterizeDragonSegments(worker);
+
+    Uint64 end = SDL_GetPerformanceCounter();
+    worker->busy_ms = perf_ms_between(start, end);
+    trace_record("rasterize", start, end);
+    return 0;
+}
+
+// Splits segments [0, 2^iterations) evenly, runs worker 0 on this thread and the others on
+// their own threads. Returns the summed busy time.
+double runDragonWorkers(DragonWorker* workers, int iterations) {
+    unsigned long long total = 1ULL << iterations;
+    for (int t = 0; t < g_dragon_thread_count; ++t) {
+        workers[t].index = t;
+        workers[t].first_segment = total / g_dragon_thread_count * t + (total % g_dragon_thread_count) * t / g_dragon_thread_count;
+        workers[t].end_segment = total / g_dragon_thread_count * (t + 1) + (total % g_dragon_thread_count) * (t + 1) / g_dragon_thread_count;
+        workers[t].segments_drawn = 0;
+    }
+
+    SDL_Thread* threads[DRAGON_MAX_THREADS];
+    for (int t = 1; t < g_dragon_thread_count; ++t) {
+        threads[t] = SDL_CreateThread(dragonWorkerThread, "dragon worker", &workers[t]);
+        if (threads[t] == NULL) {
+            dragonWorkerThread(&workers[t]);  // Fall back to running it inline
+        }
+    }
+    dragonWorkerThread(&workers[0]);
+    trace_set_thread_name("main");
+
+    double busy_ms = workers[0].busy_ms;
+    for (int t = 1; t < g_dragon_thread_count; ++t) {
+        if (threads[t] != NULL) {
+            SDL_WaitThread(threads[t], NULL);
+        }
+        busy_ms += workers[t].busy_ms;
+    }
+    return busy_ms;
+}
+
+void getDragonCurveBoundingBox(int iterations, double* min_x, double* max_x, double* min_y, double* max_y) {
+    buildDragonBounds();
+    *min_x = (double)g_dragon_bounds[iterations].min_x;
+    *max_x = (double)g_dragon_bounds[iterations].max_x;
+    *min_y = (double)g_dragon_bounds[iterations].min_y;
+    *max_y = (double)g_dragon_bounds[iterations].max_y;
+}
+
+bool ensureDragonBuffers(int texture_width, int texture_height) {
+    size_t pixel_count = (size_t)texture_width * texture_height;
+    if (pixel_count <= g_dragon_buffer_pixels && g_dragon_coverage != NULL) {
+        return true;
+    }
+    free(g_dragon_coverage);
+    free(g_dragon_pixels);
+    size_t coverage_words = (pixel_count + 31) / 32;
+    g_dragon_coverage = (uint32_t*)malloc(sizeof(uint32_t) * coverage_words * g_dragon_thread_count);
+    g_dragon_pixels = (uint32_t*)malloc(sizeof(uint32_t) * pixel_count);
+    if (g_dragon_coverage == NULL || g_dragon_pixels == NULL) {
+        fprintf(stderr, "Failed to allocate Dragon Curve buffers for %dx%d.\n", texture_width, texture_height);
+        free(g_dragon_coverage);
+        free(g_dragon_pixels);
+        g_dragon_coverage = NULL;
+        g_dragon_pixels = NULL;
+        g_dragon_buffer_pixels = 0;
+        return false;
+    }
+    g_dragon_buffer_pixels = pixel_count;
+    return true;
 }
 
 // --- Coordinate Mapping Functions ---
@@ -207,70 +504,95 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename, int window_wid
     SDL_FreeSurface(screenshot);
 }
 
+// Rasterizes the current view into g_dragon_pixels at the given size. Returns false if
+// the buffers cannot be allocated.
+bool rasterizeDragonCurve(int texture_width, int texture_height) {
+    if (!ensureDragonBuffers(texture_width, texture_height)) {
+        return false;
+    }
+    g_dragon_width = texture_width;
+    g_dragon_height = texture_height;
+
+    buildDragonBounds();
+
+    size_t pixel_count = (size_t)texture_width * texture_height;
+    size_t coverage_words = (pixel_count + 31) / 32;
+    memset(g_dragon_coverage, 0, sizeof(uint32_t) * coverage_words * g_dragon_thread_count);
+
+    DragonWorker workers[DRAGON_MAX_THREADS];
+    for (int t = 0; t < g_dragon_thread_count; ++t) {
+        workers[t].coverage = g_dragon_coverage + coverage_words * t;
+    }
+    double busy_ms = runDragonWorkers(workers, g_current_iterations);
+
+    // Merge the worker bitmaps into the curve colour on black
+    long long segments_drawn = 0;
+    for (int t = 1; t < g_dragon_thread_count; ++t) {
+        for (size_t i = 0; i < coverage_words; ++i) {
+            g_dragon_coverage[i] |= workers[t].coverage[i];
+        }
+    }
+    for (int t = 0; t < g_dragon_thread_count; ++t) {
+        segments_drawn += workers[t].segments_drawn;
+    }
+    for (size_t i = 0; i < pixel_count; ++i) {
+        bool covered = (g_dragon_coverage[i >> 5] >> (i & 31)) & 1u;
+        g_dragon_pixels[i] = covered ? 0xFF0096FF : 0xFF000000;
+    }
+
+    perf_add_iterations(1LL << g_current_iterations);
+    perf_add_pixels(segments_drawn);
+    perf_add_thread_time(g_dragon_thread_count, busy_ms);
+    return true;
+}
+
 // --- Function to draw the Dragon Curve onto g_dragon_curve_texture ---
 void drawDragonCurveToTexture() {
-    if (!g_renderer || !g_dragon_curve_texture || g_l_system_string == NULL) {
-        printf("Renderer, texture, or L-System string not initialized. Skipping drawing.\n");
+    if (!g_renderer || !g_dragon_curve_texture) {
+        printf("Renderer or texture not initialized. Skipping drawing.\n");
         return;
     }
 
-    printf("Drawing Dragon Curve to texture (Iterations: %d)...\n", g_current_iterations);
+    printf("Drawing Dragon Curve to texture (Iterations: %d, %d threads)...\n", g_current_iterations, g_dragon_thread_count);
+
+    char view[160];
+    snprintf(view, sizeof(view), "center:(%.10g, %.10g) scale:%.6g iterations=%d",
+             g_view_x_center, g_view_y_center, g_view_scale, g_current_iterations);
+    perf_set_view(view);
+    perf_begin(PERF_COMPUTE);
 
     int texture_width, texture_height;
     SDL_QueryTexture(g_dragon_curve_texture, NULL, NULL, &texture_width, &texture_height);
+    if (!rasterizeDragonCurve(texture_width, texture_height)) {
+        perf_end(PERF_COMPUTE);
+        return;
+    }
+    perf_end(PERF_COMPUTE);
 
-    // Set render target to our texture
-    SDL_SetRenderTarget(g_renderer, g_dragon_curve_texture);
-
-    // Clear the texture
-    SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 255);
-    SDL_RenderClear(g_renderer);
-
-    // Set drawing color for the curve
-    SDL_SetRenderDrawColor(g_renderer, 0, 150, 255, 255);
-
-    TurtleState turtle = {
-        .x = 0.0,
-        .y = 0.0,
-        .angle = 0.0
-    };
-
-    double segment_length = 1.0;
-
-    for (size_t i = 0; i < strlen(g_l_system_string); ++i) {
-        char symbol = g_l_system_string[i];
-        double prev_wx = turtle.x;
-        double prev_wy = turtle.y;
-
-        switch (symbol) {
-            case 'F':
-                turtle.x += segment_length * cos(turtle.angle);
-                turtle.y += segment_length * sin(turtle.angle);
-                break;
-            case '+':
-                turtle.angle += ANGLE_INCREMENT;
-                break;
-            case '-':
-                turtle.angle -= ANGLE_INCREMENT;
-                break;
-        }
-
-        if (symbol == 'F') {
-            int prev_px, prev_py, current_px, current_py;
-            map_world_to_pixel(prev_wx, prev_wy, &prev_px, &prev_py, texture_width, texture_height);
-            map_world_to_pixel(turtle.x, turtle.y, &current_px, &current_py, texture_width, texture_height);
+    perf_begin(PERF_UPLOAD);
+    SDL_UpdateTexture(g_dragon_curve_texture, NULL, g_dragon_pixels, texture_width * (int)sizeof(uint32_t));
+    perf_end(PERF_UPLOAD);
+}
 
-            if (fabs(current_px - prev_px) < texture_width * 2 && fabs(current_py - prev_py) < texture_height * 2 &&
-                (prev_px >= -texture_width && prev_px <= texture_width * 2) &&
-                (prev_py >= -texture_height && prev_py <= texture_height * 2) )
-            {
-                 SDL_RenderDrawLine(g_renderer, prev_px, prev_py, current_px, current_py);
-            }
-        }
+// Fixed views pinned by 'make golden' (name, x_min, x_max, y_min, y_max, iterations), in
+// curve coordinates where every segment has unit length
+const GoldenView g_golden_views[] = {
+    {"order10", -19.0, 30.0, -11.0, 38.0, 10},
+    {"order18", -320.0, 490.0, -192.0, 618.0, 18},
+    {"order24", 1350.0, 1450.0, -60.0, 40.0, 24},
+};
+
+// Renders a golden view at the initial window size through the same rasterizer as the window
+const uint32_t* renderDragonGoldenView(const GoldenView* view, int* pixel_count) {
+    g_current_iterations = view->max_iterations;
+    g_view_x_center = (view->x_min + view->x_max) / 2.0;
+    g_view_y_center = (view->y_min + view->y_max) / 2.0;
+    g_view_scale = INITIAL_WIDTH / (view->x_max - view->x_min);
+    if (!rasterizeDragonCurve(INITIAL_WIDTH, INITIAL_HEIGHT)) {
+        return NULL;
     }
-
-    // Restore default render target
-    SDL_SetRenderTarget(g_renderer, NULL);
+    *pixel_count = INITIAL_WIDTH * INITIAL_HEIGHT;
+    return g_dragon_pixels;
 }
 
 // --- Reset Function ---
@@ -294,19 +616,27 @@ void reset_view_and_curve() {
     g_view_x_center = min_x + curve_width / 2.0;
     g_view_y_center = min_y + curve_height / 2.0;
 
-    if (g_l_system_string != NULL) {
-        free(g_l_system_string);
-    }
-    g_l_system_string = generateLSystemString(g_current_iterations);
     drawDragonCurveToTexture();
 }
 
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Golden-image regression check: render the fixed views headlessly and compare
+    GoldenOptions golden_options;
+    int golden_status = golden_parse_args(argc, argv, &golden_options);
+    if (golden_status != 0) {
+        if (golden_status < 0) return 1;
+        return golden_run_frames(&golden_options, "dragoncurve", g_golden_views, GOLDEN_VIEW_COUNT(g_golden_views),
+                                 renderDragonGoldenView);
+    }
+
+    perf_init(argc, argv);
+
     printf("Left Click + Drag: Pan the view\n");
     printf("Mouse Wheel: Zoom in/out\n");
     printf("Up/Down Arrows: Adjust iterations\n");
     printf("R: Reset view and iterations\n");
+    printf("F1: Toggle performance HUD\n");
     printf("Click 'Save' button to save an image.\n");
 
     SDL_SetHint(SDL_HINT_RENDER_DRIVER, "wayland");
@@ -348,6 +678,10 @@ int main() {
     }
     SDL_SetRenderDrawBlendMode(g_renderer, SDL_BLENDMODE_BLEND);
 
+    g_dragon_thread_count = SDL_GetCPUCount();
+    if (g_dragon_thread_count < 1) g_dragon_thread_count = 1;
+    if (g_dragon_thread_count > DRAGON_MAX_THREADS) g_dragon_thread_count = DRAGON_MAX_THREADS;
+
     g_font = TTF_OpenFont("/usr/share/fonts/truetype/dejavu/DejaVuSans-Bold.ttf", 16);
     if (g_font == NULL) {
         fprintf(stderr, "Failed to load font! Please check font path: /usr/share/fonts/truetype/dejavu/DejaVuSans-Bold.ttf\nSDL_ttf Error: %s\n", TTF_GetError());
@@ -358,7 +692,7 @@ int main() {
     SDL_GetWindowSize(g_window, &window_width, &window_height);
     g_dragon_curve_texture = SDL_CreateTexture(g_renderer,
                                           SDL_PIXELFORMAT_ARGB8888,
-                                          SDL_TEXTUREACCESS_TARGET,
+                                          SDL_TEXTUREACCESS_STREAMING,
                                           window_width, window_height);
     if (g_dragon_curve_texture == NULL) {
         fprintf(stderr, "Failed to create Dragon Curve texture: %s\n", SDL_GetError());
@@ -370,18 +704,7 @@ int main() {
         return 1;
     }
 
-    // Initial generation and rendering of the curve to its texture
-    g_l_system_string = generateLSystemString(g_current_iterations);
-    if (g_l_system_string == NULL) {
-        fprintf(stderr, "Failed to generate initial L-System string. Exiting.\n");
-        if (g_font != NULL) TTF_CloseFont(g_font);
-        TTF_Quit();
-        SDL_DestroyTexture(g_dragon_curve_texture);
-        SDL_DestroyRenderer(g_renderer);
-        SDL_DestroyWindow(g_window);
-        SDL_Quit();
-        return 1;
-    }
+    // Initial rendering of the curve to its texture
     reset_view_and_curve();
 
     SDL_Rect screenshotButtonRect;
@@ -397,6 +720,7 @@ int main() {
         screenshotButtonRect = (SDL_Rect){current_window_width - 120, 10, 110, 30};
 
         while (SDL_PollEvent(&event)){
+            if (perf_handle_event(&event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
@@ -413,7 +737,7 @@ int main() {
                         }
                         g_dragon_curve_texture = SDL_CreateTexture(g_renderer,
                                                               SDL_PIXELFORMAT_ARGB8888,
-                                                              SDL_TEXTUREACCESS_TARGET,
+                                                              SDL_TEXTUREACCESS_STREAMING,
                                                               new_width, new_height);
                         if (g_dragon_curve_texture == NULL) {
                             fprintf(stderr, "Failed to recreate Dragon Curve texture after resize: %s\n", SDL_GetError());
@@ -432,7 +756,9 @@ int main() {
                             mouseX <= screenshotButtonRect.x + screenshotButtonRect.w &&
                             mouseY >= screenshotButtonRect.y &&
                             mouseY <= screenshotButtonRect.y + screenshotButtonRect.h) {
+                            Uint64 trace_start = trace_begin();
                             saveScreenshot(g_renderer, "dragon_curve_screenshot.bmp", current_window_width, current_window_height);
+                            trace_end("screenshot", trace_start);
                         } else if (event.button.button == SDL_BUTTON_LEFT) {
                             g_is_panning = true;
                             g_last_mouse_x = mouseX;
@@ -492,12 +818,6 @@ int main() {
                         if (g_current_iterations < MAX_L_SYSTEM_ITERATIONS) {
                             g_current_iterations++;
                             printf("Iterations: %d\n", g_current_iterations);
-                            free(g_l_system_string);
-                            g_l_system_string = generateLSystemString(g_current_iterations);
-                            if (g_l_system_string == NULL) {
-                                fprintf(stderr, "Failed to re-generate L-System string after iteration increase. Exiting.\n");
-                                application_running = false;
-                            }
                             re_draw_curve = true;
                         } else {
                             printf("Max iterations (%d) reached.\n", MAX_L_SYSTEM_ITERATIONS);
@@ -506,12 +826,6 @@ int main() {
                         if (g_current_iterations > 0) {
                             g_current_iterations--;
                             printf("Iterations: %d\n", g_current_iterations);
-                            free(g_l_system_string);
-                            g_l_system_string = generateLSystemString(g_current_iterations);
-                            if (g_l_system_string == NULL) {
-                                fprintf(stderr, "Failed to re-generate L-System string after iteration decrease. Exiting.\n");
-                                application_running = false; // Critical error
-                            }
                             re_draw_curve = true;
                         } else {
                             printf("Min iterations (0) reached.\n");
@@ -526,8 +840,11 @@ int main() {
         }
 
         // --- Rendering ---
+        perf_begin(PERF_DRAW);
         SDL_RenderCopy(g_renderer, g_dragon_curve_texture, NULL, NULL);
+        perf_end(PERF_DRAW);
 
+        perf_begin(PERF_TEXT);
         if (g_font != NULL) {
             char text_buffer[200];
             SDL_Color textColor = {255, 255, 255, 255};
@@ -552,14 +869,19 @@ int main() {
             SDL_Color buttonTextColor = {255, 255, 255, 255};
             renderText(g_renderer, g_font, "Save", screenshotButtonRect.x + 8, screenshotButtonRect.y + 5, buttonTextColor);
         }
+        perf_end(PERF_TEXT);
+        perf_draw_hud(g_renderer, g_font);
 
+        perf_begin(PERF_PRESENT);
         SDL_RenderPresent(g_renderer);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
     }
 
     // --- Cleanup ---
-    if (g_l_system_string != NULL) {
-        free(g_l_system_string);
-    }
+    perf_shutdown();
+    free(g_dragon_coverage);
+    free(g_dragon_pixels);
     if (g_dragon_curve_texture != NULL) {
         SDL_DestroyTexture(g_dragon_curve_texture);
     }
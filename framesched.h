@@ -0,0 +1,107 @@
+#ifndef FRAMESCHED_H
+#define FRAMESCHED_H
+
+// Event-driven frame scheduling for the viewers that only change on input.
+//
+// The event loop marks what an event changed with frame_sched_damage():
+// FRAME_DAMAGE_OVERLAY when the last frame only has to be painted again
+// (text, HUD, an exposed window), FRAME_DAMAGE_SCENE when the picture has to
+// be recomputed. frame_sched_next_event() replaces SDL_PollEvent(). While
+// nothing is damaged it sleeps in SDL_WaitEventTimeout, so an idle viewer uses
+// no CPU. Once something is damaged it keeps handing out queued events, and
+// waits for more until the frame cap allows the next frame. A burst of mouse
+// motion or wheel events is therefore handled in one pass, and one frame
+// shows all of it. frame_sched_presented() after SDL_RenderPresent clears the
+// damage.
+//
+// Functions are 'static inline' like perfhud.h.
+
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+#include "perfhud.h"
+
+#define FRAME_SCHED_MAX_FPS 60.0
+#define FRAME_SCHED_IDLE_MS 500  // Longest single sleep while idle
+
+enum {
+    FRAME_DAMAGE_OVERLAY = 1,  // Paint the frame again from what is already computed
+    FRAME_DAMAGE_SCENE = 2     // Recompute the picture
+};
+
+typedef struct {
+    unsigned damage;       // FRAME_DAMAGE_* flags since the last frame
+    double min_frame_ms;   // Frame cap
+    Uint64 last_present;
+    long long idle_waits;  // Times the viewer went to sleep
+} FrameScheduler;
+
+// Starts with the scene damaged so the first frame is drawn
+static inline void frame_sched_init(FrameScheduler* sched, double max_fps) {
+    sched->damage = FRAME_DAMAGE_SCENE | FRAME_DAMAGE_OVERLAY;
+    sched->min_frame_ms = max_fps > 0.0 ? 1000.0 / max_fps : 0.0;
+    sched->last_present = 0;
+    sched->idle_waits = 0;
+}
+
+static inline void frame_sched_damage(FrameScheduler* sched, unsigned damage) {
+    sched->damage |= damage;
+}
+
+static inline bool frame_sched_scene_damaged(const FrameScheduler* sched) {
+    return (sched->damage & FRAME_DAMAGE_SCENE) != 0;
+}
+
+// Damage caused by window events: a new size needs a new picture, an uncovered
+// window only a repaint. Returns true if the event was one of them.
+static inline bool frame_sched_window_event(FrameScheduler* sched, const SDL_Event* event) {
+    if (event->type != SDL_WINDOWEVENT) {
+        return false;
+    }
+    switch (event->window.event) {
+        case SDL_WINDOWEVENT_SIZE_CHANGED:
+        case SDL_WINDOWEVENT_RESIZED:
+            frame_sched_damage(sched, FRAME_DAMAGE_SCENE | FRAME_DAMAGE_OVERLAY);
+            return true;
+        case SDL_WINDOWEVENT_EXPOSED:
+        case SDL_WINDOWEVENT_RESTORED:
+        case SDL_WINDOWEVENT_SHOWN:
+            frame_sched_damage(sched, FRAME_DAMAGE_OVERLAY);
+            return true;
+    }
+    return false;
+}
+
+// Stores the next event in 'event' and returns true, sleeping until one arrives while
+// nothing is damaged. Returns false when the queue is empty and the next frame is due.
+static inline bool frame_sched_next_event(FrameScheduler* sched, SDL_Event* event) {
+    for (;;) {
+        if (sched->damage == 0) {
+            Uint64 idle_start = SDL_GetPerformanceCounter();
+            sched->idle_waits++;
+            while (!SDL_WaitEventTimeout(event, FRAME_SCHED_IDLE_MS)) {
+                // Still idle
+            }
+            trace_record("idle", idle_start, SDL_GetPerformanceCounter());
+            perf_frame_restart();
+            return true;
+        }
+        if (SDL_PollEvent(event)) {
+            return true;
+        }
+        double wait_ms = sched->min_frame_ms - perf_ms_between(sched->last_present, SDL_GetPerformanceCounter());
+        if (sched->last_present == 0 || wait_ms < 1.0) {
+            return false;
+        }
+        if (SDL_WaitEventTimeout(event, (int)wait_ms)) {
+            return true;
+        }
+    }
+}
+
+// Call after SDL_RenderPresent
+static inline void frame_sched_presented(FrameScheduler* sched) {
+    sched->damage = 0;
+    sched->last_present = SDL_GetPerformanceCounter();
+}
+
+#endif
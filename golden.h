@@ -0,0 +1,309 @@
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+// Golden-image regression harness for the escape-time kernels and the
+// deterministic frame renderers.
+//
+// Every covered program lists a small catalogue of fixed views. In golden
+// mode those views are rendered headlessly into a buffer of raw kernel results
+// (iteration counts, or the program's own per-pixel code), and each buffer is
+// reduced to an FNV-1a checksum and a magnitude sum. Programs that fill a
+// whole frame at once (golden_run_frames) are pinned by their ARGB pixels the
+// same way, so the checksum covers the code that fills the window:
+//
+// - Output: the checksum must match golden/<program>.golden (bit exact, the
+//   default). Only with --golden-tolerance above 0 is a different checksum
+//   accepted, if the relative change of the sum stays within the tolerance, so
+//   rounding drift from an optimization can be accepted on purpose without
+//   accepting a broken kernel.
+// - Speed (opt-in): the best of GOLDEN_TIMING_RUNS renders is compared with
+//   golden/<program>.timing; a view slower than its baseline by more than
+//   --golden-threshold percent (default 25) fails. Timing baselines depend on
+//   the machine and are not committed, so a view without one only has its
+//   output checked until --golden-baseline records one locally.
+//
+//   bin/mandelbrot --golden golden             check against the stored files
+//   bin/mandelbrot --golden-update golden      re-record checksums and timings
+//   bin/mandelbrot --golden-baseline golden    re-record timings only
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#define GOLDEN_WIDTH 320
+#define GOLDEN_HEIGHT 240
+#define GOLDEN_TIMING_RUNS 3
+#define GOLDEN_DEFAULT_THRESHOLD 25.0
+#define GOLDEN_MAX_RECORDS 32
+#define GOLDEN_VIEW_COUNT(views) ((int)(sizeof(views) / sizeof((views)[0])))
+
+// Returns the kernel result at plane coordinate (x, y) that is pinned by the checksum
+typedef int (*GoldenSampleFunc)(double x, double y, int max_iterations);
+
+typedef struct {
+    const char* name;
+    double x_min, x_max;
+    double y_min, y_max;
+    int max_iterations;  // Recursion depth or order for the frame renderers
+} GoldenView;
+
+// Renders 'view' into the program's own frame and returns its pixels ('pixel_count' of
+// them), or NULL on failure
+typedef const uint32_t* (*GoldenFrameFunc)(const GoldenView* view, int* pixel_count);
+
+typedef enum {
+    GOLDEN_CHECK,
+    GOLDEN_UPDATE,    // Checksums and timings
+    GOLDEN_BASELINE   // Timings only
+} GoldenMode;
+
+typedef struct {
+    GoldenMode mode;
+    const char* directory;
+    double tolerance;          // Allowed relative change of the sum when the checksum differs (0: none)
+    double threshold_percent;  // Allowed slowdown against the timing baseline
+} GoldenOptions;
+
+typedef struct {
+    char name[64];
+    uint64_t checksum;
+    long long sum;
+    double ms;
+} GoldenRecord;
+
+// Parses the golden options.
+// Returns 0 if no golden mode was requested, 1 if 'options' is valid, -1 on bad arguments.
+static int golden_parse_args(int argc, char* argv[], GoldenOptions* options) {
+    options->mode = GOLDEN_CHECK;
+    options->directory = NULL;
+    options->tolerance = 0.0;
+    options->threshold_percent = GOLDEN_DEFAULT_THRESHOLD;
+
+    for (int i = 1; i < argc; ++i) {
+        GoldenMode mode;
+        if (strcmp(argv[i], "--golden") == 0) {
+            mode = GOLDEN_CHECK;
+        } else if (strcmp(argv[i], "--golden-update") == 0) {
+            mode = GOLDEN_UPDATE;
+        } else if (strcmp(argv[i], "--golden-baseline") == 0) {
+            mode = GOLDEN_BASELINE;
+        } else if (strcmp(argv[i], "--golden-tolerance") == 0 && i + 1 < argc) {
+            options->tolerance = atof(argv[++i]);
+            continue;
+        } else if (strcmp(argv[i], "--golden-threshold") == 0 && i + 1 < argc) {
+            options->threshold_percent = atof(argv[++i]);
+            continue;
+        } else {
+            continue;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Usage: %s --golden|--golden-update|--golden-baseline DIR\n"
+                            "       [--golden-tolerance F] [--golden-threshold PERCENT]\n", argv[0]);
+            return -1;
+        }
+        options->mode = mode;
+        options->directory = argv[++i];
+    }
+    return options->directory != NULL ? 1 : 0;
+}
+
+// Returns the checksum of 'count' results; the sum of |result| (as signed 32-bit) goes to 'sum'
+static uint64_t golden_checksum(const uint32_t* results, int count, long long* sum) {
+    uint64_t hash = 14695981039346656037ull;  // FNV-1a over the little-endian bytes of each result
+    *sum = 0;
+    for (int i = 0; i < count; ++i) {
+        uint32_t value = results[i];
+        for (int byte = 0; byte < 4; ++byte) {
+            hash ^= (value >> (byte * 8)) & 0xFF;
+            hash *= 1099511628211ull;
+        }
+        int32_t result = (int32_t)value;
+        *sum += result < 0 ? -(long long)result : result;
+    }
+    return hash;
+}
+
+// Renders one view into 'buffer' and returns its checksum; the sum of |result| goes to 'sum'
+static uint64_t golden_render(const GoldenView* view, GoldenSampleFunc sample, int* buffer, long long* sum) {
+    double pixel_w = (view->x_max - view->x_min) / GOLDEN_WIDTH;
+    double pixel_h = (view->y_max - view->y_min) / GOLDEN_HEIGHT;
+    for (int py = 0; py < GOLDEN_HEIGHT; ++py) {
+        for (int px = 0; px < GOLDEN_WIDTH; ++px) {
+            buffer[py * GOLDEN_WIDTH + px] = sample(view->x_min + px * pixel_w, view->y_min + py * pixel_h,
+                                                    view->max_iterations);
+        }
+    }
+    return golden_checksum((const uint32_t*)buffer, GOLDEN_WIDTH * GOLDEN_HEIGHT, sum);
+}
+
+// Reads "name checksum sum" (.golden) or "name ms" (.timing) lines. Returns the record count.
+static int golden_load(const char* path, GoldenRecord* records, int is_timing) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return 0;
+    }
+    int count = 0;
+    char line[256];
+    while (count < GOLDEN_MAX_RECORDS && fgets(line, sizeof(line), file) != NULL) {
+        GoldenRecord* record = &records[count];
+        memset(record, 0, sizeof(*record));
+        unsigned long long checksum;
+        if (line[0] == '#') {
+            continue;
+        }
+        if (is_timing) {
+            if (sscanf(line, "%63s %lf", record->name, &record->ms) == 2) count++;
+        } else if (sscanf(line, "%63s %llx %lld", record->name, &checksum, &record->sum) == 3) {
+            record->checksum = checksum;
+            count++;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+static const GoldenRecord* golden_find(const GoldenRecord* records, int count, const char* name) {
+    for (int i = 0; i < count; ++i) {
+        if (strcmp(records[i].name, name) == 0) return &records[i];
+    }
+    return NULL;
+}
+
+// 'is_frame' marks results of a frame renderer, which are not GOLDEN_WIDTH x GOLDEN_HEIGHT
+static int golden_save(const char* path, const GoldenRecord* records, int count, int is_timing, int is_frame) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        perror("Failed to write golden file");
+        return 1;
+    }
+    char size[32];
+    if (is_frame) {
+        snprintf(size, sizeof(size), "frame pixels");
+    } else {
+        snprintf(size, sizeof(size), "%dx%d", GOLDEN_WIDTH, GOLDEN_HEIGHT);
+    }
+    if (is_timing) {
+        fprintf(file, "# view best_ms (%s, best of %d)\n", size, GOLDEN_TIMING_RUNS);
+    } else {
+        fprintf(file, "# view checksum sum (%s)\n", size);
+    }
+    for (int i = 0; i < count; ++i) {
+        if (is_timing) {
+            fprintf(file, "%s %.3f\n", records[i].name, records[i].ms);
+        } else {
+            fprintf(file, "%s %016llx %lld\n", records[i].name, (unsigned long long)records[i].checksum, records[i].sum);
+        }
+    }
+    fclose(file);
+    printf("Wrote %s\n", path);
+    return 0;
+}
+
+// Renders every view with 'frame' if given, else point by point with 'sample', then
+// checks or re-records. Returns the process exit status.
+static int golden_run_views(const GoldenOptions* options, const char* program, const GoldenView* views,
+                            int view_count, GoldenSampleFunc sample, GoldenFrameFunc frame) {
+    char golden_path[512], timing_path[512];
+    snprintf(golden_path, sizeof(golden_path), "%s/%s.golden", options->directory, program);
+    snprintf(timing_path, sizeof(timing_path), "%s/%s.timing", options->directory, program);
+
+    GoldenRecord expected[GOLDEN_MAX_RECORDS], baseline[GOLDEN_MAX_RECORDS], results[GOLDEN_MAX_RECORDS];
+    int expected_count = golden_load(golden_path, expected, 0);
+    int baseline_count = golden_load(timing_path, baseline, 1);
+    if (view_count > GOLDEN_MAX_RECORDS) view_count = GOLDEN_MAX_RECORDS;
+
+    int* buffer = (int*)malloc(sizeof(int) * GOLDEN_WIDTH * GOLDEN_HEIGHT);
+    if (buffer == NULL) {
+        fprintf(stderr, "Failed to allocate golden buffer.\n");
+        return 1;
+    }
+
+    int failures = 0;
+    for (int v = 0; v < view_count; ++v) {
+        GoldenRecord* result = &results[v];
+        snprintf(result->name, sizeof(result->name), "%s", views[v].name);
+        result->ms = 0.0;
+        for (int run = 0; run < GOLDEN_TIMING_RUNS; ++run) {
+            Uint64 start = SDL_GetPerformanceCounter();
+            if (frame != NULL) {
+                int pixel_count = 0;
+                const uint32_t* pixels = frame(&views[v], &pixel_count);
+                if (pixels == NULL) {
+                    fprintf(stderr, "Failed to render golden view %s/%s.\n", program, views[v].name);
+                    free(buffer);
+                    return 1;
+                }
+                result->checksum = golden_checksum(pixels, pixel_count, &result->sum);
+            } else {
+                result->checksum = golden_render(&views[v], sample, buffer, &result->sum);
+            }
+            double ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+            if (run == 0 || ms < result->ms) result->ms = ms;
+        }
+        printf("%s/%s: %016llx sum %lld, %.3f ms", program, result->name,
+               (unsigned long long)result->checksum, result->sum, result->ms);
+
+        if (options->mode != GOLDEN_CHECK) {
+            printf("\n");
+            continue;
+        }
+
+        const GoldenRecord* golden = golden_find(expected, expected_count, result->name);
+        if (golden == NULL) {
+            printf(" FAIL (no golden entry, run 'make golden-update')\n");
+            failures++;
+            continue;
+        }
+        if (golden->checksum != result->checksum) {
+            long long reference = golden->sum > 0 ? golden->sum : 1;
+            double drift = (double)llabs(result->sum - golden->sum) / (double)reference;
+            // Without a tolerance any changed pixel fails, even if the sum stayed the same
+            if (options->tolerance <= 0.0 || drift > options->tolerance) {
+                printf(" FAIL (expected %016llx sum %lld, drift %.3g)\n",
+                       (unsigned long long)golden->checksum, golden->sum, drift);
+                failures++;
+                continue;
+            }
+            printf(" [drift %.3g within tolerance]", drift);
+        }
+
+        const GoldenRecord* timing = golden_find(baseline, baseline_count, result->name);
+        if (timing != NULL && timing->ms > 0.0) {
+            double change = 100.0 * (result->ms - timing->ms) / timing->ms;
+            if (change > options->threshold_percent) {
+                printf(" FAIL (%+.1f%% vs %.3f ms baseline)\n", change, timing->ms);
+                failures++;
+                continue;
+            }
+            printf(" OK (%+.1f%% vs baseline)\n", change);
+        } else {
+            printf(" OK (no timing baseline)\n");
+        }
+    }
+    free(buffer);
+
+    if (options->mode == GOLDEN_UPDATE && golden_save(golden_path, results, view_count, 0, frame != NULL) != 0) return 1;
+    if (options->mode != GOLDEN_CHECK && golden_save(timing_path, results, view_count, 1, frame != NULL) != 0) return 1;
+
+    if (failures > 0) {
+        printf("%s: %d of %d golden views failed\n", program, failures, view_count);
+        return 1;
+    }
+    return 0;
+}
+
+// Golden run of a per-point kernel
+static inline int golden_run(const GoldenOptions* options, const char* program, const GoldenView* views,
+                             int view_count, GoldenSampleFunc sample) {
+    return golden_run_views(options, program, views, view_count, sample, NULL);
+}
+
+// Golden run of a program that renders whole frames
+static inline int golden_run_frames(const GoldenOptions* options, const char* program, const GoldenView* views,
+                                    int view_count, GoldenFrameFunc frame) {
+    return golden_run_views(options, program, views, view_count, NULL, frame);
+}
+
+#endif
@@ -3,18 +3,51 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <math.h>
+#include "perfhud.h"
+#include "linebatch.h"
+#include "lineraster.h"
+#include "vecmath.h"
+#include "framesched.h"
 
 // Initial Window dimensions
 #define INITIAL_WIDTH 800
 #define INITIAL_HEIGHT 800
 #define INITIAL_LENGTH 150.0 // Initial size of the H-curve
 
+// Depth the +/- keys can reach. Subtrees that project to less than HCURVE_LOD_PIXELS
+// are drawn as a filled rectangle (their lines are packed tighter than pixels by then)
+// and subtrees outside the view are skipped, so the frame time depends on the size on
+// screen rather than on the depth.
+#define HCURVE_DEPTH_LIMIT 10
+#define HCURVE_LOD_PIXELS 4.0
+
+// With SDL's lines, a vertex is drawn if it projects within one window size around the
+// window, i.e. within [-3, 3] in normalized device coordinates. The software rasterizer
+// clips lines itself, so subtrees are culled at the window edge instead.
+#define HCURVE_GUARD_BAND 3.0
+
+#define HCURVE_PROXY_BATCH 4096
+
+// Subtrees up to this size on screen are skipped if the proxies drawn so far already
+// cover their rectangle. The curve has a single colour, so they could not change a
+// pixel; without this, the proxies of a volume-filling curve pile up behind each other.
+#define HCURVE_COVERAGE_PIXELS 64.0
+
+#define HCURVE_NODE_VERTICES 14
+#define HCURVE_NODE_LINES 15
+#define HCURVE_LEVEL_OFFSETS (HCURVE_NODE_VERTICES + 8)  // Vertices and bound corners
+
 // Global SDL variables
 SDL_Window* g_window = NULL;
 SDL_Renderer* g_renderer = NULL;
 TTF_Font* g_font = NULL;
+LineBatch g_line_batch;
+LineRaster g_line_raster;
+bool g_software_lines = true;  // Draw with lineraster.h instead of SDL's lines
+bool g_antialias_lines = false;
 
 // --- 3D Camera Parameters ---
 double g_camera_x = 0.0;
@@ -31,97 +64,69 @@ int g_last_mouse_x, g_last_mouse_y;
 int g_max_depth = 4;
 
 typedef struct {
-    double x, y, z;
-} Vec3;
-
+    double x, y, z, w;
+} Vec4;
+
+// --- Octree Traversal ---
+// The curve's nodes form an octree: a node's eight children sit at its cube corners.
+// Each node has 8 cube corners followed by 6 face centres. Relative to the node's
+// centre these are the same 14 offsets at every node of a level, so they are
+// transformed to clip space once per level and frame. A node's vertices are then its
+// centre plus those offsets, and a child's centre is a corner, so the traversal only
+// adds vectors. The same holds for the corners of each level's subtree bounding box,
+// used for culling and level of detail.
 typedef struct {
-    double m[4][4];
-} Matrix4x4;
+    Vec4 vertices[HCURVE_DEPTH_LIMIT][HCURVE_NODE_VERTICES];
+    Vec4 bounds[HCURVE_DEPTH_LIMIT][8];
+    VecSoA offsets;           // Model-space vertex and bound offsets of all levels
+    VecSoA clip_offsets;      // The same transformed to clip space
+    int window_width, window_height;
+    LineRaster* raster;       // Draws lines and proxies when not NULL, otherwise SDL does
+    double guard_band;        // Culling planes at x, y = +-guard_band * w
+    int coverage_margin;      // Pixels a line can reach beyond its end points
+    SDL_Rect proxies[HCURVE_PROXY_BATCH];  // Pending proxy rectangles
+    int proxy_count;
+    Uint64* coverage;         // One bit per window pixel set by the proxies, NULL if unavailable
+    int coverage_words;       // Words per row
+    int coverage_width, coverage_height;
+    long long nodes;          // Nodes visited this frame
+    long long proxies_drawn;  // Subtrees drawn as a rectangle this frame
+} HCurveFrame;
+
+HCurveFrame g_frame;
+
+// Line end points of one node, in path order so the line batch can chain them: back
+// face loop, across to the front face, front face loop, remaining Z edges, then the
+// connecting lines through the centre
+const int HCURVE_NODE_INDICES[HCURVE_NODE_LINES][2] = {
+    {2, 0}, {0, 1}, {1, 3}, {3, 2}, {2, 6}, {6, 4}, {4, 5}, {5, 7}, {7, 6},
+    {0, 4}, {1, 5}, {3, 7},
+    {8, 9}, {10, 11}, {12, 13}
+};
 
 // --- Forward Declarations ---
 void renderText(SDL_Renderer* renderer, TTF_Font* font, const char* text, int x, int y, SDL_Color color);
 void saveScreenshot(SDL_Renderer* renderer, const char* filename, int window_width, int window_height);
 
 // --- Matrix Operations ---
-Matrix4x4 matrix_identity() {
-    Matrix4x4 m = {0};
-    m.m[0][0] = m.m[1][1] = m.m[2][2] = m.m[3][3] = 1.0;
-    return m;
-}
-
-Matrix4x4 matrix_multiply(Matrix4x4 m1, Matrix4x4 m2) {
-    Matrix4x4 result = {0};
-    for (int c = 0; c < 4; c++) {
-        for (int r = 0; r < 4; r++) {
-            result.m[r][c] = m1.m[r][0] * m2.m[0][c] +
-                             m1.m[r][1] * m2.m[1][c] +
-                             m1.m[r][2] * m2.m[2][c] +
-                             m1.m[r][3] * m2.m[3][c];
-        }
-    }
-    return result;
-}
-
-Vec3 matrix_multiply_vec3(Vec3 v, Matrix4x4 m) {
-    Vec3 result;
-    double w = v.x * m.m[3][0] + v.y * m.m[3][1] + v.z * m.m[3][2] + m.m[3][3];
-    if (w == 0.0) w = 1.0; // Avoid division by zero
-
-    result.x = (v.x * m.m[0][0] + v.y * m.m[0][1] + v.z * m.m[0][2] + m.m[0][3]) / w;
-    result.y = (v.x * m.m[1][0] + v.y * m.m[1][1] + v.z * m.m[1][2] + m.m[1][3]) / w;
-    result.z = (v.x * m.m[2][0] + v.y * m.m[2][1] + v.z * m.m[2][2] + m.m[2][3]) / w;
-    return result;
-}
-
-Matrix4x4 matrix_create_rotation_x(double angle_rad) {
-    Matrix4x4 m = matrix_identity();
-    m.m[1][1] = cos(angle_rad);
-    m.m[1][2] = sin(angle_rad);
-    m.m[2][1] = -sin(angle_rad);
-    m.m[2][2] = cos(angle_rad);
-    return m;
-}
-
-Matrix4x4 matrix_create_rotation_y(double angle_rad) {
-    Matrix4x4 m = matrix_identity();
-    m.m[0][0] = cos(angle_rad);
-    m.m[0][2] = -sin(angle_rad);
-    m.m[2][0] = sin(angle_rad);
-    m.m[2][2] = cos(angle_rad);
-    return m;
-}
-
-Matrix4x4 matrix_create_rotation_z(double angle_rad) {
-    Matrix4x4 m = matrix_identity();
-    m.m[0][0] = cos(angle_rad);
-    m.m[0][1] = sin(angle_rad);
-    m.m[1][0] = -sin(angle_rad);
-    m.m[1][1] = cos(angle_rad);
-    return m;
-}
-
-Matrix4x4 matrix_create_translation(double tx, double ty, double tz) {
-    Matrix4x4 m = matrix_identity();
-    m.m[0][3] = tx;
-    m.m[1][3] = ty;
-    m.m[2][3] = tz;
-    return m;
-}
-
-Matrix4x4 matrix_create_projection(int window_width, int window_height) {
-    Matrix4x4 m = {0};
+// The H-curve turns the view rather than the curve, so its rotations take the negated
+// angles
+void create_view_projection(Mat4* out, int window_width, int window_height) {
     double fov_degrees = 90.0;
     double aspect_ratio = (double)window_width / window_height;
-    double z_near = 0.1;
-    double z_far = 1000.0;
-
     double fov_rad = 1.0 / tan(fov_degrees * 0.5 / 180.0 * M_PI);
-    m.m[0][0] = aspect_ratio * fov_rad;
-    m.m[1][1] = fov_rad;
-    m.m[2][2] = z_far / (z_far - z_near);
-    m.m[3][2] = 1.0;
-    m.m[2][3] = (-z_far * z_near) / (z_far - z_near);
-    return m;
+
+    Mat4 projection, camera, rot_x, rot_y, rot_z;
+    mat4_perspective(&projection, (float)(aspect_ratio * fov_rad), (float)fov_rad, 0.1f, 1000.0f);
+    mat4_translation(&camera, (float)g_camera_x, (float)g_camera_y, (float)g_camera_z);
+    mat4_rotation_x(&rot_x, -g_rotation_x);
+    mat4_rotation_y(&rot_y, -g_rotation_y);
+    mat4_rotation_z(&rot_z, -g_rotation_z);
+
+    mat4_multiply(out, &projection, &camera);
+    mat4_multiply(out, out, &rot_x);
+    mat4_multiply(out, out, &rot_y);
+    mat4_multiply(out, out, &rot_z);
 }
 
 // --- Drawing Utilities ---
@@ -170,96 +175,279 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename, int window_wid
     SDL_FreeSurface(screenshot);
 }
 
-// --- Project and Draw 3D Line ---
-bool project_point(Vec3 world_pos, int* screen_x, int* screen_y, Matrix4x4 transform_matrix, int window_width, int window_height) {
-    Vec3 projected_pos = matrix_multiply_vec3(world_pos, transform_matrix);
+// --- H-Curve Generation ---
+Vec4 vec4_add(Vec4 a, Vec4 b) {
+    return (Vec4){a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
+}
 
-    if (projected_pos.z < 0.0 || projected_pos.z > 1.0) {
+// Fills the per-level offset tables for a curve of 'depth' levels. Returns false if
+// they could not be allocated.
+bool prepareHCurveFrame(HCurveFrame* frame, LineRaster* raster, const Mat4* transform_matrix, int depth,
+                        int window_width, int window_height) {
+    frame->window_width = window_width;
+    frame->window_height = window_height;
+    frame->raster = raster;
+    frame->guard_band = raster != NULL ? 1.0 : HCURVE_GUARD_BAND;
+    frame->coverage_margin = raster != NULL && raster->antialias ? 1 : 0;
+    frame->proxy_count = 0;
+    frame->nodes = 0;
+    frame->proxies_drawn = 0;
+
+    if (frame->coverage_width != window_width || frame->coverage_height != window_height) {
+        free(frame->coverage);
+        frame->coverage_words = (window_width + 63) / 64;
+        frame->coverage = malloc((size_t)frame->coverage_words * window_height * sizeof(Uint64));
+        if (frame->coverage == NULL) {
+            printf("Out of memory for the coverage mask; drawing every subtree.\n");
+        }
+        frame->coverage_width = window_width;
+        frame->coverage_height = window_height;
+    }
+    if (frame->coverage != NULL) {
+        memset(frame->coverage, 0, (size_t)frame->coverage_words * window_height * sizeof(Uint64));
+    }
+
+    // Offsets have w = 0, so only the linear part of the transform applies. All levels
+    // go through one batched transform.
+    VecSoA* offsets = &frame->offsets;
+    if (!vec_soa_reserve(offsets, depth * HCURVE_LEVEL_OFFSETS)) {
+        return false;
+    }
+    offsets->count = 0;
+    double half_length = INITIAL_LENGTH / 2.0;
+    for (int level = 0; level < depth; ++level, half_length /= 2.0) {
+        // Corners in the order back/front, bottom/top, left/right, then face centres
+        float h = (float)half_length;
+        float vertices[HCURVE_NODE_VERTICES][3] = {
+            {-h, -h, -h}, {h, -h, -h}, {-h, h, -h}, {h, h, -h},
+            {-h, -h, h}, {h, -h, h}, {-h, h, h}, {h, h, h},
+            {-h, 0.0f, 0.0f}, {h, 0.0f, 0.0f}, {0.0f, -h, 0.0f}, {0.0f, h, 0.0f}, {0.0f, 0.0f, -h}, {0.0f, 0.0f, h}
+        };
+        // A subtree reaches h + h / 2 + ... down to the last level
+        float extent = (float)(half_length * (2.0 - ldexp(1.0, level - depth + 1)));
+        for (int i = 0; i < HCURVE_LEVEL_OFFSETS; ++i) {
+            int n = offsets->count++;
+            if (i < HCURVE_NODE_VERTICES) {
+                offsets->x[n] = vertices[i][0];
+                offsets->y[n] = vertices[i][1];
+                offsets->z[n] = vertices[i][2];
+            } else {
+                int corner = i - HCURVE_NODE_VERTICES;
+                offsets->x[n] = (corner & 1) ? extent : -extent;
+                offsets->y[n] = (corner & 2) ? extent : -extent;
+                offsets->z[n] = (corner & 4) ? extent : -extent;
+            }
+            offsets->w[n] = 0.0f;
+        }
+    }
+    if (!mat4_transform_points(transform_matrix, offsets, &frame->clip_offsets)) {
         return false;
     }
 
-    *screen_x = (int)(projected_pos.x * (window_width / 2.0) + (window_width / 2.0));
-    *screen_y = (int)(-projected_pos.y * (window_height / 2.0) + (window_height / 2.0));
+    const VecSoA* clip = &frame->clip_offsets;
+    for (int n = 0; n < clip->count; ++n) {
+        int level = n / HCURVE_LEVEL_OFFSETS, i = n % HCURVE_LEVEL_OFFSETS;
+        Vec4 offset = {clip->x[n], clip->y[n], clip->z[n], clip->w[n]};
+        if (i < HCURVE_NODE_VERTICES) {
+            frame->vertices[level][i] = offset;
+        } else {
+            frame->bounds[level][i - HCURVE_NODE_VERTICES] = offset;
+        }
+    }
+    return true;
+}
+
+// Same visibility rule as a single projected point: between the near and far planes and
+// inside the guard band
+bool project_point(Vec4 clip, int* screen_x, int* screen_y, const HCurveFrame* frame) {
+    double w = clip.w == 0.0 ? 1.0 : clip.w;  // Avoid division by zero
+    double z = clip.z / w;
+    if (z < 0.0 || z > 1.0) {
+        return false;
+    }
+
+    double half_width = frame->window_width / 2.0, half_height = frame->window_height / 2.0;
+    double x = clip.x / w * half_width + half_width;
+    double y = -clip.y / w * half_height + half_height;
+    if (x < -frame->window_width - 1.0 || x > 2.0 * frame->window_width + 1.0 ||
+        y < -frame->window_height - 1.0 || y > 2.0 * frame->window_height + 1.0) {
+        return false;
+    }
+
+    *screen_x = (int)x;
+    *screen_y = (int)y;
+    return *screen_x >= -frame->window_width && *screen_x <= 2 * frame->window_width &&
+           *screen_y >= -frame->window_height && *screen_y <= 2 * frame->window_height;
+}
+
+// True if all corners are beyond the same clip plane. Every point of the box is then
+// beyond it too and fails project_point() (or is clipped away by the rasterizer).
+bool hcurve_box_outside(Vec4 center, const Vec4* corners, double guard_band) {
+    int outside[6] = {0};
+    for (int i = 0; i < 8; ++i) {
+        Vec4 p = vec4_add(center, corners[i]);
+        outside[0] += p.x < -guard_band * p.w;
+        outside[1] += p.x > guard_band * p.w;
+        outside[2] += p.y < -guard_band * p.w;
+        outside[3] += p.y > guard_band * p.w;
+        outside[4] += p.z < 0.0;
+        outside[5] += p.z > p.w;
+    }
+    for (int plane = 0; plane < 6; ++plane) {
+        if (outside[plane] == 8) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    if (*screen_x < -window_width || *screen_x > 2 * window_width ||
-        *screen_y < -window_height || *screen_y > 2 * window_height) {
+// Screen position of one box corner. Returns false if it is not in front of the camera.
+bool hcurve_box_corner(Vec4 center, Vec4 corner, const HCurveFrame* frame, double* x, double* y) {
+    Vec4 p = vec4_add(center, corner);
+    if (p.w <= 0.0) {
         return false;
     }
+    double half_width = frame->window_width / 2.0, half_height = frame->window_height / 2.0;
+    *x = p.x / p.w * half_width + half_width;
+    *y = -p.y / p.w * half_height + half_height;
+    return true;
+}
 
+// Screen rectangle of a box in front of the camera. Returns false if part of it is not.
+bool hcurve_box_rect(Vec4 center, const Vec4* corners, const HCurveFrame* frame,
+                     double* min_x, double* max_x, double* min_y, double* max_y) {
+    if (!hcurve_box_corner(center, corners[0], frame, min_x, min_y)) {
+        return false;
+    }
+    *max_x = *min_x;
+    *max_y = *min_y;
+    for (int i = 1; i < 8; ++i) {
+        double x, y;
+        if (!hcurve_box_corner(center, corners[i], frame, &x, &y)) {
+            return false;
+        }
+        if (x < *min_x) *min_x = x;
+        if (x > *max_x) *max_x = x;
+        if (y < *min_y) *min_y = y;
+        if (y > *max_y) *max_y = y;
+    }
     return true;
 }
 
-// Draws a line between two 3D points on the screen
-void draw_3d_line(Vec3 p1, Vec3 p2, Matrix4x4 total_transform, int window_width, int window_height) {
-    int sx1, sy1, sx2, sy2;
-    bool p1_visible = project_point(p1, &sx1, &sy1, total_transform, window_width, window_height);
-    bool p2_visible = project_point(p2, &sx2, &sy2, total_transform, window_width, window_height);
+// Applies 'cover' (set) or tests (all set) the inclusive pixel rectangle. Pixels outside
+// the window count as covered.
+bool hcurve_coverage_rect(HCurveFrame* frame, int x0, int y0, int x1, int y1, bool cover) {
+    if (frame->coverage == NULL) {
+        return false;
+    }
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= frame->window_width) x1 = frame->window_width - 1;
+    if (y1 >= frame->window_height) y1 = frame->window_height - 1;
+    if (x0 > x1 || y0 > y1) {
+        return true;
+    }
+    for (int y = y0; y <= y1; ++y) {
+        Uint64* row = frame->coverage + (size_t)y * frame->coverage_words;
+        for (int word = x0 / 64; word <= x1 / 64; ++word) {
+            int first = word == x0 / 64 ? x0 % 64 : 0;
+            int last = word == x1 / 64 ? x1 % 64 : 63;
+            Uint64 mask = (~0ULL >> (63 - last)) & (~0ULL << first);
+            if (cover) {
+                row[word] |= mask;
+            } else if ((row[word] & mask) != mask) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
 
-    if (p1_visible && p2_visible) {
-        // printf("Drawing line from (%d, %d) to (%d, %d)\n", sx1, sy1, sx2, sy2);
-        SDL_RenderDrawLine(g_renderer, sx1, sy1, sx2, sy2);
-    } else {
-        // printf("Line culled. P1 visible: %d, P2 visible: %d\n", p1_visible, p2_visible);
+void flush_proxies(HCurveFrame* frame) {
+    if (frame->proxy_count > 0) {
+        SDL_RenderFillRects(g_renderer, frame->proxies, frame->proxy_count);
+        frame->proxy_count = 0;
     }
 }
 
-// --- H-Curve Generation ---
-void h_curve_3d(Vec3 center, double length, int depth, Matrix4x4 total_transform, int window_width, int window_height) {
-    if (depth <= 0) {
+// Draws the node whose centre is 'center' (clip space) at 'level' and its subtree, in
+// path order so the line batch can chain the lines
+void h_curve_3d(HCurveFrame* frame, LineBatch* batch, Vec4 center, int level, int depth) {
+    if (level >= depth) {
+        return;
+    }
+    frame->nodes++;
+
+    if (hcurve_box_outside(center, frame->bounds[level], frame->guard_band)) {
+        return;
+    }
+    double min_x, max_x, min_y, max_y;
+    if (hcurve_box_rect(center, frame->bounds[level], frame, &min_x, &max_x, &min_y, &max_y) &&
+        max_x - min_x < HCURVE_COVERAGE_PIXELS && max_y - min_y < HCURVE_COVERAGE_PIXELS) {
+        // Every pixel the subtree can reach lies in this rectangle (vertices are
+        // truncated like in project_point())
+        int margin = frame->coverage_margin;
+        int x0 = (int)min_x - margin, y0 = (int)min_y - margin;
+        int x1 = (int)max_x + margin, y1 = (int)max_y + margin;
+        if (hcurve_coverage_rect(frame, x0, y0, x1, y1, false)) {
+            return;
+        }
+
+        if (max_x - min_x < HCURVE_LOD_PIXELS && max_y - min_y < HCURVE_LOD_PIXELS) {
+            // Small enough to draw the whole subtree as its screen rectangle
+            int sx, sy;
+            if (project_point(center, &sx, &sy, frame)) {
+                int x = (int)floor(min_x), y = (int)floor(min_y);
+                int w = (int)ceil(max_x) - x, h = (int)ceil(max_y) - y;
+                if (frame->raster != NULL) {
+                    line_raster_fill_rect(frame->raster, x, y, w, h, center.z / center.w);
+                } else {
+                    if (frame->proxy_count == HCURVE_PROXY_BATCH) {
+                        flush_proxies(frame);
+                    }
+                    frame->proxies[frame->proxy_count++] = (SDL_Rect){x, y, w, h};
+                }
+                frame->proxies_drawn++;
+                hcurve_coverage_rect(frame, x, y, x + w - 1, y + h - 1, true);
+            }
+            return;
+        }
+    }
+
+    if (frame->raster != NULL) {
+        // The rasterizer clips each line, so lines that leave the view keep their visible part
+        for (int line = 0; line < HCURVE_NODE_LINES; ++line) {
+            Vec4 a = vec4_add(center, frame->vertices[level][HCURVE_NODE_INDICES[line][0]]);
+            Vec4 b = vec4_add(center, frame->vertices[level][HCURVE_NODE_INDICES[line][1]]);
+            line_raster_add_clip(frame->raster, a.x, a.y, a.z, a.w, b.x, b.y, b.z, b.w);
+        }
+        for (int i = 0; i < 8; ++i) {
+            h_curve_3d(frame, batch, vec4_add(center, frame->vertices[level][i]), level + 1, depth);
+        }
         return;
     }
 
-    double half_length = length / 2.0;
-
-    Vec3 corners[8];
-    corners[0] = (Vec3){center.x - half_length, center.y - half_length, center.z - half_length}; // Back-bottom-left
-    corners[1] = (Vec3){center.x + half_length, center.y - half_length, center.z - half_length}; // Back-bottom-right
-    corners[2] = (Vec3){center.x - half_length, center.y + half_length, center.z - half_length}; // Back-top-left
-    corners[3] = (Vec3){center.x + half_length, center.y + half_length, center.z - half_length}; // Back-top-right
-    corners[4] = (Vec3){center.x - half_length, center.y - half_length, center.z + half_length}; // Front-bottom-left
-    corners[5] = (Vec3){center.x + half_length, center.y - half_length, center.z + half_length}; // Front-bottom-right
-    corners[6] = (Vec3){center.x - half_length, center.y + half_length, center.z + half_length}; // Front-top-left
-    corners[7] = (Vec3){center.x + half_length, center.y + half_length, center.z + half_length}; // Front-top-right
-
-    // Center points of each face
-    Vec3 center_x_neg = {center.x - half_length, center.y, center.z};
-    Vec3 center_x_pos = {center.x + half_length, center.y, center.z};
-    Vec3 center_y_neg = {center.x, center.y - half_length, center.z};
-    Vec3 center_y_pos = {center.x, center.y + half_length, center.z};
-    Vec3 center_z_neg = {center.x, center.y, center.z - half_length};
-    Vec3 center_z_pos = {center.x, center.y, center.z + half_length};
-
-    // Connecting lines in the center
-    draw_3d_line(center_x_neg, center_x_pos, total_transform, window_width, window_height);
-    draw_3d_line(center_y_neg, center_y_pos, total_transform, window_width, window_height);
-    draw_3d_line(center_z_neg, center_z_pos, total_transform, window_width, window_height);
-
-    // H on XY planes (front/back)
-    draw_3d_line(corners[0], corners[2], total_transform, window_width, window_height); // Back-left vertical
-    draw_3d_line(corners[1], corners[3], total_transform, window_width, window_height); // Back-right vertical
-    draw_3d_line(corners[0], corners[1], total_transform, window_width, window_height); // Back-bottom horizontal
-    draw_3d_line(corners[2], corners[3], total_transform, window_width, window_height); // Back-top horizontal
-
-    draw_3d_line(corners[4], corners[6], total_transform, window_width, window_height); // Front-left vertical
-    draw_3d_line(corners[5], corners[7], total_transform, window_width, window_height); // Front-right vertical
-    draw_3d_line(corners[4], corners[5], total_transform, window_width, window_height); // Front-bottom horizontal
-    draw_3d_line(corners[6], corners[7], total_transform, window_width, window_height); // Front-top horizontal
-
-    // H on XZ planes (top/bottom)
-    draw_3d_line(corners[0], corners[4], total_transform, window_width, window_height); // Bottom-left Z
-    draw_3d_line(corners[1], corners[5], total_transform, window_width, window_height); // Bottom-right Z
-    draw_3d_line(corners[2], corners[6], total_transform, window_width, window_height); // Top-left Z
-    draw_3d_line(corners[3], corners[7], total_transform, window_width, window_height); // Top-right Z
-
-    double new_length = length / 2.0;
-    
+    int screen_x[HCURVE_NODE_VERTICES], screen_y[HCURVE_NODE_VERTICES];
+    bool visible[HCURVE_NODE_VERTICES];
+    for (int i = 0; i < HCURVE_NODE_VERTICES; ++i) {
+        visible[i] = project_point(vec4_add(center, frame->vertices[level][i]), &screen_x[i], &screen_y[i], frame);
+    }
+    for (int line = 0; line < HCURVE_NODE_LINES; ++line) {
+        int a = HCURVE_NODE_INDICES[line][0], b = HCURVE_NODE_INDICES[line][1];
+        if (visible[a] && visible[b]) {
+            line_batch_add(batch, screen_x[a], screen_y[a], screen_x[b], screen_y[b]);
+        }
+    }
+
     for (int i = 0; i < 8; ++i) {
-        h_curve_3d(corners[i], new_length, depth - 1, total_transform, window_width, window_height);
+        h_curve_3d(frame, batch, vec4_add(center, frame->vertices[level][i]), level + 1, depth);
     }
 }
 
 // --- Main Program ---
 int main(int argc, char* argv[]) {
+    perf_init(argc, argv);
+
     srand((unsigned int)time(NULL));
 
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -297,6 +485,7 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     SDL_SetRenderDrawBlendMode(g_renderer, SDL_BLENDMODE_BLEND);
+    line_raster_init(&g_line_raster, g_renderer);
 
     // Load font for UI text
     g_font = TTF_OpenFont("/usr/share/fonts/truetype/dejavu/DejaVuSans-Bold.ttf", 16);
@@ -307,6 +496,8 @@ int main(int argc, char* argv[]) {
     // --- Main Application Loop ---
     bool application_running = true;
     SDL_Event event;
+    FrameScheduler frame_sched;
+    frame_sched_init(&frame_sched, FRAME_SCHED_MAX_FPS);
 
     SDL_Rect screenshot_button_rect;
 
@@ -317,7 +508,12 @@ int main(int argc, char* argv[]) {
         screenshot_button_rect = (SDL_Rect){current_window_width - 120, 10, 110, 30};
 
         // --- Event Handling ---
-        while (SDL_PollEvent(&event)) {
+        while (application_running && frame_sched_next_event(&frame_sched, &event)) {
+            if (perf_handle_event(&event)) {
+                frame_sched_damage(&frame_sched, FRAME_DAMAGE_OVERLAY);
+                continue;
+            }
+            if (frame_sched_window_event(&frame_sched, &event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
@@ -330,7 +526,9 @@ int main(int argc, char* argv[]) {
                     if (event.button.button == SDL_BUTTON_LEFT &&
                         mouse_x >= screenshot_button_rect.x && mouse_x <= screenshot_button_rect.x + screenshot_button_rect.w &&
                         mouse_y >= screenshot_button_rect.y && mouse_y <= screenshot_button_rect.y + screenshot_button_rect.h) {
+                        Uint64 trace_start = trace_begin();
                         saveScreenshot(g_renderer, "h_curve_3d_screenshot.bmp", current_window_width, current_window_height);
+                        trace_end("screenshot", trace_start);
                     }
                     else if (event.button.button == SDL_BUTTON_LEFT) {
                         g_is_rotating = true;
@@ -359,6 +557,7 @@ int main(int argc, char* argv[]) {
 
                         g_last_mouse_x = mouse_x;
                         g_last_mouse_y = mouse_y;
+                        frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE);
                     }
                     break;
                 case SDL_MOUSEWHEEL:
@@ -368,9 +567,11 @@ int main(int argc, char* argv[]) {
                     } else if (event.wheel.y < 0) { // Scroll down (zoom out)
                         g_camera_z += 10.0;
                     }
+                    frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE);
                     break;
                 }
                 case SDL_KEYDOWN:
+                    frame_sched_damage(&frame_sched, FRAME_DAMAGE_SCENE);
                     switch (event.key.keysym.sym) {
                         case SDLK_ESCAPE: // Quit on ESC
                             application_running = false;
@@ -404,7 +605,7 @@ int main(int argc, char* argv[]) {
                             break;
                         case SDLK_PLUS: // Increase depth
                         case SDLK_KP_PLUS:
-                            if (g_max_depth < 10) g_max_depth++;
+                            if (g_max_depth < HCURVE_DEPTH_LIMIT) g_max_depth++;
                             printf("Current Depth: %d\n", g_max_depth);
                             break;
                         case SDLK_MINUS: // Decrease depth
@@ -412,6 +613,12 @@ int main(int argc, char* argv[]) {
                             if (g_max_depth > 0) g_max_depth--;
                             printf("Current Depth: %d\n", g_max_depth);
                             break;
+                        case SDLK_b: // Toggle software / SDL lines
+                            g_software_lines = !g_software_lines;
+                            break;
+                        case SDLK_l: // Toggle anti-aliased software lines
+                            g_antialias_lines = !g_antialias_lines;
+                            break;
                     }
                     break;
             }
@@ -422,20 +629,57 @@ int main(int argc, char* argv[]) {
         SDL_RenderClear(g_renderer);
         SDL_SetRenderDrawColor(g_renderer, 0, 255, 0, 255);
 
-        // Build the total transformation matrix for the fractal
-        Matrix4x4 proj_matrix = matrix_create_projection(current_window_width, current_window_height);
-        Matrix4x4 mat_rot_x = matrix_create_rotation_x(g_rotation_x);
-        Matrix4x4 mat_rot_y = matrix_create_rotation_y(g_rotation_y);
-        Matrix4x4 mat_rot_z = matrix_create_rotation_z(g_rotation_z);
-        Matrix4x4 mat_trans_camera = matrix_create_translation(g_camera_x, g_camera_y, g_camera_z);
-
-        Matrix4x4 model_rot_matrix = matrix_multiply(mat_rot_x, matrix_multiply(mat_rot_y, mat_rot_z));
-        Matrix4x4 view_projection_matrix = matrix_multiply(proj_matrix, mat_trans_camera);
-        Matrix4x4 total_transform = matrix_multiply(view_projection_matrix, model_rot_matrix);
+        // The software rasterizer keeps its last picture in a texture, so a frame that
+        // only repaints the overlay copies it instead of drawing the curve again
+        bool reuse_lines = g_software_lines && !frame_sched_scene_damaged(&frame_sched) &&
+                           g_line_raster.texture != NULL && g_line_raster.width == current_window_width &&
+                           g_line_raster.height == current_window_height;
+        if (reuse_lines) {
+            perf_begin(PERF_DRAW);
+            SDL_RenderCopy(g_renderer, g_line_raster.texture, NULL, NULL);
+            perf_end(PERF_DRAW);
+        } else {
+            // Build the total transformation matrix for the fractal
+            Mat4 total_transform;
+            create_view_projection(&total_transform, current_window_width, current_window_height);
+
+            perf_begin(PERF_COMPUTE);
+            if (g_software_lines && !line_raster_begin(&g_line_raster, current_window_width, current_window_height, 0xFF000000u)) {
+                g_software_lines = false;  // Out of memory; fall back to SDL's lines
+            }
+            LineRaster* raster = g_software_lines ? &g_line_raster : NULL;
+            g_line_raster.antialias = g_antialias_lines;
+            line_raster_set_color(&g_line_raster, 0, 255, 0, 255);
+            line_batch_begin(&g_line_batch, g_renderer);
+            if (prepareHCurveFrame(&g_frame, raster, &total_transform, g_max_depth, current_window_width, current_window_height)) {
+                float origin[4];
+                mat4_transform(&total_transform, 0.0f, 0.0f, 0.0f, 1.0f, origin);
+                h_curve_3d(&g_frame, &g_line_batch, (Vec4){origin[0], origin[1], origin[2], origin[3]}, 0, g_max_depth);
+            }
+            line_batch_end(&g_line_batch);
+            flush_proxies(&g_frame);
+            if (raster != NULL) {
+                line_raster_end(raster);
+            }
+            perf_end(PERF_COMPUTE);
+            perf_add_iterations(g_frame.nodes);
+            if (raster != NULL) {
+                perf_add_pixels(raster->segments_drawn);
+                perf_add_thread_time(raster->thread_count, raster->busy_ms);
+
+                perf_begin(PERF_UPLOAD);
+                line_raster_upload(raster);
+                perf_end(PERF_UPLOAD);
+                perf_begin(PERF_DRAW);
+                SDL_RenderCopy(g_renderer, raster->texture, NULL, NULL);
+                perf_end(PERF_DRAW);
+            } else {
+                perf_add_pixels(g_line_batch.segments + g_frame.proxies_drawn);
+            }
+        }
 
-        h_curve_3d((Vec3){0.0, 0.0, 0.0}, INITIAL_LENGTH, g_max_depth, total_transform, current_window_width, current_window_height);
-        
         // Render UI elements on top
+        perf_begin(PERF_TEXT);
         if (g_font != NULL) {
             char text_buffer[200];
             SDL_Color textColor = {255, 255, 255, 255};
@@ -449,9 +693,14 @@ int main(int argc, char* argv[]) {
             snprintf(text_buffer, sizeof(text_buffer), "Cam Rot: (X:%.1f, Y:%.1f)", g_rotation_x, g_rotation_y);
             renderText(g_renderer, g_font, text_buffer, 10, 50, textColor);
 
+            snprintf(text_buffer, sizeof(text_buffer), "Lines: %s%s", g_software_lines ? "software" : "SDL",
+                     g_software_lines && g_antialias_lines ? ", anti-aliased" : "");
+            renderText(g_renderer, g_font, text_buffer, 10, 70, textColor);
+
+            renderText(g_renderer, g_font, "B: Software/SDL Lines, L: Anti-Aliasing", 10, current_window_height - 90, textColor);
             renderText(g_renderer, g_font, "Left Drag: Rotate, Wheel: Zoom Z", 10, current_window_height - 70, textColor);
             renderText(g_renderer, g_font, "WASDQE: Move Cam, R: Reset View", 10, current_window_height - 50, textColor);
-            renderText(g_renderer, g_font, "+/-: Change Depth", 10, current_window_height - 30, textColor);
+            renderText(g_renderer, g_font, "+/-: Change Depth, F1: Perf HUD", 10, current_window_height - 30, textColor);
 
 
             SDL_SetRenderDrawColor(g_renderer, 50, 50, 50, 255);
@@ -462,12 +711,22 @@ int main(int argc, char* argv[]) {
             SDL_Color buttonTextColor = {255, 255, 255, 255};
             renderText(g_renderer, g_font, "Save", screenshot_button_rect.x + 8, screenshot_button_rect.y + 5, buttonTextColor);
         }
+        perf_end(PERF_TEXT);
+        perf_draw_hud(g_renderer, g_font);
 
+        perf_begin(PERF_PRESENT);
         SDL_RenderPresent(g_renderer);
-        SDL_Delay(1);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
+        frame_sched_presented(&frame_sched);
     }
 
     // --- Cleanup ---
+    perf_shutdown();
+    free(g_frame.coverage);
+    vec_soa_free(&g_frame.offsets);
+    vec_soa_free(&g_frame.clip_offsets);
+    line_raster_shutdown(&g_line_raster);
     if (g_font != NULL) {
         TTF_CloseFont(g_font);
     }
@@ -0,0 +1,505 @@
+#ifndef IFS_H
+#define IFS_H
+
+// Data-driven iterated function systems.
+//
+// A system is a list of maps x' = a*x + b*y + e, y' = c*x + d*y + f, each with a
+// selection weight and an optional nonlinear variation applied after the affine
+// part. Systems are read from text, one map per line:
+//
+//   # comment
+//   name Barnsley fern
+//   #  a      b      c      d      e     f     weight  [variation]
+//      0.00   0.00   0.00   0.16   0.00  0.00  1
+//
+// Weights are normalized, so "1 85 7 7" and "0.01 0.85 0.07 0.07" are the same.
+// Variations: linear (default), sinusoidal, spherical, swirl.
+//
+// Map selection uses Vose's alias table: one 64-bit random number picks a column
+// with its high half and decides between the column and its alias with the low
+// half, so the cost does not depend on the number of maps or their weights. The
+// chaos game advances IFS_LANES independent walkers side by side, stored as
+// arrays per coordinate. With SSE2 two walkers share a register: the xorshift64*
+// generators, the column of the alias table and the affine map run on both at
+// once, only the table lookups and the nonlinear variations are done per walker.
+// Without SSE2 the same step runs as a scalar loop with identical results.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IFS_SSE2 1
+#endif
+
+#define IFS_MAX_MAPS 32
+#define IFS_LANES 8  // Must be even, the SSE2 step handles two lanes per register
+#define IFS_BOUNDS_SAMPLES 200000  // Walk length used to estimate the bounds of nonlinear systems
+#define IFS_BOUNDS_PADDING 0.05    // Relative padding of estimated bounds
+#define IFS_BOUNDS_TOLERANCE 1e-4  // Exact bounds are at most this much (relative) too large
+#define IFS_BOUNDS_MAX_DEPTH 64
+
+typedef enum {
+    IFS_LINEAR,
+    IFS_SINUSOIDAL,
+    IFS_SPHERICAL,
+    IFS_SWIRL
+} IfsVariation;
+
+typedef struct {
+    double a, b, c, d, e, f;  // x' = a * x + b * y + e, y' = c * x + d * y + f
+} IfsAffine;
+
+typedef struct {
+    IfsAffine affine;
+    double weight;
+    IfsVariation variation;
+} IfsMap;
+
+typedef struct {
+    char name[64];
+    IfsMap maps[IFS_MAX_MAPS];
+    int map_count;
+    double probability[IFS_MAX_MAPS];        // Normalized weights
+    uint32_t alias_threshold[IFS_MAX_MAPS];  // Keep the column while the coin is below this
+    uint8_t alias[IFS_MAX_MAPS];
+    double x_min, x_max, y_min, y_max;       // Box around the attractor
+    int exact_bounds;  // Every map affine and contracting: the box provably contains the attractor
+} IfsSystem;
+
+// IFS_LANES walkers, one 16-byte aligned coordinate array each
+typedef struct {
+    _Alignas(16) double x[IFS_LANES];
+    _Alignas(16) double y[IFS_LANES];
+    _Alignas(16) uint64_t state[IFS_LANES];
+} IfsLanes;
+
+// xorshift64* generator
+static inline uint64_t ifs_random(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 2685821657736338717ull;
+}
+
+// out = outer(inner(p))
+static inline void ifs_compose(const IfsAffine* outer, const IfsAffine* inner, IfsAffine* out) {
+    IfsAffine result;
+    result.a = outer->a * inner->a + outer->b * inner->c;
+    result.b = outer->a * inner->b + outer->b * inner->d;
+    result.c = outer->c * inner->a + outer->d * inner->c;
+    result.d = outer->c * inner->b + outer->d * inner->d;
+    result.e = outer->a * inner->e + outer->b * inner->f + outer->e;
+    result.f = outer->c * inner->e + outer->d * inner->f + outer->f;
+    *out = result;
+}
+
+// Box (centre cx, cy and half extents hx, hy) around the image of a box
+static inline void ifs_transform_box(const IfsAffine* m, double cx, double cy, double hx, double hy,
+                                     double* out_cx, double* out_cy, double* out_hx, double* out_hy) {
+    *out_cx = m->a * cx + m->b * cy + m->e;
+    *out_cy = m->c * cx + m->d * cy + m->f;
+    *out_hx = fabs(m->a) * hx + fabs(m->b) * hy;
+    *out_hy = fabs(m->c) * hx + fabs(m->d) * hy;
+}
+
+// Branch-free, since the coin toss is as unpredictable as the random number
+static inline int ifs_alias_select(const IfsSystem* system, uint32_t column, uint32_t coin) {
+    uint32_t keep = 0u - (uint32_t)(coin < system->alias_threshold[column]);
+    return (int)((column & keep) | (system->alias[column] & ~keep));
+}
+
+static inline int ifs_pick(const IfsSystem* system, uint64_t r) {
+    uint32_t column = (uint32_t)(((r >> 32) * (uint64_t)system->map_count) >> 32);
+    return ifs_alias_select(system, column, (uint32_t)r);
+}
+
+// Nonlinear part of a map, applied in place to the result of the affine part
+static inline void ifs_vary(IfsVariation variation, double* x, double* y) {
+    double nx = *x;
+    double ny = *y;
+    switch (variation) {
+        case IFS_SINUSOIDAL:
+            nx = sin(nx);
+            ny = sin(ny);
+            break;
+        case IFS_SPHERICAL: {
+            double r2 = nx * nx + ny * ny + 1e-12;
+            nx /= r2;
+            ny /= r2;
+            break;
+        }
+        case IFS_SWIRL: {
+            double r2 = nx * nx + ny * ny;
+            double s = sin(r2);
+            double c = cos(r2);
+            double swirled_x = nx * s - ny * c;
+            ny = nx * c + ny * s;
+            nx = swirled_x;
+            break;
+        }
+        default:
+            break;
+    }
+    *x = nx;
+    *y = ny;
+}
+
+static inline void ifs_apply(const IfsMap* map, double x, double y, double* out_x, double* out_y) {
+    const IfsAffine* m = &map->affine;
+    double nx = m->a * x + m->b * y + m->e;
+    double ny = m->c * x + m->d * y + m->f;
+    ifs_vary(map->variation, &nx, &ny);
+    *out_x = nx;
+    *out_y = ny;
+}
+
+#ifdef IFS_SSE2
+// Low 64 bits of a * b in both lanes, from 32 x 32 -> 64 bit products
+static inline __m128i ifs_mul64_sse2(__m128i a, __m128i b) {
+    __m128i low = _mm_mul_epu32(a, b);
+    __m128i cross = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(a, 32), b), _mm_mul_epu32(a, _mm_srli_epi64(b, 32)));
+    return _mm_add_epi64(low, _mm_slli_epi64(cross, 32));
+}
+#endif
+
+// Starts every lane at the origin with its own generator state derived from 'seed'
+static void ifs_lanes_init(IfsLanes* lanes, uint64_t seed) {
+    for (int lane = 0; lane < IFS_LANES; ++lane) {
+        uint64_t z = seed + (uint64_t)(lane + 1) * 0x9E3779B97F4A7C15ull;  // splitmix64
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        lanes->state[lane] = (z ^ (z >> 31)) | 1;  // xorshift state must be non-zero
+        lanes->x[lane] = 0.0;
+        lanes->y[lane] = 0.0;
+    }
+}
+
+// Advances every lane by one randomly chosen map
+static inline void ifs_lanes_step(const IfsSystem* system, IfsLanes* lanes) {
+#ifdef IFS_SSE2
+    const __m128i multiplier = _mm_set1_epi64x((long long)2685821657736338717ull);
+    const __m128i map_count = _mm_set1_epi64x(system->map_count);
+    for (int lane = 0; lane < IFS_LANES; lane += 2) {
+        // ifs_random() on both lanes
+        __m128i state = _mm_load_si128((const __m128i*)(lanes->state + lane));
+        state = _mm_xor_si128(state, _mm_srli_epi64(state, 12));
+        state = _mm_xor_si128(state, _mm_slli_epi64(state, 25));
+        state = _mm_xor_si128(state, _mm_srli_epi64(state, 27));
+        _mm_store_si128((__m128i*)(lanes->state + lane), state);
+        __m128i r = ifs_mul64_sse2(state, multiplier);
+
+        // ifs_pick(): the column from the high half, the coin is the low half
+        __m128i column = _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(r, 32), map_count), 32);
+        const IfsMap* map0 = &system->maps[ifs_alias_select(system, (uint32_t)_mm_cvtsi128_si32(column),
+                                                            (uint32_t)_mm_cvtsi128_si32(r))];
+        const IfsMap* map1 = &system->maps[ifs_alias_select(system, (uint32_t)_mm_cvtsi128_si32(_mm_unpackhi_epi64(column, column)),
+                                                            (uint32_t)_mm_cvtsi128_si32(_mm_unpackhi_epi64(r, r)))];
+
+        // Affine part with the coefficients of each lane's map side by side
+        const IfsAffine* m0 = &map0->affine;
+        const IfsAffine* m1 = &map1->affine;
+        __m128d x = _mm_load_pd(lanes->x + lane);
+        __m128d y = _mm_load_pd(lanes->y + lane);
+        __m128d nx = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_set_pd(m1->a, m0->a), x), _mm_mul_pd(_mm_set_pd(m1->b, m0->b), y)),
+                                _mm_set_pd(m1->e, m0->e));
+        __m128d ny = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_set_pd(m1->c, m0->c), x), _mm_mul_pd(_mm_set_pd(m1->d, m0->d), y)),
+                                _mm_set_pd(m1->f, m0->f));
+        _mm_store_pd(lanes->x + lane, nx);
+        _mm_store_pd(lanes->y + lane, ny);
+
+        if (map0->variation != IFS_LINEAR) {
+            ifs_vary(map0->variation, &lanes->x[lane], &lanes->y[lane]);
+        }
+        if (map1->variation != IFS_LINEAR) {
+            ifs_vary(map1->variation, &lanes->x[lane + 1], &lanes->y[lane + 1]);
+        }
+    }
+#else
+    for (int lane = 0; lane < IFS_LANES; ++lane) {
+        const IfsMap* map = &system->maps[ifs_pick(system, ifs_random(&lanes->state[lane]))];
+        ifs_apply(map, lanes->x[lane], lanes->y[lane], &lanes->x[lane], &lanes->y[lane]);
+    }
+#endif
+}
+
+// Vose's alias method over the normalized weights
+static void ifs_build_alias(IfsSystem* system) {
+    int n = system->map_count;
+    double total = 0.0;
+    for (int i = 0; i < n; ++i) {
+        total += system->maps[i].weight;
+    }
+
+    double scaled[IFS_MAX_MAPS];
+    int small[IFS_MAX_MAPS], large[IFS_MAX_MAPS];
+    int small_count = 0, large_count = 0;
+    for (int i = 0; i < n; ++i) {
+        system->probability[i] = system->maps[i].weight / total;
+        scaled[i] = system->probability[i] * n;
+        if (scaled[i] < 1.0) {
+            small[small_count++] = i;
+        } else {
+            large[large_count++] = i;
+        }
+    }
+
+    while (small_count > 0 && large_count > 0) {
+        int lo = small[--small_count];
+        int hi = large[--large_count];
+        system->alias_threshold[lo] = (uint32_t)(scaled[lo] * 4294967296.0);
+        system->alias[lo] = (uint8_t)hi;
+        scaled[hi] += scaled[lo] - 1.0;
+        if (scaled[hi] < 1.0) {
+            small[small_count++] = hi;
+        } else {
+            large[large_count++] = hi;
+        }
+    }
+    // Whatever is left is full up to rounding
+    while (large_count > 0) {
+        int i = large[--large_count];
+        system->alias_threshold[i] = UINT32_MAX;
+        system->alias[i] = (uint8_t)i;
+    }
+    while (small_count > 0) {
+        int i = small[--small_count];
+        system->alias_threshold[i] = UINT32_MAX;
+        system->alias[i] = (uint8_t)i;
+    }
+}
+
+// Largest singular value of the linear part
+static double ifs_norm(const IfsAffine* m) {
+    double sum = m->a * m->a + m->b * m->b + m->c * m->c + m->d * m->d;
+    double det = m->a * m->d - m->b * m->c;
+    double disc = sum * sum - 4.0 * det * det;
+    return sqrt((sum + sqrt(disc > 0.0 ? disc : 0.0)) / 2.0);
+}
+
+// Branch and bound for the largest value of dx * x + dy * y over the attractor, where
+// (dx, dy) is an axis direction. 'piece' maps the start box onto a sub-copy; the copy of
+// the point (px, py) of the attractor is an attractor point too and raises '*lower'.
+// Copies whose box cannot beat '*lower' are skipped, the others are split until they
+// are smaller than 'tolerance' and their box then bounds '*upper'.
+static void ifs_bound_side(const IfsSystem* system, const IfsAffine* piece, int depth, const double box[4],
+                           double px, double py, double dx, double dy, double tolerance,
+                           double* lower, double* upper) {
+    double cx, cy, hx, hy;
+    ifs_transform_box(piece, box[0], box[1], box[2], box[3], &cx, &cy, &hx, &hy);
+    double box_max = dx * cx + dy * cy + fabs(dx) * hx + fabs(dy) * hy;
+    if (box_max <= *lower) {
+        return;
+    }
+    double point = dx * (piece->a * px + piece->b * py + piece->e) + dy * (piece->c * px + piece->d * py + piece->f);
+    if (point > *lower) *lower = point;
+    if ((hx < tolerance && hy < tolerance) || depth >= IFS_BOUNDS_MAX_DEPTH) {
+        if (box_max > *upper) *upper = box_max;
+        return;
+    }
+    for (int i = 0; i < system->map_count; ++i) {
+        IfsAffine child;
+        ifs_compose(piece, &system->maps[i].affine, &child);
+        ifs_bound_side(system, &child, depth + 1, box, px, py, dx, dy, tolerance, lower, upper);
+    }
+}
+
+// For contracting affine maps, a disc around the centroid of the fixed points that every
+// map sends into itself contains the attractor, and ifs_bound_side() tightens its box on
+// each side. Other systems get a padded estimate from a chaos-game walk.
+static void ifs_compute_bounds(IfsSystem* system) {
+    double center_x = 0.0, center_y = 0.0;
+    int contracting = 1;
+    for (int i = 0; i < system->map_count; ++i) {
+        const IfsMap* map = &system->maps[i];
+        const IfsAffine* m = &map->affine;
+        double det = (1.0 - m->a) * (1.0 - m->d) - m->b * m->c;  // Fixed point solves (I - M) p = t
+        if (map->variation != IFS_LINEAR || ifs_norm(m) >= 1.0 || fabs(det) < 1e-12) {
+            contracting = 0;
+            break;
+        }
+        center_x += ((1.0 - m->d) * m->e + m->b * m->f) / det;
+        center_y += (m->c * m->e + (1.0 - m->a) * m->f) / det;
+    }
+
+    if (contracting) {
+        center_x /= system->map_count;
+        center_y /= system->map_count;
+        double radius = 0.0;
+        for (int i = 0; i < system->map_count; ++i) {
+            const IfsAffine* m = &system->maps[i].affine;
+            double moved_x, moved_y;
+            ifs_apply(&system->maps[i], center_x, center_y, &moved_x, &moved_y);
+            double needed = hypot(moved_x - center_x, moved_y - center_y) / (1.0 - ifs_norm(m));
+            if (needed > radius) radius = needed;
+        }
+
+        // The fixed point of the first map lies on the attractor
+        const IfsAffine* first = &system->maps[0].affine;
+        double det = (1.0 - first->a) * (1.0 - first->d) - first->b * first->c;
+        double px = ((1.0 - first->d) * first->e + first->b * first->f) / det;
+        double py = (first->c * first->e + (1.0 - first->a) * first->f) / det;
+        const IfsAffine identity = {1.0, 0.0, 0.0, 1.0, 0.0, 0.0};
+        const double box[4] = {center_x, center_y, radius, radius};
+        const double directions[4][2] = {{-1.0, 0.0}, {1.0, 0.0}, {0.0, -1.0}, {0.0, 1.0}};
+        double sides[4];
+        for (int side = 0; side < 4; ++side) {
+            double dx = directions[side][0], dy = directions[side][1];
+            double lower = dx * px + dy * py;
+            double upper = -INFINITY;
+            ifs_bound_side(system, &identity, 0, box, px, py, dx, dy, IFS_BOUNDS_TOLERANCE * radius, &lower, &upper);
+            sides[side] = fmax(lower, upper);
+        }
+        system->x_min = -sides[0];
+        system->x_max = sides[1];
+        system->y_min = -sides[2];
+        system->y_max = sides[3];
+        system->exact_bounds = 1;
+    } else {
+        IfsLanes lanes;
+        ifs_lanes_init(&lanes, 12345);
+        system->x_min = system->y_min = INFINITY;
+        system->x_max = system->y_max = -INFINITY;
+        for (int step = 0; step < IFS_BOUNDS_SAMPLES / IFS_LANES; ++step) {
+            ifs_lanes_step(system, &lanes);
+            if (step < 20) continue;  // Let the walkers settle onto the attractor
+            for (int lane = 0; lane < IFS_LANES; ++lane) {
+                if (!isfinite(lanes.x[lane]) || !isfinite(lanes.y[lane])) continue;
+                system->x_min = fmin(system->x_min, lanes.x[lane]);
+                system->x_max = fmax(system->x_max, lanes.x[lane]);
+                system->y_min = fmin(system->y_min, lanes.y[lane]);
+                system->y_max = fmax(system->y_max, lanes.y[lane]);
+            }
+        }
+        if (system->x_min > system->x_max) {
+            system->x_min = system->y_min = -1.0;  // The walk diverged everywhere
+            system->x_max = system->y_max = 1.0;
+        }
+        double pad = IFS_BOUNDS_PADDING * fmax(system->x_max - system->x_min, system->y_max - system->y_min);
+        system->x_min -= pad;
+        system->x_max += pad;
+        system->y_min -= pad;
+        system->y_max += pad;
+        system->exact_bounds = 0;
+    }
+
+    // Keep a usable extent for attractors that are a line segment or a point
+    double extent = fmax(fmax(system->x_max - system->x_min, system->y_max - system->y_min), 1e-6);
+    if (system->x_max - system->x_min < 1e-3 * extent) {
+        system->x_min -= 1e-3 * extent;
+        system->x_max += 1e-3 * extent;
+    }
+    if (system->y_max - system->y_min < 1e-3 * extent) {
+        system->y_min -= 1e-3 * extent;
+        system->y_max += 1e-3 * extent;
+    }
+}
+
+static int ifs_parse_variation(const char* name, IfsVariation* variation) {
+    static const char* names[] = {"linear", "sinusoidal", "spherical", "swirl"};
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); ++i) {
+        if (strcmp(name, names[i]) == 0) {
+            *variation = (IfsVariation)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Parses a system from text; 'source' names it in error messages. Returns 0 on success.
+static int ifs_parse(const char* text, const char* source, IfsSystem* system) {
+    memset(system, 0, sizeof(*system));
+    snprintf(system->name, sizeof(system->name), "%s", source);
+
+    int line_number = 0;
+    while (*text != '\0') {
+        const char* end = strchr(text, '\n');
+        size_t length = end != NULL ? (size_t)(end - text) : strlen(text);
+        char line[256];
+        size_t copied = length < sizeof(line) - 1 ? length : sizeof(line) - 1;
+        memcpy(line, text, copied);
+        line[copied] = '\0';
+        text += end != NULL ? length + 1 : length;
+        line_number++;
+
+        char* comment = strchr(line, '#');
+        if (comment != NULL) *comment = '\0';
+        char* p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        char* last = p + strlen(p);
+        while (last > p && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r')) *--last = '\0';
+        if (*p == '\0') {
+            continue;
+        }
+
+        if (strncmp(p, "name", 4) == 0 && (p[4] == ' ' || p[4] == '\t')) {
+            p += 4;
+            while (*p == ' ' || *p == '\t') p++;
+            snprintf(system->name, sizeof(system->name), "%s", p);
+            continue;
+        }
+
+        if (system->map_count == IFS_MAX_MAPS) {
+            fprintf(stderr, "%s:%d: more than %d maps\n", source, line_number, IFS_MAX_MAPS);
+            return 1;
+        }
+        IfsMap* map = &system->maps[system->map_count];
+        IfsAffine* m = &map->affine;
+        char variation[32] = "linear";
+        int fields = sscanf(p, "%lf %lf %lf %lf %lf %lf %lf %31s",
+                            &m->a, &m->b, &m->c, &m->d, &m->e, &m->f, &map->weight, variation);
+        if (fields < 7) {
+            fprintf(stderr, "%s:%d: expected 'a b c d e f weight [variation]'\n", source, line_number);
+            return 1;
+        }
+        if (!(map->weight > 0.0)) {
+            fprintf(stderr, "%s:%d: weight must be positive\n", source, line_number);
+            return 1;
+        }
+        if (!ifs_parse_variation(variation, &map->variation)) {
+            fprintf(stderr, "%s:%d: unknown variation '%s'\n", source, line_number, variation);
+            return 1;
+        }
+        system->map_count++;
+    }
+
+    if (system->map_count == 0) {
+        fprintf(stderr, "%s: no maps\n", source);
+        return 1;
+    }
+    ifs_build_alias(system);
+    ifs_compute_bounds(system);
+    return 0;
+}
+
+// Reads and parses an IFS file. Returns 0 on success.
+static int ifs_load(const char* path, IfsSystem* system) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        perror(path);
+        return 1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* text = (char*)malloc(size > 0 ? (size_t)size + 1 : 1);
+    if (text == NULL) {
+        fclose(file);
+        fprintf(stderr, "%s: out of memory\n", path);
+        return 1;
+    }
+    size_t read = size > 0 ? fread(text, 1, (size_t)size, file) : 0;
+    text[read] = '\0';
+    fclose(file);
+
+    int result = ifs_parse(text, path, system);
+    free(text);
+    return result;
+}
+
+#endif
@@ -5,6 +5,10 @@
 #include <complex.h>
 #include <SDL2/SDL_ttf.h>
 #include <string.h>
+#include "tileexport.h"
+#include "golden.h"
+#include "adaptiveaa.h"
+#include "perfhud.h"
 
 #define WIDTH 800
 #define HEIGHT 800
@@ -15,6 +19,10 @@ double g_imag_min = -2.0;
 double g_imag_max = 2.0;
 int g_current_max_iterations = 100;
 
+// Iteration counts of the last frame, used to find the pixels that need anti-aliasing
+int g_iteration_buffer[WIDTH * HEIGHT];
+AASettings g_aa_settings;
+
 // The constant 'c' for the Julia set equation: z_n+1 = z_n^2 + c
 double complex g_julia_c = -0.7 + 0.27015 * I;
 
@@ -95,6 +103,37 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename) {
     SDL_FreeSurface(screenshot);
 }
 
+// Returns the number of iterations before the orbit of z0 = z_real + i*z_imag escapes
+int juliaIterations(double z_real, double z_imag, int max_iterations) {
+    double complex z = z_real + z_imag * I;
+    int iterations = 0;
+
+    while (cabs(z) < 2.0 && iterations < max_iterations) {
+        z = z * z + g_julia_c;
+        iterations++;
+    }
+    return iterations;
+}
+
+// ARGB colour of a single point and its iteration count, used by the anti-aliasing pass
+uint32_t juliaSample(double z_real, double z_imag, int* iterations) {
+    *iterations = juliaIterations(z_real, z_imag, g_current_max_iterations);
+    SDL_Color color = getColor(*iterations, g_current_max_iterations);
+    return (color.a << 24) | (color.r << 16) | (color.g << 8) | color.b;
+}
+
+// ARGB colour of a single point, used by the strip exporter
+uint32_t juliaPixel(double z_real, double z_imag) {
+    int iterations;
+    return juliaSample(z_real, z_imag, &iterations);
+}
+
+// Fixed views pinned by 'make golden' (name, x_min, x_max, y_min, y_max, iterations)
+const GoldenView g_golden_views[] = {
+    {"full", -2.0, 2.0, -1.5, 1.5, 100},
+    {"center", -0.4, 0.4, -0.3, 0.3, 300},
+    {"detail", 0.3, 0.34, 0.1, 0.13, 1000},
+};
 
 void calculateAndRenderJulia(SDL_Renderer* renderer, SDL_Texture* fractalTexture, Uint32* pixels) {
     int w, h;
@@ -102,35 +141,77 @@ void calculateAndRenderJulia(SDL_Renderer* renderer, SDL_Texture* fractalTexture
 
     double real_width = g_real_max - g_real_min;
     double imag_height = g_imag_max - g_imag_min;
+    long long total_iterations = 0;
+
+    char view[160];
+    snprintf(view, sizeof(view), "R:[%.10g, %.10g] I:[%.10g, %.10g] C:%.5f%+.5fi it=%d",
+             g_real_min, g_real_max, g_imag_min, g_imag_max, creal(g_julia_c), cimag(g_julia_c), g_current_max_iterations);
+    perf_set_view(view);
+    perf_begin(PERF_COMPUTE);
 
     for (int y = 0; y < h; ++y) {
         for (int x = 0; x < w; ++x) {
             double z_real = g_real_min + (double)x / w * real_width;
             double z_imag = g_imag_min + (double)y / h * imag_height;
 
-            double complex z = z_real + z_imag * I;
-            int iterations = 0;
-
-            while (cabs(z) < 2.0 && iterations < g_current_max_iterations) {
-                z = z * z + g_julia_c;
-                iterations++;
-            }
+            int iterations = juliaIterations(z_real, z_imag, g_current_max_iterations);
+            g_iteration_buffer[y * w + x] = iterations;
+            total_iterations += iterations;
 
             SDL_Color color = getColor(iterations, g_current_max_iterations);
             pixels[y * w + x] = (color.a << 24) | (color.r << 16) | (color.g << 8) | color.b;
         }
     }
+
+    // Add jittered sub-samples only where neighbouring iteration counts jump
+    long long aa_samples = 0;
+    if (g_aa_settings.enabled) {
+        Uint64 trace_start = trace_begin();
+        aa_refine(&g_aa_settings, pixels, g_iteration_buffer, w, h, g_real_min, g_imag_min,
+                  real_width / w, imag_height / h, juliaSample);
+        trace_end("aa_refine", trace_start);
+        aa_samples = g_aa_settings.samples_taken;
+        total_iterations += g_aa_settings.iterations;
+    }
+    perf_end(PERF_COMPUTE);
+    perf_add_iterations(total_iterations);
+    perf_add_pixels((long long)w * h + aa_samples);
+
+    perf_begin(PERF_UPLOAD);
     SDL_UpdateTexture(fractalTexture, NULL, pixels, w * sizeof(Uint32));
+    perf_end(PERF_UPLOAD);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Golden-image regression check: render the fixed views headlessly and compare
+    GoldenOptions golden_options;
+    int golden_status = golden_parse_args(argc, argv, &golden_options);
+    if (golden_status != 0) {
+        if (golden_status < 0) return 1;
+        return golden_run(&golden_options, "julia", g_golden_views, GOLDEN_VIEW_COUNT(g_golden_views), juliaIterations);
+    }
+
+    // Headless poster export: render straight to disk without opening a window
+    ExportJob export_job = export_default_job(g_real_min, g_real_max, g_imag_min, g_imag_max, g_current_max_iterations);
+    int export_status = export_parse_args(argc, argv, &export_job);
+    if (export_status != 0) {
+        if (export_status < 0) return 1;
+        g_current_max_iterations = export_job.max_iterations;
+        return export_run(&export_job, juliaPixel);
+    }
+    perf_init(argc, argv);
+
     printf("Use Mouse Wheel to zoom in/out.\n");
     printf("Click and Drag with Left Mouse Button to pan.\n");
     printf("Press 'R' to reset zoom, pan, and constant C.\n");
+    printf("Press 'A' to toggle adaptive anti-aliasing, '[' / ']' to halve / double its sample budget.\n");
+    printf("Press 'F1' to toggle the performance HUD.\n");
     printf("Click 'Screenshot' button in top-right to save an image.\n");
     printf("Current Constant C: %.5f + %.5fi\n", creal(g_julia_c), cimag(g_julia_c));
     printf("Current Max Iterations: %d\n", g_current_max_iterations);
 
+    g_aa_settings = aa_default_settings();
+
     SDL_SetHint(SDL_HINT_RENDER_DRIVER, "wayland"); // Or "x11" or empty string for default
 
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -217,6 +298,7 @@ int main() {
 
     while (application_running) {
         while (SDL_PollEvent(&event)) {
+            if (perf_handle_event(&event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
@@ -228,7 +310,9 @@ int main() {
                             event.button.x <= screenshotButtonRect.x + screenshotButtonRect.w &&
                             event.button.y >= screenshotButtonRect.y &&
                             event.button.y <= screenshotButtonRect.y + screenshotButtonRect.h) {
+                            Uint64 trace_start = trace_begin();
                             saveScreenshot(renderer, "julia_screenshot.bmp");
+                            trace_end("screenshot", trace_start);
                         } else {
                             // Start panning
                             g_is_panning = true;
@@ -292,6 +376,15 @@ int main() {
                         g_current_max_iterations = 100;
                         g_julia_c = -0.7 + 0.27015 * I;
                         calculateAndRenderJulia(renderer, fractalTexture, pixels);
+                    } else if (event.key.keysym.sym == SDLK_a) {
+                        g_aa_settings.enabled = !g_aa_settings.enabled;
+                        calculateAndRenderJulia(renderer, fractalTexture, pixels);
+                    } else if (event.key.keysym.sym == SDLK_LEFTBRACKET) {
+                        g_aa_settings.sample_budget = fmax(AA_MIN_SAMPLES, g_aa_settings.sample_budget / 2);
+                        calculateAndRenderJulia(renderer, fractalTexture, pixels);
+                    } else if (event.key.keysym.sym == SDLK_RIGHTBRACKET) {
+                        g_aa_settings.sample_budget = fmin(16 * WIDTH * HEIGHT, g_aa_settings.sample_budget * 2.0);
+                        calculateAndRenderJulia(renderer, fractalTexture, pixels);
                     }
                     break;
             }
@@ -300,9 +393,12 @@ int main() {
         // --- Rendering ---
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
+        perf_begin(PERF_DRAW);
         SDL_RenderCopy(renderer, fractalTexture, NULL, NULL);
+        perf_end(PERF_DRAW);
 
         // Render text overlays
+        perf_begin(PERF_TEXT);
         if (font != NULL) {
             char text_buffer[200];
             SDL_Color textColor = {255, 255, 255, 255};
@@ -315,6 +411,15 @@ int main() {
             snprintf(text_buffer, sizeof(text_buffer), "C: %.5f + %.5fi", creal(g_julia_c), cimag(g_julia_c));
             renderText(renderer, font, text_buffer, 10, 30, textColor);
 
+            // Display anti-aliasing state
+            if (g_aa_settings.enabled) {
+                snprintf(text_buffer, sizeof(text_buffer), "AA: %d px refined, budget %d samples",
+                         g_aa_settings.refined_pixels, g_aa_settings.sample_budget);
+            } else {
+                snprintf(text_buffer, sizeof(text_buffer), "AA: off");
+            }
+            renderText(renderer, font, text_buffer, 10, 50, textColor);
+
             // Draw and render text for the screenshot button
             SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);
             SDL_RenderFillRect(renderer, &screenshotButtonRect);
@@ -324,11 +429,17 @@ int main() {
             SDL_Color buttonTextColor = {255, 255, 255, 255};
             renderText(renderer, font, "Save", screenshotButtonRect.x + 8, screenshotButtonRect.y + 7, buttonTextColor);
         }
+        perf_end(PERF_TEXT);
+        perf_draw_hud(renderer, font);
 
+        perf_begin(PERF_PRESENT);
         SDL_RenderPresent(renderer);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
     }
 
     // --- Cleanup ---
+    perf_shutdown();
     free(pixels);
     SDL_DestroyTexture(fractalTexture);
     if (font != NULL) {
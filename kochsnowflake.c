@@ -1,70 +1,362 @@
 #include <stdio.h>
+#include <string.h>
 #include <SDL2/SDL.h>
 #include <stdbool.h>
 #include <math.h>
 #include <SDL2/SDL_ttf.h>
+#include "perfhud.h"
+#include "linebatch.h"
 
 #define WIDTH 800
 #define HEIGHT 800
 
 #define MAX_RECURSION_DEPTH 5
 
-// Global variables for zoom and pan
-double g_zoom = 1.0;
-double g_offset_x = 0.0;
-double g_offset_y = 0.0;
+// Deep zoom. The camera is anchored on one segment of the subdivided outline, kept
+// between a third of KOCH_ANCHOR_PIXELS and KOCH_ANCHOR_PIXELS long on screen. Its path
+// (side, then one child index per level) is exact and only its screen position is a
+// double, so zooming in never runs out of precision.
+#define KOCH_PATH_LEVELS 4096
+#define KOCH_ANCHOR_PIXELS (2.0 * WIDTH)
+
+// Drawing starts this many levels above the anchor, from that ancestor and its two
+// neighbours. Parts of the curve that are not neighbours stay a fixed fraction of their
+// size apart, so nothing else can reach the window.
+#define KOCH_ANCHOR_ANCESTORS 3
+
+// Depth the Up arrow can reach. Subdivision also stops once a segment is shorter than
+// KOCH_LOD_PIXELS on screen, so deep levels only cost anything when zoomed in.
+#define KOCH_DEPTH_LIMIT KOCH_PATH_LEVELS
+#define KOCH_LOD_PIXELS 1.0
+
+// Leaf segments are clipped to the window plus this margin before conversion to int
+#define KOCH_CLIP_MARGIN 16.0
+
+const double KOCH_SIN_60 = 0.86602540378443864676;  // sin(pi / 3); cos(pi / 3) is 0.5
+
+// Segment directions in steps of 60 degrees, in the rotation sense used for the tips
+const double KOCH_DIRECTIONS[6][2] = {
+    {1.0, 0.0}, {0.5, 0.86602540378443864676}, {-0.5, 0.86602540378443864676},
+    {-1.0, 0.0}, {-0.5, -0.86602540378443864676}, {0.5, -0.86602540378443864676}
+};
 
 // For mouse drag panning
 int g_mouse_down_x = 0;
 int g_mouse_down_y = 0;
 bool g_is_panning = false;
 
+LineBatch g_line_batch;
+long long g_koch_nodes = 0;  // Subdivision steps in the current frame
+
 // Structure to represent a 2D point
 typedef struct {
     double x;
     double y;
 } Point;
 
-void drawLine(SDL_Renderer* renderer, Point p1, Point p2) {
-    SDL_RenderDrawLine(renderer,
-                       (int)((p1.x * g_zoom) + g_offset_x),
-                       (int)((p1.y * g_zoom) + g_offset_y),
-                       (int)((p2.x * g_zoom) + g_offset_x),
-                       (int)((p2.y * g_zoom) + g_offset_y));
+typedef struct {
+    Point start;    // Screen space
+    int heading;    // Index into KOCH_DIRECTIONS
+    double length;  // Pixels
+} KochSegment;
+
+typedef struct {
+    int levels;  // Path length; the anchor is a segment of level 'levels - 1'
+    unsigned char path[KOCH_PATH_LEVELS];  // path[0] is the side, path[k] the child at level k
+    KochSegment segment;
+} KochAnchor;
+
+KochAnchor g_anchor;
+
+// Clips p1-p2 to the window plus KOCH_CLIP_MARGIN (Liang-Barsky). Returns false if
+// nothing is left.
+bool clipKochSegment(Point* p1, Point* p2) {
+    double t0 = 0.0, t1 = 1.0;
+    double dx = p2->x - p1->x, dy = p2->y - p1->y;
+    double p[4] = {-dx, dx, -dy, dy};
+    double q[4] = {p1->x + KOCH_CLIP_MARGIN, WIDTH + KOCH_CLIP_MARGIN - p1->x,
+                   p1->y + KOCH_CLIP_MARGIN, HEIGHT + KOCH_CLIP_MARGIN - p1->y};
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0.0) {
+            if (q[i] < 0.0) return false;
+        } else {
+            double t = q[i] / p[i];
+            if (p[i] < 0.0) {
+                if (t > t1) return false;
+                if (t > t0) t0 = t;
+            } else {
+                if (t < t0) return false;
+                if (t < t1) t1 = t;
+            }
+        }
+    }
+    Point start = {p1->x + t0 * dx, p1->y + t0 * dy};
+    Point end = {p1->x + t1 * dx, p1->y + t1 * dy};
+    *p1 = start;
+    *p2 = end;
+    return true;
+}
+
+// Points are in screen space. Consecutive segments share their end point, so the
+// visible parts of the snowflake form long polylines.
+void drawLine(LineBatch* batch, Point p1, Point p2) {
+    if (!clipKochSegment(&p1, &p2)) {
+        return;
+    }
+    line_batch_add(batch, (int)p1.x, (int)p1.y, (int)p2.x, (int)p2.y);
+}
+
+// The curve built on p1-p2 stays inside the triangle p1, p2, tip, so a subtree whose
+// triangle misses the window can be skipped
+bool kochTriangleVisible(Point p1, Point p2, Point tip) {
+    double min_x = fmin(p1.x, fmin(p2.x, tip.x));
+    double max_x = fmax(p1.x, fmax(p2.x, tip.x));
+    double min_y = fmin(p1.y, fmin(p2.y, tip.y));
+    double max_y = fmax(p1.y, fmax(p2.y, tip.y));
+    return max_x >= -1.0 && min_x <= WIDTH + 1.0 && max_y >= -1.0 && min_y <= HEIGHT + 1.0;
+}
+
+void drawKochCurve(LineBatch* batch, Point p1, Point p2, int depth) {
+    g_koch_nodes++;
+
+    // Segment length
+    double dx = p2.x - p1.x;
+    double dy = p2.y - p1.y;
+    if (depth <= 0 || dx * dx + dy * dy < KOCH_LOD_PIXELS * KOCH_LOD_PIXELS) {
+        drawLine(batch, p1, p2);
+        return;
+    }
+
+    // Calculate the four intermediate points that form the new segments
+    // p1 (A) -------- p_ab (B) --- p_cd (D) -------- p2 (E)
+    //                   \         /
+    //                    \       /
+    //                     p_c (C)
+
+    // Point B (1/3 of the way from A to E)
+    Point p_ab = {p1.x + dx / 3.0, p1.y + dy / 3.0};
+
+    // Point D (2/3 of the way from A to E)
+    Point p_cd = {p1.x + 2.0 * dx / 3.0, p1.y + 2.0 * dy / 3.0};
+
+    // Point C (tip of the equilateral triangle): vector BD rotated by 60 degrees around B
+    double third_x = dx / 3.0;
+    double third_y = dy / 3.0;
+    Point p_c = {p_ab.x + third_x * 0.5 - third_y * KOCH_SIN_60,
+                 p_ab.y + third_x * KOCH_SIN_60 + third_y * 0.5};
+
+    if (!kochTriangleVisible(p1, p2, p_c)) {
+        return;
+    }
+
+    // Recursively call drawKochCurve for the four new segments
+    drawKochCurve(batch, p1, p_ab, depth - 1); // Segment AB
+    drawKochCurve(batch, p_ab, p_c, depth - 1); // Segment BC
+    drawKochCurve(batch, p_c, p_cd, depth - 1); // Segment CD
+    drawKochCurve(batch, p_cd, p2, depth - 1); // Segment DE
+}
+
+// --- Deep Zoom ---
+
+Point kochSegmentEnd(const KochSegment* segment) {
+    const double* direction = KOCH_DIRECTIONS[segment->heading];
+    return (Point){segment->start.x + segment->length * direction[0],
+                   segment->start.y + segment->length * direction[1]};
+}
+
+// Segments of 'level' split into the four Koch segments above the recursion depth and
+// into three straight thirds below it
+int kochChildCount(int level, int depth) {
+    return level < depth ? 4 : 3;
+}
+
+// Heading of child 'child' relative to its parent at 'level'; level -1 gives the
+// headings of the three sides
+int kochTurn(int level, int child, int depth) {
+    static const int side_headings[3] = {0, 4, 2};
+    static const int koch_turns[4] = {0, 1, 5, 0};
+    if (level < 0) {
+        return side_headings[child];
+    }
+    return level < depth ? koch_turns[child] : 0;
+}
+
+// Start of child 'child' relative to the start of its parent, whose heading is 'heading'
+Point kochChildOffset(int heading, double third, int level, int child, int depth) {
+    static const int koch_steps[4] = {0, 1, 1, 2};
+    const double* direction = KOCH_DIRECTIONS[heading];
+    int steps = level < depth ? koch_steps[child] : child;
+    Point offset = {steps * third * direction[0], steps * third * direction[1]};
+    if (level < depth && child == 2) {
+        // C: past the tip side B-C
+        offset.x += third * KOCH_DIRECTIONS[(heading + 1) % 6][0];
+        offset.y += third * KOCH_DIRECTIONS[(heading + 1) % 6][1];
+    }
+    return offset;
+}
+
+KochSegment kochChild(const KochSegment* parent, int level, int child, int depth) {
+    double third = parent->length / 3.0;
+    Point offset = kochChildOffset(parent->heading, third, level, child, depth);
+    return (KochSegment){{parent->start.x + offset.x, parent->start.y + offset.y},
+                         (parent->heading + kochTurn(level, child, depth)) % 6, third};
+}
+
+KochSegment kochParent(const KochSegment* segment, int level, int child, int depth) {
+    int heading = (segment->heading + 6 - kochTurn(level, child, depth)) % 6;
+    Point offset = kochChildOffset(heading, segment->length, level, child, depth);
+    return (KochSegment){{segment->start.x - offset.x, segment->start.y - offset.y},
+                         heading, segment->length * 3.0};
+}
+
+// Path index whose digit changes when stepping to the next (delta 1) or previous
+// (delta -1) segment: the deepest one that does not wrap. The sides wrap around.
+int kochStepIndex(const KochAnchor* anchor, int delta, int depth) {
+    int k = anchor->levels - 1;
+    while (k > 0 && anchor->path[k] == (delta > 0 ? kochChildCount(k - 1, depth) - 1 : 0)) {
+        k--;
+    }
+    return k;
+}
+
+int kochStepDigit(const KochAnchor* anchor, int k, int delta) {
+    return k == 0 ? (anchor->path[0] + delta + 3) % 3 : anchor->path[k] + delta;
 }
 
-void drawKochCurve(SDL_Renderer* renderer, Point p1, Point p2, int depth) {
-    if (depth == 0) {
-        drawLine(renderer, p1, p2);
+// Neighbouring segment of the same level. Digits below the changed one go from last
+// to first child (or back), which both keep the parent's heading.
+KochSegment kochNeighbor(const KochAnchor* anchor, int delta, int depth) {
+    int k = kochStepIndex(anchor, delta, depth);
+    int digit = kochStepDigit(anchor, k, delta);
+    KochSegment segment = anchor->segment;
+    segment.heading = (segment.heading + 6 + kochTurn(k - 1, digit, depth) -
+                       kochTurn(k - 1, anchor->path[k], depth)) % 6;
+    if (delta > 0) {
+        segment.start = kochSegmentEnd(&anchor->segment);
     } else {
-        // Calculate the four intermediate points that form the new segments
-        // p1 (A) -------- p_ab (B) --- p_cd (D) -------- p2 (E)
-        //                   \         /
-        //                    \       /
-        //                     p_c (C)
-
-        // Segment length
-        double dx = p2.x - p1.x;
-        double dy = p2.y - p1.y;
-
-        // Point B (1/3 of the way from A to E)
-        Point p_ab = {p1.x + dx / 3.0, p1.y + dy / 3.0};
-
-        // Point D (2/3 of the way from A to E)
-        Point p_cd = {p1.x + 2.0 * dx / 3.0, p1.y + 2.0 * dy / 3.0};
-
-        // Point C (tip of the equilateral triangle)
-        // Rotate vector BD by 60 degrees (M_PI / 3) around B for point C
-        double angle = M_PI / 3.0;
-        Point p_c;
-        p_c.x = p_ab.x + (p_cd.x - p_ab.x) * cos(angle) - (p_cd.y - p_ab.y) * sin(angle);
-        p_c.y = p_ab.y + (p_cd.x - p_ab.x) * sin(angle) + (p_cd.y - p_ab.y) * cos(angle);
-
-        // Recursively call drawKochCurve for the four new segments
-        drawKochCurve(renderer, p1, p_ab, depth - 1); // Segment AB
-        drawKochCurve(renderer, p_ab, p_c, depth - 1); // Segment BC
-        drawKochCurve(renderer, p_c, p_cd, depth - 1); // Segment CD
-        drawKochCurve(renderer, p_cd, p2, depth - 1); // Segment DE
+        segment.start.x -= segment.length * KOCH_DIRECTIONS[segment.heading][0];
+        segment.start.y -= segment.length * KOCH_DIRECTIONS[segment.heading][1];
+    }
+    return segment;
+}
+
+void stepKochAnchor(KochAnchor* anchor, int delta, int depth) {
+    KochSegment segment = kochNeighbor(anchor, delta, depth);
+    int k = kochStepIndex(anchor, delta, depth);
+    anchor->path[k] = (unsigned char)kochStepDigit(anchor, k, delta);
+    for (int i = k + 1; i < anchor->levels; ++i) {
+        anchor->path[i] = (unsigned char)(delta > 0 ? 0 : kochChildCount(i - 1, depth) - 1);
+    }
+    anchor->segment = segment;
+}
+
+// Distance from p to the chord of 'segment'
+double kochSegmentDistance(const KochSegment* segment, Point p) {
+    const double* direction = KOCH_DIRECTIONS[segment->heading];
+    double dx = p.x - segment->start.x, dy = p.y - segment->start.y;
+    double t = fmax(0.0, fmin(segment->length, dx * direction[0] + dy * direction[1]));
+    return hypot(dx - t * direction[0], dy - t * direction[1]);
+}
+
+// Moves the anchor along the curve towards the window centre, then down or up the
+// levels until its length is in range again
+void normalizeKochAnchor(KochAnchor* anchor, int depth) {
+    Point centre = {WIDTH / 2.0, HEIGHT / 2.0};
+    for (;;) {
+        double distance = kochSegmentDistance(&anchor->segment, centre);
+        KochSegment previous = kochNeighbor(anchor, -1, depth);
+        KochSegment next = kochNeighbor(anchor, 1, depth);
+        if (kochSegmentDistance(&previous, centre) < distance) {
+            stepKochAnchor(anchor, -1, depth);
+        } else if (kochSegmentDistance(&next, centre) < distance) {
+            stepKochAnchor(anchor, 1, depth);
+        } else if (anchor->segment.length > KOCH_ANCHOR_PIXELS && anchor->levels < KOCH_PATH_LEVELS) {
+            // Descend into the child closest to the centre
+            int level = anchor->levels - 1;
+            int best_child = 0;
+            KochSegment best = kochChild(&anchor->segment, level, 0, depth);
+            for (int child = 1; child < kochChildCount(level, depth); ++child) {
+                KochSegment candidate = kochChild(&anchor->segment, level, child, depth);
+                if (kochSegmentDistance(&candidate, centre) < kochSegmentDistance(&best, centre)) {
+                    best = candidate;
+                    best_child = child;
+                }
+            }
+            anchor->path[anchor->levels++] = (unsigned char)best_child;
+            anchor->segment = best;
+        } else if (anchor->segment.length * 3.0 <= KOCH_ANCHOR_PIXELS && anchor->levels > 1) {
+            anchor->levels--;
+            anchor->segment = kochParent(&anchor->segment, anchor->levels - 1, anchor->path[anchor->levels], depth);
+        } else {
+            return;
+        }
+    }
+}
+
+void resetKochView(void) {
+    // Define the initial equilateral triangle for the snowflake; the anchor starts on
+    // its bottom side
+    double side_length = 600.0;
+    g_anchor.levels = 1;
+    g_anchor.path[0] = 0;
+    g_anchor.segment = (KochSegment){{WIDTH / 2.0 - side_length / 2.0,
+                                      HEIGHT / 2.0 + side_length / (2.0 * sqrt(3.0)) - 50},
+                                     0, side_length};
+}
+
+void panKochView(double dx, double dy) {
+    g_anchor.segment.start.x += dx;
+    g_anchor.segment.start.y += dy;
+}
+
+// Magnifies by 'factor' keeping screen point (x, y) fixed
+void zoomKochView(double x, double y, double factor) {
+    g_anchor.segment.start.x = x + (g_anchor.segment.start.x - x) * factor;
+    g_anchor.segment.start.y = y + (g_anchor.segment.start.y - y) * factor;
+    g_anchor.segment.length *= factor;
+}
+
+double kochZoomLog10(void) {
+    return (g_anchor.levels - 1) * log10(3.0) + log10(g_anchor.segment.length / 600.0);
+}
+
+// Path digits of the levels between the two depths are child indices under one and
+// thirds under the other. The end pieces map onto each other unchanged; the middle
+// third and the tip map onto each other, so the view follows the same path to where
+// that part of the curve now lies.
+void changeKochDepth(int old_depth, int new_depth) {
+    static const unsigned char koch_to_thirds[4] = {0, 1, 1, 2};
+    static const unsigned char thirds_to_koch[3] = {0, 1, 3};
+    int low = old_depth < new_depth ? old_depth : new_depth;
+    int high = old_depth < new_depth ? new_depth : old_depth;
+    int heading = 0;
+    for (int k = 0; k < g_anchor.levels; ++k) {
+        int level = k - 1;
+        if (level >= low && level < high) {
+            g_anchor.path[k] = new_depth > old_depth ? thirds_to_koch[g_anchor.path[k]] : koch_to_thirds[g_anchor.path[k]];
+        }
+        heading += kochTurn(level, g_anchor.path[k], new_depth);
+    }
+    g_anchor.segment.heading = heading % 6;
+}
+
+void drawKochSnowflake(LineBatch* batch, int depth) {
+    normalizeKochAnchor(&g_anchor, depth);
+
+    // Walk up to the ancestor the drawing starts from
+    static KochAnchor ancestor;
+    ancestor.levels = g_anchor.levels;
+    memcpy(ancestor.path, g_anchor.path, (size_t)g_anchor.levels);
+    ancestor.segment = g_anchor.segment;
+    for (int i = 0; i < KOCH_ANCHOR_ANCESTORS && ancestor.levels > 1; ++i) {
+        ancestor.levels--;
+        ancestor.segment = kochParent(&ancestor.segment, ancestor.levels - 1, ancestor.path[ancestor.levels], depth);
+    }
+
+    // At the top level these are the three sides
+    KochSegment segments[3] = {kochNeighbor(&ancestor, -1, depth), ancestor.segment, kochNeighbor(&ancestor, 1, depth)};
+    for (int i = 0; i < 3; ++i) {
+        drawKochCurve(batch, segments[i].start, kochSegmentEnd(&segments[i]), depth - (ancestor.levels - 1));
     }
 }
 
@@ -124,13 +416,16 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename) {
 }
 
 
-int main() {
+int main(int argc, char* argv[]) {
+    perf_init(argc, argv);
+
     printf("Koch Snowflake Viewer\n");
     printf("Press 'Up' arrow to increase recursion depth.\n");
     printf("Press 'Down' arrow to decrease recursion depth.\n");
     printf("Use Mouse Wheel to zoom in/out.\n");
     printf("Click and Drag with Left Mouse Button to pan.\n");
     printf("Press 'R' to reset zoom and pan.\n");
+    printf("Press 'F1' to toggle the performance HUD.\n");
     printf("Click 'Screenshot' button in top-right to save an image.\n");
     printf("Current Depth: %d\n", MAX_RECURSION_DEPTH);
 
@@ -179,41 +474,66 @@ int main() {
         printf("Failed to load font! SDL_ttf Error: %s\n", TTF_GetError());
     }
 
+    // The snowflake is drawn into this texture and only redrawn when depth, zoom or
+    // pan change; idle frames just copy it
+    SDL_Texture* koch_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                                  SDL_TEXTUREACCESS_TARGET, WIDTH, HEIGHT);
+    if (koch_texture == NULL) {
+        printf("Failed to create the Koch texture! SDL_Error: %s\n", SDL_GetError());
+        if (font != NULL) TTF_CloseFont(font);
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(pwindow);
+        TTF_Quit();
+        SDL_Quit();
+        return 1;
+    }
+    bool needs_redraw = true;
+
     SDL_Rect screenshotButtonRect = {WIDTH - 120, 10, 110, 30};
 
     // Initial recursion depth
     int current_depth = MAX_RECURSION_DEPTH;
+    resetKochView();
 
     bool application_running = true;
     SDL_Event event;
 
     while (application_running) {
         while (SDL_PollEvent(&event)) {
+            if (perf_handle_event(&event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
                     break;
+                case SDL_RENDER_TARGETS_RESET:
+                case SDL_RENDER_DEVICE_RESET:
+                    // Target texture contents are lost
+                    needs_redraw = true;
+                    break;
                 case SDL_KEYDOWN:
                     if (event.key.keysym.sym == SDLK_UP) {
-                        if (current_depth < 7) {
+                        if (current_depth < KOCH_DEPTH_LIMIT) {
+                            changeKochDepth(current_depth, current_depth + 1);
                             current_depth++;
+                            needs_redraw = true;
                             printf("Current Depth: %d\n", current_depth);
                         } else {
-                            printf("Max depth reached (7).\n");
+                            printf("Max depth reached (%d).\n", KOCH_DEPTH_LIMIT);
                         }
                     } else if (event.key.keysym.sym == SDLK_DOWN) {
                         if (current_depth > 0) {
+                            changeKochDepth(current_depth, current_depth - 1);
                             current_depth--;
+                            needs_redraw = true;
                             printf("Current Depth: %d\n", current_depth);
                         } else {
                             printf("Min depth reached (0).\n");
                         }
                     } else if (event.key.keysym.sym == SDLK_r) {
                         // Reset zoom and pan
-                        g_zoom = 1.0;
-                        g_offset_x = 0.0;
-                        g_offset_y = 0.0;
+                        resetKochView();
                         current_depth = MAX_RECURSION_DEPTH;
+                        needs_redraw = true;
                         printf("Resetting zoom, pan, and depth.\n");
                     }
                     break;
@@ -224,14 +544,11 @@ int main() {
                         SDL_GetMouseState(&mouse_x, &mouse_y);
 
                         if (event.wheel.y > 0) {
-                            g_offset_x = mouse_x - ((mouse_x - g_offset_x) * zoom_factor);
-                            g_offset_y = mouse_y - ((mouse_y - g_offset_y) * zoom_factor);
-                            g_zoom *= zoom_factor;
+                            zoomKochView(mouse_x, mouse_y, zoom_factor);
                         } else if (event.wheel.y < 0) {
-                            g_offset_x = mouse_x - ((mouse_x - g_offset_x) / zoom_factor);
-                            g_offset_y = mouse_y - ((mouse_y - g_offset_y) / zoom_factor);
-                            g_zoom /= zoom_factor;
+                            zoomKochView(mouse_x, mouse_y, 1.0 / zoom_factor);
                         }
+                        needs_redraw = true;
                     }
                     break;
                 case SDL_MOUSEBUTTONDOWN:
@@ -240,7 +557,9 @@ int main() {
                             event.button.x <= screenshotButtonRect.x + screenshotButtonRect.w &&
                             event.button.y >= screenshotButtonRect.y &&
                             event.button.y <= screenshotButtonRect.y + screenshotButtonRect.h) {
+                            Uint64 trace_start = trace_begin();
                             saveScreenshot(renderer, "koch_snowflake_screenshot.bmp");
+                            trace_end("screenshot", trace_start);
                         } else {
                             g_is_panning = true;
                             g_mouse_down_x = event.button.x;
@@ -255,34 +574,44 @@ int main() {
                     break;
                 case SDL_MOUSEMOTION:
                     if (g_is_panning) {
-                        g_offset_x += (event.motion.x - g_mouse_down_x);
-                        g_offset_y += (event.motion.y - g_mouse_down_y);
+                        panKochView(event.motion.x - g_mouse_down_x, event.motion.y - g_mouse_down_y);
                         g_mouse_down_x = event.motion.x;
                         g_mouse_down_y = event.motion.y;
+                        needs_redraw = true;
                     }
                     break;
             }
         }
 
-        // Clear the screen
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
+        if (needs_redraw) {
+            SDL_SetRenderTarget(renderer, koch_texture);
+
+            // Clear the screen
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+            SDL_RenderClear(renderer);
 
-        // Set draw color for the snowflake
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+            // Set draw color for the snowflake
+            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
 
-        // Define the initial equilateral triangle points for the snowflake
-        double side_length = 600.0;
-        Point p1 = {WIDTH / 2.0 - side_length / 2.0, HEIGHT / 2.0 + side_length / (2.0 * sqrt(3.0)) - 50};
-        Point p2 = {WIDTH / 2.0 + side_length / 2.0, HEIGHT / 2.0 + side_length / (2.0 * sqrt(3.0)) - 50};
-        Point p3 = {WIDTH / 2.0, HEIGHT / 2.0 - side_length * sqrt(3.0) / 2.0 + side_length / (2.0 * sqrt(3.0)) - 50};
+            // Subdivision happens in screen space, where the LOD and culling tests are made
+            perf_begin(PERF_COMPUTE);
+            g_koch_nodes = 0;
+            line_batch_begin(&g_line_batch, renderer);
+            drawKochSnowflake(&g_line_batch, current_depth);
+            line_batch_end(&g_line_batch);
+            perf_end(PERF_COMPUTE);
+            perf_add_iterations(g_koch_nodes);
+            perf_add_pixels(g_line_batch.segments);
 
-        // Draw the three sides of the snowflake by calling Koch curve for each side
-        drawKochCurve(renderer, p1, p2, current_depth);
-        drawKochCurve(renderer, p2, p3, current_depth);
-        drawKochCurve(renderer, p3, p1, current_depth);
+            SDL_SetRenderTarget(renderer, NULL);
+            needs_redraw = false;
+        }
+        perf_begin(PERF_DRAW);
+        SDL_RenderCopy(renderer, koch_texture, NULL, NULL);
+        perf_end(PERF_DRAW);
 
         // Render current depth and zoom level
+        perf_begin(PERF_TEXT);
         if (font != NULL) {
             char text_buffer[100];
             SDL_Color textColor = {255, 255, 255, 255};
@@ -290,7 +619,12 @@ int main() {
             snprintf(text_buffer, sizeof(text_buffer), "Depth: %d", current_depth);
             renderText(renderer, font, text_buffer, 10, 10, textColor);
 
-            snprintf(text_buffer, sizeof(text_buffer), "Zoom: %.2fx", g_zoom);
+            double zoom_log10 = kochZoomLog10();
+            if (zoom_log10 < 6.0) {
+                snprintf(text_buffer, sizeof(text_buffer), "Zoom: %.2fx", pow(10.0, zoom_log10));
+            } else {
+                snprintf(text_buffer, sizeof(text_buffer), "Zoom: 10^%.1fx", zoom_log10);
+            }
             renderText(renderer, font, text_buffer, 10, 40, textColor);
 
             // Draw and render text for the screenshot button
@@ -302,13 +636,19 @@ int main() {
             SDL_Color buttonTextColor = {255, 255, 255, 255};
             renderText(renderer, font, "Save", screenshotButtonRect.x + 8, screenshotButtonRect.y + 5, buttonTextColor);
         }
-
+        perf_end(PERF_TEXT);
+        perf_draw_hud(renderer, font);
 
         // Present the rendered content
+        perf_begin(PERF_PRESENT);
         SDL_RenderPresent(renderer);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
     }
 
     // --- Cleanup ---
+    perf_shutdown();
+    SDL_DestroyTexture(koch_texture);
     if (font != NULL) {
         TTF_CloseFont(font);
     }
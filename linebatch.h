@@ -0,0 +1,91 @@
+#ifndef LINEBATCH_H
+#define LINEBATCH_H
+
+// Batched line submission for the vector-drawn viewers.
+//
+// Segments are appended with line_batch_add(). A segment that starts or ends
+// where the pending polyline ends extends it, so connected geometry (curves,
+// trajectories, closed outlines) reaches the renderer as one
+// SDL_RenderDrawLines call per LINE_BATCH_POINTS points instead of one
+// SDL_RenderDrawLine call per segment. A disconnected segment, a colour
+// change through line_batch_set_color() or line_batch_end() flushes the
+// pending polyline. Callers get the most out of it by emitting segments in
+// path order.
+//
+// Functions are 'static inline' like perfhud.h.
+
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+
+#define LINE_BATCH_POINTS 4096
+
+typedef struct {
+    SDL_Renderer* renderer;
+    SDL_Point points[LINE_BATCH_POINTS];  // Pending polyline
+    int count;
+    SDL_Color color;
+    bool has_color;       // False until line_batch_set_color() is called
+    long long segments;   // Segments added since line_batch_begin()
+    long long calls;      // SDL draw calls issued since line_batch_begin()
+} LineBatch;
+
+static inline void line_batch_begin(LineBatch* batch, SDL_Renderer* renderer) {
+    batch->renderer = renderer;
+    batch->count = 0;
+    batch->has_color = false;
+    batch->segments = 0;
+    batch->calls = 0;
+}
+
+static inline void line_batch_flush(LineBatch* batch) {
+    if (batch->count >= 2) {
+        SDL_RenderDrawLines(batch->renderer, batch->points, batch->count);
+        batch->calls++;
+    }
+    batch->count = 0;
+}
+
+// Flushes only when the colour actually changes
+static inline void line_batch_set_color(LineBatch* batch, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+    if (batch->has_color && batch->color.r == r && batch->color.g == g &&
+        batch->color.b == b && batch->color.a == a) {
+        return;
+    }
+    line_batch_flush(batch);
+    SDL_SetRenderDrawColor(batch->renderer, r, g, b, a);
+    batch->color = (SDL_Color){r, g, b, a};
+    batch->has_color = true;
+}
+
+static inline void line_batch_add(LineBatch* batch, int x1, int y1, int x2, int y2) {
+    batch->segments++;
+    if (batch->count > 0) {
+        SDL_Point last = batch->points[batch->count - 1];
+        if (last.x == x1 && last.y == y1) {
+            batch->points[batch->count++] = (SDL_Point){x2, y2};
+        } else if (last.x == x2 && last.y == y2) {
+            batch->points[batch->count++] = (SDL_Point){x1, y1};
+        } else {
+            line_batch_flush(batch);
+        }
+    }
+    if (batch->count == 0) {
+        batch->points[0] = (SDL_Point){x1, y1};
+        batch->points[1] = (SDL_Point){x2, y2};
+        batch->count = 2;
+    }
+
+    // A full buffer continues from its last point
+    if (batch->count == LINE_BATCH_POINTS) {
+        SDL_Point last = batch->points[LINE_BATCH_POINTS - 1];
+        line_batch_flush(batch);
+        batch->points[0] = last;
+        batch->count = 1;
+    }
+}
+
+static inline void line_batch_end(LineBatch* batch) {
+    line_batch_flush(batch);
+}
+
+#endif
@@ -0,0 +1,463 @@
+#ifndef LINERASTER_H
+#define LINERASTER_H
+
+// Multithreaded software line rasterizer for the 3D viewers.
+//
+// Segments come either in homogeneous clip space (after the projection matrix,
+// visible where -w <= x, y <= w and 0 <= z <= w) through line_raster_add_clip(),
+// or in screen pixels with a depth from 0 (near) to 1 (far) through
+// line_raster_add_screen(). Clip-space segments are cut at the near and far
+// planes before the perspective divide, so a line that crosses the near plane
+// keeps its visible part instead of disappearing. Every segment is then clipped
+// to the window and its index appended to the bins of the LINE_RASTER_TILE
+// sized tiles it crosses.
+//
+// Worker threads take tiles from a shared counter and draw each tile's segments,
+// in the order they were added, into a colour and a depth buffer. A fragment is
+// kept unless it lies behind the stored depth, so at equal depth the later
+// segment wins like with SDL's lines. A tile is only touched by the worker that
+// took it, and every pixel is computed from the whole segment, so the image does
+// not depend on the number of threads. When LINE_RASTER_BATCH segments are
+// pending they are drawn before more are accepted, which bounds the memory for
+// curves with millions of segments.
+//
+// line_raster_upload() copies the colour buffer into a streaming texture with one
+// SDL_UpdateTexture call; the caller draws raster->texture. With 'antialias' set,
+// lines are drawn with Xiaolin Wu's algorithm: two pixels per step along the major
+// axis, blended by their coverage.
+//
+// Functions are 'static inline' like perfhud.h.
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include "trace.h"
+
+#define LINE_RASTER_TILE 64
+#define LINE_RASTER_BATCH (1 << 19)
+#define LINE_RASTER_MAX_THREADS 64
+
+typedef struct {
+    float x0, y0, z0;  // Screen pixels and depth
+    float x1, y1, z1;
+    Uint32 color;      // ARGB8888
+} LineRasterSegment;
+
+// Indices of the pending segments that cross one tile
+typedef struct {
+    int* items;
+    int count;
+    int capacity;
+} LineRasterBin;
+
+typedef struct {
+    SDL_Renderer* renderer;
+    SDL_Texture* texture;  // Streaming ARGB8888 texture, NULL until the first begin
+    int width, height;
+    Uint32* color_buffer;
+    float* depth_buffer;
+    int tiles_x, tiles_y;
+    LineRasterBin* bins;   // tiles_x * tiles_y, row by row
+    LineRasterSegment* segments;  // Pending batch
+    int segment_count;
+    Uint32 color;          // Colour of the segments added next
+    Uint32 clear_color;
+    bool clear_pending;    // The next batch clears each tile before drawing into it
+    bool antialias;
+    int thread_count;
+    SDL_atomic_t next_tile;
+    long long segments_drawn;  // Segments (after clipping) since line_raster_begin()
+    double busy_ms;            // Summed worker time since line_raster_begin()
+} LineRaster;
+
+typedef struct {
+    LineRaster* raster;
+    int index;
+    double busy_ms;
+} LineRasterWorker;
+
+static inline void line_raster_init(LineRaster* raster, SDL_Renderer* renderer) {
+    memset(raster, 0, sizeof(*raster));
+    raster->renderer = renderer;
+    raster->color = 0xFFFFFFFFu;
+    raster->clear_color = 0xFF000000u;
+    raster->thread_count = SDL_GetCPUCount();
+    if (raster->thread_count < 1) raster->thread_count = 1;
+    if (raster->thread_count > LINE_RASTER_MAX_THREADS) raster->thread_count = LINE_RASTER_MAX_THREADS;
+}
+
+static inline void line_raster_free_buffers(LineRaster* raster) {
+    if (raster->bins != NULL) {
+        for (int i = 0; i < raster->tiles_x * raster->tiles_y; ++i) {
+            free(raster->bins[i].items);
+        }
+    }
+    free(raster->bins);
+    free(raster->segments);
+    free(raster->color_buffer);
+    free(raster->depth_buffer);
+    if (raster->texture != NULL) {
+        SDL_DestroyTexture(raster->texture);
+    }
+    raster->bins = NULL;
+    raster->segments = NULL;
+    raster->color_buffer = NULL;
+    raster->depth_buffer = NULL;
+    raster->texture = NULL;
+    raster->width = 0;
+    raster->height = 0;
+}
+
+static inline void line_raster_shutdown(LineRaster* raster) {
+    line_raster_free_buffers(raster);
+}
+
+// (Re)allocates the buffers for a width x height target
+static inline bool line_raster_resize(LineRaster* raster, int width, int height) {
+    line_raster_free_buffers(raster);
+    raster->tiles_x = (width + LINE_RASTER_TILE - 1) / LINE_RASTER_TILE;
+    raster->tiles_y = (height + LINE_RASTER_TILE - 1) / LINE_RASTER_TILE;
+    raster->bins = calloc((size_t)raster->tiles_x * raster->tiles_y, sizeof(LineRasterBin));
+    raster->segments = malloc(sizeof(LineRasterSegment) * LINE_RASTER_BATCH);
+    raster->color_buffer = malloc(sizeof(Uint32) * width * height);
+    raster->depth_buffer = malloc(sizeof(float) * width * height);
+    raster->texture = SDL_CreateTexture(raster->renderer, SDL_PIXELFORMAT_ARGB8888,
+                                        SDL_TEXTUREACCESS_STREAMING, width, height);
+    if (raster->bins == NULL || raster->segments == NULL || raster->color_buffer == NULL ||
+        raster->depth_buffer == NULL || raster->texture == NULL) {
+        printf("Failed to allocate a %dx%d line raster.\n", width, height);
+        line_raster_free_buffers(raster);
+        return false;
+    }
+    raster->width = width;
+    raster->height = height;
+    return true;
+}
+
+// Starts a frame that is cleared to 'clear_color'. Returns false if the buffers for
+// this size cannot be allocated.
+static inline bool line_raster_begin(LineRaster* raster, int width, int height, Uint32 clear_color) {
+    if ((raster->width != width || raster->height != height || raster->texture == NULL) &&
+        !line_raster_resize(raster, width, height)) {
+        return false;
+    }
+    raster->clear_color = clear_color;
+    raster->clear_pending = true;
+    raster->segment_count = 0;
+    raster->segments_drawn = 0;
+    raster->busy_ms = 0.0;
+    return true;
+}
+
+static inline void line_raster_set_color(LineRaster* raster, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
+    raster->color = ((Uint32)a << 24) | ((Uint32)r << 16) | ((Uint32)g << 8) | b;
+}
+
+// --- Drawing (worker threads) ---
+// floorf() without the library call that plain x86-64 code needs for it
+static inline int line_raster_floor(float v) {
+    int i = (int)v;
+    return i - (v < (float)i);
+}
+
+// 'alpha' is the coverage times the colour's opacity
+static inline void line_raster_plot(LineRaster* raster, int x, int y, float z, Uint32 color, float alpha) {
+    size_t i = (size_t)y * raster->width + x;
+    if (z > raster->depth_buffer[i]) {
+        return;
+    }
+    if (alpha >= 1.0f) {
+        raster->color_buffer[i] = color | 0xFF000000u;
+        raster->depth_buffer[i] = z;
+        return;
+    }
+
+    Uint32 dst = raster->color_buffer[i];
+    Uint32 result = 0xFF000000u;
+    for (int shift = 0; shift < 24; shift += 8) {
+        float d = (float)((dst >> shift) & 0xFF), s = (float)((color >> shift) & 0xFF);
+        result |= (Uint32)(d + (s - d) * alpha + 0.5f) << shift;
+    }
+    raster->color_buffer[i] = result;
+    if (alpha >= 0.5f) {
+        raster->depth_buffer[i] = z;
+    }
+}
+
+// Draws the part of 'segment' that falls in the pixel rectangle [x_min, x_max) x [y_min, y_max).
+// The major axis is stepped at pixel centres clamped to the segment, so each step
+// covers one pixel column (or row) and the line stays connected.
+static inline void line_raster_draw_segment(LineRaster* raster, const LineRasterSegment* segment,
+                                            int x_min, int x_max, int y_min, int y_max) {
+    float dx = segment->x1 - segment->x0, dy = segment->y1 - segment->y0;
+    bool steep = fabsf(dy) > fabsf(dx);
+    // Major axis 'u', minor axis 'v'
+    float u0 = steep ? segment->y0 : segment->x0, v0 = steep ? segment->x0 : segment->y0;
+    float du = steep ? dy : dx, dv = steep ? dx : dy;
+    int u_min = steep ? y_min : x_min, u_max = steep ? y_max : x_max;
+    int v_min = steep ? x_min : y_min, v_max = steep ? x_max : y_max;
+
+    float start = fminf(u0, u0 + du), end = fmaxf(u0, u0 + du);
+    int first = line_raster_floor(start), last = line_raster_floor(end);
+    if (first < u_min) first = u_min;
+    if (last > u_max - 1) last = u_max - 1;
+    float inverse_du = du != 0.0f ? 1.0f / du : 0.0f;
+    float v_slope = dv * inverse_du, z_slope = (segment->z1 - segment->z0) * inverse_du;
+    float opacity = (float)(segment->color >> 24) / 255.0f;
+
+    for (int u = first; u <= last; ++u) {
+        float c = fminf(fmaxf(u + 0.5f, start), end) - u0;
+        float v = v0 + c * v_slope;
+        float z = segment->z0 + c * z_slope;
+
+        if (!raster->antialias) {
+            int pv = line_raster_floor(v);
+            if (pv >= v_min && pv < v_max) {
+                line_raster_plot(raster, steep ? pv : u, steep ? u : pv, z, segment->color, opacity);
+            }
+            continue;
+        }
+
+        // Share the step between the two pixels whose centres bracket v, weighted by
+        // how much of this column the segment covers (which fades the end points)
+        float overlap = fminf(end, u + 1.0f) - fmaxf(start, (float)u);
+        if (end - start < 1.0f) overlap = 1.0f;  // Segments shorter than a pixel stay visible
+        float f = v - 0.5f;
+        int pv = line_raster_floor(f);
+        float fraction = f - pv;
+        if (pv >= v_min && pv < v_max) {
+            line_raster_plot(raster, steep ? pv : u, steep ? u : pv, z, segment->color, (1.0f - fraction) * overlap * opacity);
+        }
+        if (pv + 1 >= v_min && pv + 1 < v_max) {
+            line_raster_plot(raster, steep ? pv + 1 : u, steep ? u : pv + 1, z, segment->color, fraction * overlap * opacity);
+        }
+    }
+}
+
+static inline void line_raster_draw_tile(LineRaster* raster, int tile) {
+    int x_min = (tile % raster->tiles_x) * LINE_RASTER_TILE;
+    int y_min = (tile / raster->tiles_x) * LINE_RASTER_TILE;
+    int x_max = x_min + LINE_RASTER_TILE < raster->width ? x_min + LINE_RASTER_TILE : raster->width;
+    int y_max = y_min + LINE_RASTER_TILE < raster->height ? y_min + LINE_RASTER_TILE : raster->height;
+
+    if (raster->clear_pending) {
+        for (int y = y_min; y < y_max; ++y) {
+            Uint32* colors = raster->color_buffer + (size_t)y * raster->width;
+            float* depths = raster->depth_buffer + (size_t)y * raster->width;
+            for (int x = x_min; x < x_max; ++x) {
+                colors[x] = raster->clear_color;
+                depths[x] = 1.0f;
+            }
+        }
+    }
+
+    const LineRasterBin* bin = &raster->bins[tile];
+    for (int i = 0; i < bin->count; ++i) {
+        line_raster_draw_segment(raster, &raster->segments[bin->items[i]], x_min, x_max, y_min, y_max);
+    }
+}
+
+static inline int line_raster_worker_thread(void* data) {
+    LineRasterWorker* worker = (LineRasterWorker*)data;
+    LineRaster* raster = worker->raster;
+    Uint64 start = SDL_GetPerformanceCounter();
+    if (worker->index > 0) {
+        char lane_name[32];
+        snprintf(lane_name, sizeof(lane_name), "line raster worker %d", worker->index);
+        trace_set_thread_name(lane_name);
+    }
+
+    int tile_count = raster->tiles_x * raster->tiles_y;
+    for (;;) {
+        int tile = SDL_AtomicAdd(&raster->next_tile, 1);
+        if (tile >= tile_count) {
+            break;
+        }
+        line_raster_draw_tile(raster, tile);
+    }
+
+    Uint64 end = SDL_GetPerformanceCounter();
+    worker->busy_ms = (double)(end - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    trace_record("rasterize tiles", start, end);
+    return 0;
+}
+
+// Draws the pending batch, worker 0 on this thread, and empties the bins
+static inline void line_raster_flush(LineRaster* raster) {
+    if (raster->segment_count == 0 && !raster->clear_pending) {
+        return;
+    }
+
+    LineRasterWorker workers[LINE_RASTER_MAX_THREADS];
+    SDL_Thread* threads[LINE_RASTER_MAX_THREADS];
+    SDL_AtomicSet(&raster->next_tile, 0);
+    for (int t = 0; t < raster->thread_count; ++t) {
+        workers[t] = (LineRasterWorker){raster, t, 0.0};
+    }
+    for (int t = 1; t < raster->thread_count; ++t) {
+        threads[t] = SDL_CreateThread(line_raster_worker_thread, "line raster worker", &workers[t]);
+        if (threads[t] == NULL) {
+            line_raster_worker_thread(&workers[t]);  // Fall back to running it inline
+        }
+    }
+    line_raster_worker_thread(&workers[0]);
+
+    for (int t = 0; t < raster->thread_count; ++t) {
+        if (t > 0 && threads[t] != NULL) {
+            SDL_WaitThread(threads[t], NULL);
+        }
+        raster->busy_ms += workers[t].busy_ms;
+    }
+
+    for (int i = 0; i < raster->tiles_x * raster->tiles_y; ++i) {
+        raster->bins[i].count = 0;
+    }
+    raster->segment_count = 0;
+    raster->clear_pending = false;
+}
+
+// --- Segment Setup ---
+static inline void line_raster_bin_add(LineRasterBin* bin, int index) {
+    if (bin->count == bin->capacity) {
+        int capacity = bin->capacity > 0 ? bin->capacity * 2 : 256;
+        int* items = realloc(bin->items, sizeof(int) * capacity);
+        if (items == NULL) {
+            return;  // The segment is missing from this tile
+        }
+        bin->items = items;
+        bin->capacity = capacity;
+    }
+    bin->items[bin->count++] = index;
+}
+
+// Appends the segment to the bins of every tile within a pixel of it. The tile rows
+// are walked one at a time, so a long diagonal line only lands in the tiles it crosses.
+static inline void line_raster_bin_segment(LineRaster* raster, int index) {
+    const LineRasterSegment* s = &raster->segments[index];
+    const float margin = 1.0f;  // Anti-aliased lines reach into the next pixel
+    float dx = s->x1 - s->x0, dy = s->y1 - s->y0;
+
+    int row_first = line_raster_floor((fminf(s->y0, s->y1) - margin) / LINE_RASTER_TILE);
+    int row_last = line_raster_floor((fmaxf(s->y0, s->y1) + margin) / LINE_RASTER_TILE);
+    if (row_first < 0) row_first = 0;
+    if (row_last > raster->tiles_y - 1) row_last = raster->tiles_y - 1;
+
+    for (int row = row_first; row <= row_last; ++row) {
+        float x_from = fminf(s->x0, s->x1), x_to = fmaxf(s->x0, s->x1);
+        if (fabsf(dy) > 1e-6f) {
+            float t0 = ((float)row * LINE_RASTER_TILE - margin - s->y0) / dy;
+            float t1 = ((float)(row + 1) * LINE_RASTER_TILE + margin - s->y0) / dy;
+            float t_from = fmaxf(fminf(t0, t1), 0.0f), t_to = fminf(fmaxf(t0, t1), 1.0f);
+            if (t_from > t_to) {
+                continue;
+            }
+            x_from = fminf(s->x0 + t_from * dx, s->x0 + t_to * dx);
+            x_to = fmaxf(s->x0 + t_from * dx, s->x0 + t_to * dx);
+        }
+
+        int column_first = line_raster_floor((x_from - margin) / LINE_RASTER_TILE);
+        int column_last = line_raster_floor((x_to + margin) / LINE_RASTER_TILE);
+        if (column_first < 0) column_first = 0;
+        if (column_last > raster->tiles_x - 1) column_last = raster->tiles_x - 1;
+        for (int column = column_first; column <= column_last; ++column) {
+            line_raster_bin_add(&raster->bins[row * raster->tiles_x + column], index);
+        }
+    }
+}
+
+// Adds a segment given in screen pixels, depth 0 (near) to 1 (far). The part outside
+// the window is cut off first (Liang-Barsky), keeping the depth interpolation exact.
+static inline void line_raster_add_screen(LineRaster* raster, double x0, double y0, double z0,
+                                          double x1, double y1, double z1) {
+    if (raster->texture == NULL) {
+        return;
+    }
+    double dx = x1 - x0, dy = y1 - y0;
+    double t_from = 0.0, t_to = 1.0;
+    double p[4] = {-dx, dx, -dy, dy};
+    double q[4] = {x0 + 1.0, raster->width + 1.0 - x0, y0 + 1.0, raster->height + 1.0 - y0};
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0.0) {
+            if (q[i] < 0.0) return;
+        } else {
+            double t = q[i] / p[i];
+            if (p[i] < 0.0) {
+                if (t > t_from) t_from = t;
+            } else if (t < t_to) {
+                t_to = t;
+            }
+        }
+    }
+    if (t_from > t_to) {
+        return;
+    }
+
+    if (raster->segment_count == LINE_RASTER_BATCH) {
+        line_raster_flush(raster);
+    }
+    int index = raster->segment_count++;
+    double dz = z1 - z0;
+    raster->segments[index] = (LineRasterSegment){
+        (float)(x0 + t_from * dx), (float)(y0 + t_from * dy), (float)(z0 + t_from * dz),
+        (float)(x0 + t_to * dx), (float)(y0 + t_to * dy), (float)(z0 + t_to * dz),
+        raster->color};
+    raster->segments_drawn++;
+    line_raster_bin_segment(raster, index);
+}
+
+// Cuts a homogeneous segment to the side of a plane where 'da' / 'db' are not negative
+static inline bool line_raster_clip_plane(double a[4], double b[4], double da, double db) {
+    if (da < 0.0 && db < 0.0) {
+        return false;
+    }
+    if (da < 0.0 || db < 0.0) {
+        double t = da / (da - db);
+        double* moved = da < 0.0 ? a : b;
+        for (int i = 0; i < 4; ++i) {
+            moved[i] = a[i] + t * (b[i] - a[i]);
+        }
+    }
+    return true;
+}
+
+// Adds a segment given in clip space: clipped to 0 <= z <= w, divided by w and mapped
+// to pixels (y pointing down)
+static inline void line_raster_add_clip(LineRaster* raster, double ax, double ay, double az, double aw,
+                                        double bx, double by, double bz, double bw) {
+    double a[4] = {ax, ay, az, aw}, b[4] = {bx, by, bz, bw};
+    if (!line_raster_clip_plane(a, b, a[2], b[2]) ||
+        !line_raster_clip_plane(a, b, a[3] - a[2], b[3] - b[2]) ||
+        a[3] <= 0.0 || b[3] <= 0.0) {
+        return;
+    }
+
+    double half_width = raster->width / 2.0, half_height = raster->height / 2.0;
+    line_raster_add_screen(raster,
+                           a[0] / a[3] * half_width + half_width, -a[1] / a[3] * half_height + half_height, a[2] / a[3],
+                           b[0] / b[3] * half_width + half_width, -b[1] / b[3] * half_height + half_height, b[2] / b[3]);
+}
+
+// Fills a pixel rectangle at one depth, as one segment through the pixel centres of each row
+static inline void line_raster_fill_rect(LineRaster* raster, int x, int y, int w, int h, double z) {
+    for (int row = y; row < y + h; ++row) {
+        line_raster_add_screen(raster, x + 0.5, row + 0.5, z, x + w - 0.5, row + 0.5, z);
+    }
+}
+
+// Draws what is still pending
+static inline void line_raster_end(LineRaster* raster) {
+    if (raster->texture != NULL) {
+        line_raster_flush(raster);
+    }
+}
+
+static inline void line_raster_upload(LineRaster* raster) {
+    if (raster->texture != NULL) {
+        SDL_UpdateTexture(raster->texture, NULL, raster->color_buffer, raster->width * (int)sizeof(Uint32));
+    }
+}
+
+#endif
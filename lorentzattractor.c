@@ -4,6 +4,9 @@
 #include <math.h>
 #include <SDL2/SDL_ttf.h>
 #include <stdlib.h>
+#include "perfhud.h"
+#include "linebatch.h"
+#include "lineraster.h"
 
 // Window dimensions
 #define WIDTH 800
@@ -42,6 +45,10 @@ int g_last_mouse_x, g_last_mouse_y;
 
 SDL_Texture* g_lorentz_texture = NULL;
 SDL_Renderer* g_renderer = NULL;
+LineBatch g_line_batch;
+LineRaster g_line_raster;
+bool g_software_lines = true;  // Draw with lineraster.h instead of SDL's lines
+bool g_antialias_lines = false;
 
 // --- Function to compute the derivatives ---
 Vec3D lorentz_deriv(Vec3D current_state) {
@@ -139,6 +146,36 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename) {
     SDL_FreeSurface(screenshot);
 }
 
+// Draws the stored trajectory with lineraster.h and copies it to the current render
+// target. Returns the number of segments, or -1 if the rasterizer is unavailable.
+long long drawLorentzSoftware() {
+    if (!line_raster_begin(&g_line_raster, WIDTH, HEIGHT, 0xFF000000u)) {
+        g_software_lines = false;  // Out of memory; fall back to SDL's lines
+        return -1;
+    }
+    g_line_raster.antialias = g_antialias_lines;
+    line_raster_set_color(&g_line_raster, 255, 255, 255, 255);
+
+    // map_lorentz_to_pixel() without the rounding, so anti-aliasing sees the exact positions
+    long long lines_drawn = 0;
+    double prev_x = 0.0, prev_y = 0.0;
+    for (int i = 0; i < g_num_current_lorentz_points; ++i) {
+        double x = WIDTH / 2.0 + (g_lorentz_points[i].x - view_x_center) * view_scale;
+        double y = HEIGHT / 2.0 - (g_lorentz_points[i].y - view_y_center) * view_scale;
+        if (i > 0 && fabs(x - prev_x) < WIDTH * 2 && fabs(y - prev_y) < HEIGHT * 2) {
+            line_raster_add_screen(&g_line_raster, prev_x, prev_y, 0.0, x, y, 0.0);
+            lines_drawn++;
+        }
+        prev_x = x;
+        prev_y = y;
+    }
+    line_raster_end(&g_line_raster);
+    line_raster_upload(&g_line_raster);
+    SDL_RenderCopy(g_renderer, g_line_raster.texture, NULL, NULL);
+    perf_add_thread_time(g_line_raster.thread_count, g_line_raster.busy_ms);
+    return lines_drawn;
+}
+
 // Function to calculate and render the entire Lorentz attractor trajectory to g_lorentz_texture
 void calculateAndRenderAttractorToTexture() {
     if (!g_renderer || !g_lorentz_texture) {
@@ -147,6 +184,11 @@ void calculateAndRenderAttractorToTexture() {
     }
 
     printf("Calculating and rendering Lorentz Attractor to texture...\n");
+    char view[160];
+    snprintf(view, sizeof(view), "sigma=%.2f rho=%.2f dt=%.4f scale=%.2f center=(%.2f,%.2f)",
+             sigma, rho, dt, view_scale, view_x_center, view_y_center);
+    perf_set_view(view);
+    perf_begin(PERF_COMPUTE);
 
     SDL_SetRenderTarget(g_renderer, g_lorentz_texture);
     SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 0);
@@ -163,6 +205,7 @@ void calculateAndRenderAttractorToTexture() {
         g_lorentz_points = (LorentzPoint*)malloc(MAX_LORENTZ_POINTS * sizeof(LorentzPoint));
         if (g_lorentz_points == NULL) {
             fprintf(stderr, "Failed to allocate memory for Lorentz points!\n");
+            perf_end(PERF_COMPUTE);
             return;
         }
     }
@@ -183,7 +226,11 @@ void calculateAndRenderAttractorToTexture() {
         rk4_step_for_point(&current_x, &current_y, &current_z, dt);
     }
 
-    if (g_num_current_lorentz_points > 1) {
+    long long lines_drawn = g_software_lines ? drawLorentzSoftware() : -1;
+    bool sdl_lines = lines_drawn < 0;
+    if (sdl_lines) lines_drawn = 0;
+    line_batch_begin(&g_line_batch, g_renderer);
+    if (sdl_lines && g_num_current_lorentz_points > 1) {
         int prev_px, prev_py;
         map_lorentz_to_pixel(g_lorentz_points[0].x, g_lorentz_points[0].y, &prev_px, &prev_py);
 
@@ -192,14 +239,19 @@ void calculateAndRenderAttractorToTexture() {
             map_lorentz_to_pixel(g_lorentz_points[i].x, g_lorentz_points[i].y, &current_px, &current_py);
 
             if (fabs(current_px - prev_px) < WIDTH * 2 && fabs(current_py - prev_py) < HEIGHT * 2) {
-                 SDL_RenderDrawLine(g_renderer, prev_px, prev_py, current_px, current_py);
+                 line_batch_add(&g_line_batch, prev_px, prev_py, current_px, current_py);
+                 lines_drawn++;
             }
 
             prev_px = current_px;
             prev_py = current_py;
         }
     }
+    line_batch_end(&g_line_batch);
     SDL_SetRenderTarget(g_renderer, NULL);
+    perf_end(PERF_COMPUTE);
+    perf_add_iterations(warmup_steps + MAX_LORENTZ_POINTS);
+    perf_add_pixels(lines_drawn);
     printf("Lorentz Attractor rendering to texture complete. Points: %d\n", g_num_current_lorentz_points);
 }
 
@@ -219,7 +271,9 @@ void reset_lorentz_view_and_params() {
     calculateAndRenderAttractorToTexture();
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    perf_init(argc, argv);
+
     printf("Lorentz Attractor Viewer\n");
     printf("Left Click + Drag: Pan the view\n");
     printf("Mouse Wheel: Zoom in/out (centered on mouse cursor)\n");
@@ -227,6 +281,7 @@ int main() {
     printf("Left/Right Arrows: Adjust 'sigma' parameter\n");
     printf("+/-: Adjust 'dt' (time step)\n");
     printf("R: Reset view and parameters\n");
+    printf("F1: Toggle performance HUD\n");
     printf("Click 'Save' button to save an image.\n");
 
     // Set SDL hint for Wayland if you're on a Wayland desktop
@@ -268,6 +323,7 @@ int main() {
         return 1;
     }
     SDL_SetRenderDrawBlendMode(g_renderer, SDL_BLENDMODE_BLEND);
+    line_raster_init(&g_line_raster, g_renderer);
 
     TTF_Font* font = TTF_OpenFont("/usr/share/fonts/truetype/dejavu/DejaVuSans-Bold.ttf", 16);
     if (font == NULL) {
@@ -301,6 +357,7 @@ int main() {
         bool re_render_attractor = false;
 
         while (SDL_PollEvent(&event)){
+            if (perf_handle_event(&event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
@@ -315,7 +372,9 @@ int main() {
                             mouseX <= screenshotButtonRect.x + screenshotButtonRect.w &&
                             mouseY >= screenshotButtonRect.y &&
                             mouseY <= screenshotButtonRect.y + screenshotButtonRect.h) {
+                            Uint64 trace_start = trace_begin();
                             saveScreenshot(g_renderer, "lorentz_attractor_screenshot.bmp");
+                            trace_end("screenshot", trace_start);
                         } else if (event.button.button == SDL_BUTTON_LEFT) {
                             g_is_panning = true;
                             g_last_mouse_x = mouseX;
@@ -393,6 +452,12 @@ int main() {
                         sigma += 0.5;
                         printf("Sigma increased to: %.2f\n", sigma);
                         re_render_attractor = true;
+                    } else if (event.key.keysym.sym == SDLK_b) {
+                        g_software_lines = !g_software_lines;
+                        re_render_attractor = true;
+                    } else if (event.key.keysym.sym == SDLK_l) {
+                        g_antialias_lines = !g_antialias_lines;
+                        re_render_attractor = true;
                     } else if (event.key.keysym.sym == SDLK_EQUALS) {
                         dt *= 1.1;
                         printf("dt increased to: %.4f\n", dt);
@@ -414,8 +479,11 @@ int main() {
         // --- Rendering ---
         SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 255);
         SDL_RenderClear(g_renderer);
+        perf_begin(PERF_DRAW);
         SDL_RenderCopy(g_renderer, g_lorentz_texture, NULL, NULL);
+        perf_end(PERF_DRAW);
 
+        perf_begin(PERF_TEXT);
         if (font != NULL) {
             char text_buffer[200];
             SDL_Color textColor = {255, 255, 255, 255};
@@ -433,6 +501,7 @@ int main() {
             renderText(g_renderer, font, text_buffer, 10, 70, textColor);
 
 
+            renderText(g_renderer, font, "B: Software/SDL Lines, L: Anti-Aliasing", 10, HEIGHT - 80, textColor);
             renderText(g_renderer, font, "Left Drag: Pan, Wheel: Zoom, Arrows: Params", 10, HEIGHT - 50, textColor);
             renderText(g_renderer, font, "R: Reset, +/-: dt", 10, HEIGHT - 20, textColor);
 
@@ -446,11 +515,18 @@ int main() {
             SDL_Color buttonTextColor = {255, 255, 255, 255};
             renderText(g_renderer, font, "Save", screenshotButtonRect.x + 8, screenshotButtonRect.y + 5, buttonTextColor);
         }
+        perf_end(PERF_TEXT);
+        perf_draw_hud(g_renderer, font);
 
+        perf_begin(PERF_PRESENT);
         SDL_RenderPresent(g_renderer);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
     }
 
     // --- Cleanup ---
+    perf_shutdown();
+    line_raster_shutdown(&g_line_raster);
     if (g_lorentz_points != NULL) {
         free(g_lorentz_points);
         g_lorentz_points = NULL;
@@ -4,6 +4,9 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
+#include "tileexport.h"
+#include "golden.h"
+#include "perfhud.h"
 
 #define WIDTH 800
 #define HEIGHT 800
@@ -13,6 +16,7 @@
 double g_r_min = 3.81;
 double g_r_max = 3.87;
 const char *pattern = "AB";
+int g_lyapunov_iterations = MAX_ITER; // Overridable by --iterations when exporting
 
 SDL_Color getColor(double lambda) {
     SDL_Color color;
@@ -34,30 +38,69 @@ SDL_Color getColor(double lambda) {
     return color;
 }
 
-double lyapunov(double ra, double rb) {
+// Lyapunov exponent at (ra, rb); the number of iterations actually run goes to 'iterations'
+double lyapunovExponent(double ra, double rb, int* iterations) {
     double x = 0.5;
     double lyap = 0.0;
     int len = strlen(pattern);
-    for (int i = 0; i < MAX_ITER; i++) {
+    for (int i = 0; i < g_lyapunov_iterations; i++) {
         double r = pattern[i % len] == 'A' ? ra : rb;
         x = r * x * (1.0 - x);
-        if (x <= 0.0 || x >= 1.0) return 1.0;
+        if (x <= 0.0 || x >= 1.0) {
+            *iterations = i + 1;
+            return 1.0;
+        }
         lyap += log(fabs(r * (1.0 - 2.0 * x)));
     }
-    return lyap / MAX_ITER;
+    *iterations = g_lyapunov_iterations;
+    return lyap / g_lyapunov_iterations;
+}
+
+double lyapunov(double ra, double rb) {
+    int iterations;
+    return lyapunovExponent(ra, rb, &iterations);
+}
+
+// ARGB colour at (ra, rb), used by the strip exporter
+uint32_t lyapunovPixel(double ra, double rb) {
+    SDL_Color c = getColor(lyapunov(ra, rb));
+    return (c.a << 24) | (c.r << 16) | (c.g << 8) | c.b;
+}
+
+// Lyapunov exponent at (ra, rb) in millionths, so the golden checksum pins it to 6 decimals
+int lyapunovGoldenSample(double ra, double rb, int max_iterations) {
+    g_lyapunov_iterations = max_iterations;
+    return (int)lround(lyapunov(ra, rb) * 1e6);
 }
 
+// Fixed views pinned by 'make golden' (name, x_min, x_max, y_min, y_max, iterations)
+const GoldenView g_golden_views[] = {
+    {"swallow", 3.81, 3.87, 3.81, 3.87, 1000},
+    {"full", 2.0, 4.0, 2.0, 4.0, 200},
+};
+
 void renderFractal(SDL_Renderer *renderer) {
+    char view[160];
+    snprintf(view, sizeof(view), "R:[%.10g, %.10g] pattern=%s it=%d", g_r_min, g_r_max, pattern, g_lyapunov_iterations);
+    perf_set_view(view);
+    perf_begin(PERF_COMPUTE);
+    long long total_iterations = 0;
+
     for (int px = 0; px < WIDTH; px++) {
         for (int py = 0; py < HEIGHT; py++) {
             double ra = g_r_min + (g_r_max - g_r_min) * px / WIDTH;
             double rb = g_r_min + (g_r_max - g_r_min) * py / HEIGHT;
-            double lambda = lyapunov(ra, rb);
+            int iterations;
+            double lambda = lyapunovExponent(ra, rb, &iterations);
+            total_iterations += iterations;
             SDL_Color c = getColor(lambda);
             SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
             SDL_RenderDrawPoint(renderer, px, py);
         }
     }
+    perf_end(PERF_COMPUTE);
+    perf_add_iterations(total_iterations);
+    perf_add_pixels((long long)WIDTH * HEIGHT);
 }
 
 void renderText(SDL_Renderer *renderer, TTF_Font *font, const char *text, int x, int y, SDL_Color color) {
@@ -79,7 +122,25 @@ void saveScreenshot(SDL_Renderer *renderer, const char *filename) {
     printf("Screenshot saved to %s\n", filename);
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+    // Golden-image regression check: render the fixed views headlessly and compare
+    GoldenOptions golden_options;
+    int golden_status = golden_parse_args(argc, argv, &golden_options);
+    if (golden_status != 0) {
+        if (golden_status < 0) return 1;
+        return golden_run(&golden_options, "lyapunov", g_golden_views, GOLDEN_VIEW_COUNT(g_golden_views), lyapunovGoldenSample);
+    }
+
+    // Headless poster export: render straight to disk without opening a window
+    ExportJob export_job = export_default_job(g_r_min, g_r_max, g_r_min, g_r_max, g_lyapunov_iterations);
+    int export_status = export_parse_args(argc, argv, &export_job);
+    if (export_status != 0) {
+        if (export_status < 0) return 1;
+        g_lyapunov_iterations = export_job.max_iterations;
+        return export_run(&export_job, lyapunovPixel);
+    }
+    perf_init(argc, argv);
+
     SDL_Init(SDL_INIT_VIDEO);
     TTF_Init();
 
@@ -98,6 +159,10 @@ int main() {
 
     while (running) {
         while (SDL_PollEvent(&e)) {
+            if (perf_handle_event(&e)) {
+                needs_redraw = true;
+                continue;
+            }
             switch (e.type) {
                 case SDL_QUIT:
                     running = false;
@@ -109,7 +174,9 @@ int main() {
                     if (x >= screenshotBtn.x && x <= screenshotBtn.x + screenshotBtn.w &&
                         y >= screenshotBtn.y && y <= screenshotBtn.y + screenshotBtn.h &&
                         e.button.button == SDL_BUTTON_LEFT) {
+                        Uint64 trace_start = trace_begin();
                         saveScreenshot(renderer, "lyapunov_swallow.bmp");
+                        trace_end("screenshot", trace_start);
                     } else {
                         double r_click = g_r_min + (g_r_max - g_r_min) * x / WIDTH;
                         double range = g_r_max - g_r_min;
@@ -140,6 +207,7 @@ int main() {
             renderFractal(renderer);
 
             // Overlay: Screenshot button
+            perf_begin(PERF_TEXT);
             SDL_Color white = {255, 255, 255, 255};
             SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);
             SDL_RenderFillRect(renderer, &screenshotBtn);
@@ -153,14 +221,20 @@ int main() {
             renderText(renderer, font, buf, 10, 10, white);
             snprintf(buf, sizeof(buf), "Pattern: %s", pattern);
             renderText(renderer, font, buf, 10, 30, white);
+            perf_end(PERF_TEXT);
+            perf_draw_hud(renderer, font);
 
+            perf_begin(PERF_PRESENT);
             SDL_RenderPresent(renderer);
+            perf_end(PERF_PRESENT);
+            perf_frame_end();
             needs_redraw = false;
         }
 
         SDL_Delay(10);
     }
 
+    perf_shutdown();
     TTF_CloseFont(font);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(win);
@@ -4,6 +4,10 @@
 #include <math.h>
 #include <SDL2/SDL_ttf.h>
 #include <string.h>
+#include "tileexport.h"
+#include "golden.h"
+#include "adaptiveaa.h"
+#include "perfhud.h"
 
 #define WIDTH 800
 #define HEIGHT 800
@@ -15,6 +19,10 @@ double g_imag_min = -1.5;
 double g_imag_max = 1.5;
 int g_current_max_iterations = 100;
 
+// Iteration counts of the last frame, used to find the pixels that need anti-aliasing
+int g_iteration_buffer[WIDTH * HEIGHT];
+AASettings g_aa_settings;
+
 // Function to map iterations to a color
 SDL_Color getColor(int iterations, int current_max_iterations_limit) {
     SDL_Color color;
@@ -87,6 +95,42 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename) {
     SDL_FreeSurface(screenshot);
 }
 
+// Returns the number of iterations before the orbit of c = cr + i*ci escapes
+int mandelbrotIterations(double cr, double ci, int max_iterations) {
+    double zr = 0.0;
+    double zi = 0.0;
+    int iterations = 0;
+
+    // Mandelbrot iteration: z_n+1 = z_n^2 + c
+    // Keep iterating as long as the magnitude of Z squared is less than 4.0
+    while ((zr * zr + zi * zi < 4.0) && (iterations < max_iterations)) {
+        double temp_zr = zr * zr - zi * zi + cr; // New real part
+        zi = 2.0 * zr * zi + ci;                 // New imaginary part
+        zr = temp_zr;
+        iterations++;
+    }
+    return iterations;
+}
+
+// ARGB colour of a single point and its iteration count, used by the anti-aliasing pass
+uint32_t mandelbrotSample(double cr, double ci, int* iterations) {
+    *iterations = mandelbrotIterations(cr, ci, g_current_max_iterations);
+    SDL_Color color = getColor(*iterations, g_current_max_iterations);
+    return (color.a << 24) | (color.r << 16) | (color.g << 8) | color.b;
+}
+
+// ARGB colour of a single point, used by the strip exporter
+uint32_t mandelbrotPixel(double cr, double ci) {
+    int iterations;
+    return mandelbrotSample(cr, ci, &iterations);
+}
+
+// Fixed views pinned by 'make golden' (name, x_min, x_max, y_min, y_max, iterations)
+const GoldenView g_golden_views[] = {
+    {"full", -2.0, 1.0, -1.125, 1.125, 100},
+    {"seahorse", -0.756, -0.736, 0.095, 0.11, 500},
+    {"spiral", -0.7455, -0.7453, 0.11295, 0.1131, 2000},
+};
 
 void calculateAndRenderMandelbrot(SDL_Renderer* renderer, SDL_Texture* texture, uint32_t* pixels) {
     printf("Calculating Mandelbrot for view: R:[%f, %f], I:[%f, %f], Iterations: %d\n",
@@ -94,24 +138,22 @@ void calculateAndRenderMandelbrot(SDL_Renderer* renderer, SDL_Texture* texture,
 
     double complex_width = g_real_max - g_real_min;
     double complex_height = g_imag_max - g_imag_min;
+    long long total_iterations = 0;
+
+    char view[160];
+    snprintf(view, sizeof(view), "R:[%.10g, %.10g] I:[%.10g, %.10g] it=%d",
+             g_real_min, g_real_max, g_imag_min, g_imag_max, g_current_max_iterations);
+    perf_set_view(view);
+    perf_begin(PERF_COMPUTE);
 
     for (int y = 0; y < HEIGHT; y++) {
         for (int x = 0; x < WIDTH; x++) {
             double cr = g_real_min + (x / (double)WIDTH) * complex_width;
             double ci = g_imag_min + (y / (double)HEIGHT) * complex_height;
 
-            double zr = 0.0;
-            double zi = 0.0;
-            int iterations = 0;
-
-            // Mandelbrot iteration: z_n+1 = z_n^2 + c
-            // Keep iterating as long as the magnitude of Z squared is less than 4.0
-            while ((zr * zr + zi * zi < 4.0) && (iterations < g_current_max_iterations)) {
-                double temp_zr = zr * zr - zi * zi + cr; // New real part
-                zi = 2.0 * zr * zi + ci;                 // New imaginary part
-                zr = temp_zr;
-                iterations++;
-            }
+            int iterations = mandelbrotIterations(cr, ci, g_current_max_iterations);
+            g_iteration_buffer[y * WIDTH + x] = iterations;
+            total_iterations += iterations;
 
             // Get the color for the current pixel based on iterations and the dynamic limit
             SDL_Color pixel_color = getColor(iterations, g_current_max_iterations);
@@ -123,18 +165,59 @@ void calculateAndRenderMandelbrot(SDL_Renderer* renderer, SDL_Texture* texture,
                                      (pixel_color.b);
         }
     }
+
+    // Add jittered sub-samples only where neighbouring iteration counts jump
+    long long aa_samples = 0;
+    if (g_aa_settings.enabled) {
+        Uint64 trace_start = trace_begin();
+        aa_refine(&g_aa_settings, pixels, g_iteration_buffer, WIDTH, HEIGHT, g_real_min, g_imag_min,
+                  complex_width / WIDTH, complex_height / HEIGHT, mandelbrotSample);
+        trace_end("aa_refine", trace_start);
+        printf("Anti-aliasing: refined %d pixels with %d extra samples.\n",
+               g_aa_settings.refined_pixels, g_aa_settings.samples_taken);
+        aa_samples = g_aa_settings.samples_taken;
+        total_iterations += g_aa_settings.iterations;
+    }
+    perf_end(PERF_COMPUTE);
+    perf_add_iterations(total_iterations);
+    perf_add_pixels((long long)WIDTH * HEIGHT + aa_samples);
+
     // Update the SDL texture with the new pixel data
+    perf_begin(PERF_UPLOAD);
     SDL_UpdateTexture(texture, NULL, pixels, WIDTH * sizeof(uint32_t));
+    perf_end(PERF_UPLOAD);
     printf("Mandelbrot calculation complete.\n");
 }
 
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Golden-image regression check: render the fixed views headlessly and compare
+    GoldenOptions golden_options;
+    int golden_status = golden_parse_args(argc, argv, &golden_options);
+    if (golden_status != 0) {
+        if (golden_status < 0) return 1;
+        return golden_run(&golden_options, "mandelbrot", g_golden_views, GOLDEN_VIEW_COUNT(g_golden_views), mandelbrotIterations);
+    }
+
+    // Headless poster export: render straight to disk without opening a window
+    ExportJob export_job = export_default_job(g_real_min, g_real_max, g_imag_min, g_imag_max, g_current_max_iterations);
+    int export_status = export_parse_args(argc, argv, &export_job);
+    if (export_status != 0) {
+        if (export_status < 0) return 1;
+        g_current_max_iterations = export_job.max_iterations;
+        return export_run(&export_job, mandelbrotPixel);
+    }
+    perf_init(argc, argv);
+
     printf("Left click to zoom in.\n");
     printf("Right click to zoom out.\n");
     printf("Press 'R' to reset view.\n");
+    printf("Press 'A' to toggle adaptive anti-aliasing, '[' / ']' to halve / double its sample budget.\n");
+    printf("Press 'F1' to toggle the performance HUD.\n");
     printf("Click 'Screenshot' button in top-right to save an image.\n");
 
+    g_aa_settings = aa_default_settings();
+
     SDL_SetHint(SDL_HINT_RENDER_DRIVER, "wayland");
 
     // Initialize SDL's video subsystem
@@ -212,6 +295,7 @@ int main() {
 
     while (application_running) {
         while (SDL_PollEvent(&event)){
+            if (perf_handle_event(&event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
@@ -223,7 +307,9 @@ int main() {
                         event.button.x <= screenshotButtonRect.x + screenshotButtonRect.w &&
                         event.button.y >= screenshotButtonRect.y &&
                         event.button.y <= screenshotButtonRect.y + screenshotButtonRect.h) {
+                        Uint64 trace_start = trace_begin();
                         saveScreenshot(renderer, "mandelbrot_screenshot.bmp");
+                        trace_end("screenshot", trace_start);
                     } else {
                         // Handle Mandelbrot zooming
                         int mouseX = event.button.x;
@@ -271,6 +357,15 @@ int main() {
                         g_imag_max = 1.5;
                         g_current_max_iterations = 100;
                         calculateAndRenderMandelbrot(renderer, mandelbrotTexture, pixels);
+                    } else if (event.key.keysym.sym == SDLK_a) {
+                        g_aa_settings.enabled = !g_aa_settings.enabled;
+                        calculateAndRenderMandelbrot(renderer, mandelbrotTexture, pixels);
+                    } else if (event.key.keysym.sym == SDLK_LEFTBRACKET) {
+                        g_aa_settings.sample_budget = fmax(AA_MIN_SAMPLES, g_aa_settings.sample_budget / 2);
+                        calculateAndRenderMandelbrot(renderer, mandelbrotTexture, pixels);
+                    } else if (event.key.keysym.sym == SDLK_RIGHTBRACKET) {
+                        g_aa_settings.sample_budget = fmin(16 * WIDTH * HEIGHT, g_aa_settings.sample_budget * 2.0);
+                        calculateAndRenderMandelbrot(renderer, mandelbrotTexture, pixels);
                     }
                     break;
             }
@@ -279,9 +374,12 @@ int main() {
         // --- Rendering ---
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
+        perf_begin(PERF_DRAW);
         SDL_RenderCopy(renderer, mandelbrotTexture, NULL, NULL);
+        perf_end(PERF_DRAW);
 
         // Render text overlays
+        perf_begin(PERF_TEXT);
         if (font != NULL) {
             char text_buffer[200];
             SDL_Color textColor = {255, 255, 255, 255};
@@ -296,6 +394,15 @@ int main() {
             snprintf(text_buffer, sizeof(text_buffer), "Imag: [%.5f, %.5f]", g_imag_min, g_imag_max);
             renderText(renderer, font, text_buffer, 10, 50, textColor);
 
+            // Display anti-aliasing state
+            if (g_aa_settings.enabled) {
+                snprintf(text_buffer, sizeof(text_buffer), "AA: %d px refined, budget %d samples",
+                         g_aa_settings.refined_pixels, g_aa_settings.sample_budget);
+            } else {
+                snprintf(text_buffer, sizeof(text_buffer), "AA: off");
+            }
+            renderText(renderer, font, text_buffer, 10, 70, textColor);
+
 
             // Draw and render text for the screenshot button
             SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);
@@ -306,11 +413,17 @@ int main() {
             SDL_Color buttonTextColor = {255, 255, 255, 255};
             renderText(renderer, font, "Save", screenshotButtonRect.x + 8, screenshotButtonRect.y + 7, buttonTextColor);
         }
+        perf_end(PERF_TEXT);
+        perf_draw_hud(renderer, font);
 
+        perf_begin(PERF_PRESENT);
         SDL_RenderPresent(renderer);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
     }
 
     // --- Cleanup ---
+    perf_shutdown();
     SDL_DestroyTexture(mandelbrotTexture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(pwindow);
@@ -5,6 +5,9 @@
 #include <complex.h>
 #include <SDL2/SDL_ttf.h>
 #include <string.h>
+#include "tileexport.h"
+#include "golden.h"
+#include "perfhud.h"
 
 #define WIDTH 800
 #define HEIGHT 800
@@ -120,6 +123,61 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename) {
     SDL_FreeSurface(screenshot);
 }
 
+// Runs Newton-Raphson from z, returning the iteration count and the converged root (-1 if none)
+int newtonIterations(complex double z, int max_iterations, int* root_index) {
+    int iterations = 0;
+    *root_index = -1; // -1 indicates no convergence
+
+    // Newton-Raphson iteration: z_n+1 = z_n - f(z_n) / f'(z_n)
+    while (iterations < max_iterations) {
+        complex double f_val = f(z);
+        complex double f_prime_val = f_prime(z);
+
+        // Avoid division by zero or very small derivative
+        if (cabs(f_prime_val) < 1e-6) {
+            break;
+        }
+
+        z = z - f_val / f_prime_val;
+        iterations++;
+
+        // Check for convergence to a root
+        if (cabs(z - ROOT1) < CONVERGENCE_THRESHOLD) {
+            *root_index = 0;
+            break;
+        }
+        if (cabs(z - ROOT2) < CONVERGENCE_THRESHOLD) {
+            *root_index = 1;
+            break;
+        }
+        if (cabs(z - ROOT3) < CONVERGENCE_THRESHOLD) {
+            *root_index = 2;
+            break;
+        }
+    }
+    return iterations;
+}
+
+// ARGB colour of a single point, used by the strip exporter
+uint32_t newtonPixel(double re, double im) {
+    int root_index;
+    int iterations = newtonIterations(re + im * I, g_current_max_iterations, &root_index);
+    SDL_Color color = getColor(iterations, root_index, g_current_max_iterations);
+    return (color.a << 24) | (color.r << 16) | (color.g << 8) | color.b;
+}
+
+// Iteration count and converged root folded into one value for the golden checksum
+int newtonGoldenSample(double re, double im, int max_iterations) {
+    int root_index;
+    int iterations = newtonIterations(re + im * I, max_iterations, &root_index);
+    return iterations * 4 + root_index + 1;
+}
+
+// Fixed views pinned by 'make golden' (name, x_min, x_max, y_min, y_max, iterations)
+const GoldenView g_golden_views[] = {
+    {"full", -2.0, 2.0, -1.5, 1.5, 50},
+    {"center", -0.2, 0.2, -0.15, 0.15, 100},
+};
 
 void calculateAndRenderNewton(SDL_Renderer* renderer, SDL_Texture* texture, uint32_t* pixels) {
     printf("Calculating Newton Fractal for view: R:[%f, %f], I:[%f, %f], Iterations: %d\n",
@@ -127,6 +185,13 @@ void calculateAndRenderNewton(SDL_Renderer* renderer, SDL_Texture* texture, uint
 
     double complex_width = g_real_max - g_real_min;
     double complex_height = g_imag_max - g_imag_min;
+    long long total_iterations = 0;
+
+    char view[160];
+    snprintf(view, sizeof(view), "R:[%.10g, %.10g] I:[%.10g, %.10g] it=%d",
+             g_real_min, g_real_max, g_imag_min, g_imag_max, g_current_max_iterations);
+    perf_set_view(view);
+    perf_begin(PERF_COMPUTE);
 
     for (int y = 0; y < HEIGHT; y++) {
         for (int x = 0; x < WIDTH; x++) {
@@ -134,36 +199,9 @@ void calculateAndRenderNewton(SDL_Renderer* renderer, SDL_Texture* texture, uint
             complex double z = g_real_min + (x / (double)WIDTH) * complex_width +
                                (g_imag_min + (y / (double)HEIGHT) * complex_height) * I;
 
-            int iterations = 0;
-            int root_index = -1; // -1 indicates no convergence
-
-            // Newton-Raphson iteration: z_n+1 = z_n - f(z_n) / f'(z_n)
-            while (iterations < g_current_max_iterations) {
-                complex double f_val = f(z);
-                complex double f_prime_val = f_prime(z);
-
-                // Avoid division by zero or very small derivative
-                if (cabs(f_prime_val) < 1e-6) {
-                    break;
-                }
-
-                z = z - f_val / f_prime_val;
-                iterations++;
-
-                // Check for convergence to a root
-                if (cabs(z - ROOT1) < CONVERGENCE_THRESHOLD) {
-                    root_index = 0;
-                    break;
-                }
-                if (cabs(z - ROOT2) < CONVERGENCE_THRESHOLD) {
-                    root_index = 1;
-                    break;
-                }
-                if (cabs(z - ROOT3) < CONVERGENCE_THRESHOLD) {
-                    root_index = 2;
-                    break;
-                }
-            }
+            int root_index;
+            int iterations = newtonIterations(z, g_current_max_iterations, &root_index);
+            total_iterations += iterations;
 
             // Get the color for the current pixel
             SDL_Color pixel_color = getColor(iterations, root_index, g_current_max_iterations);
@@ -175,16 +213,41 @@ void calculateAndRenderNewton(SDL_Renderer* renderer, SDL_Texture* texture, uint
                                      (pixel_color.b);
         }
     }
+    perf_end(PERF_COMPUTE);
+    perf_add_iterations(total_iterations);
+    perf_add_pixels((long long)WIDTH * HEIGHT);
+
+    perf_begin(PERF_UPLOAD);
     SDL_UpdateTexture(texture, NULL, pixels, WIDTH * sizeof(uint32_t));
+    perf_end(PERF_UPLOAD);
     printf("Newton Fractal calculation complete.\n");
 }
 
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Golden-image regression check: render the fixed views headlessly and compare
+    GoldenOptions golden_options;
+    int golden_status = golden_parse_args(argc, argv, &golden_options);
+    if (golden_status != 0) {
+        if (golden_status < 0) return 1;
+        return golden_run(&golden_options, "newton", g_golden_views, GOLDEN_VIEW_COUNT(g_golden_views), newtonGoldenSample);
+    }
+
+    // Headless poster export: render straight to disk without opening a window
+    ExportJob export_job = export_default_job(g_real_min, g_real_max, g_imag_min, g_imag_max, g_current_max_iterations);
+    int export_status = export_parse_args(argc, argv, &export_job);
+    if (export_status != 0) {
+        if (export_status < 0) return 1;
+        g_current_max_iterations = export_job.max_iterations;
+        return export_run(&export_job, newtonPixel);
+    }
+    perf_init(argc, argv);
+
     printf("Newton Fractal Viewer (z^3 - 1 = 0)\n");
     printf("Left click to zoom in.\n");
     printf("Right click to zoom out.\n");
     printf("Press 'R' to reset view.\n");
+    printf("Press 'F1' to toggle the performance HUD.\n");
     printf("Click 'Screenshot' button in top-right to save an image.\n");
 
     SDL_SetHint(SDL_HINT_RENDER_DRIVER, "wayland");
@@ -264,6 +327,7 @@ int main() {
 
     while (application_running) {
         while (SDL_PollEvent(&event)){
+            if (perf_handle_event(&event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
@@ -275,7 +339,9 @@ int main() {
                         event.button.x <= screenshotButtonRect.x + screenshotButtonRect.w &&
                         event.button.y >= screenshotButtonRect.y &&
                         event.button.y <= screenshotButtonRect.y + screenshotButtonRect.h) {
+                        Uint64 trace_start = trace_begin();
                         saveScreenshot(renderer, "newton_screenshot.bmp");
+                        trace_end("screenshot", trace_start);
                     } else {
                         // Handle Newton fractal zooming
                         int mouseX = event.button.x;
@@ -332,9 +398,12 @@ int main() {
         // --- Rendering ---
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
+        perf_begin(PERF_DRAW);
         SDL_RenderCopy(renderer, fractalTexture, NULL, NULL);
+        perf_end(PERF_DRAW);
 
         // Render text overlays
+        perf_begin(PERF_TEXT);
         if (font != NULL) {
             char text_buffer[200];
             SDL_Color textColor = {255, 255, 255, 255};
@@ -359,11 +428,17 @@ int main() {
             SDL_Color buttonTextColor = {255, 255, 255, 255};
             renderText(renderer, font, "Save", screenshotButtonRect.x + 8, screenshotButtonRect.y + 7, buttonTextColor);
         }
+        perf_end(PERF_TEXT);
+        perf_draw_hud(renderer, font);
 
+        perf_begin(PERF_PRESENT);
         SDL_RenderPresent(renderer);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
     }
 
     // --- Cleanup ---
+    perf_shutdown();
     SDL_DestroyTexture(fractalTexture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(pwindow);
@@ -0,0 +1,274 @@
+#ifndef PERFHUD_H
+#define PERFHUD_H
+
+// Per-frame performance counters shared by all viewers.
+//
+// Each frame is split into phases (compute, texture upload, draw, text,
+// present) timed with the SDL performance counter. Kernels add the work they
+// did (iterations, pixels, cache lookups, thread busy time) to the current
+// frame, and perf_frame_end() after SDL_RenderPresent closes it. The numbers
+// are shown in a HUD toggled with F1 and, when started with --perf-log FILE,
+// written one row per frame to FILE as CSV (".csv" suffix) or JSON Lines
+// (anything else). Each phase is also recorded as a trace event (trace.h).
+//
+// Functions are 'static inline' so a viewer that never reports, say, cache
+// lookups does not get unused-function warnings.
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include "trace.h"
+
+typedef enum {
+    PERF_COMPUTE,  // Producing the fractal: iteration, geometry and per-point/line render calls
+    PERF_UPLOAD,   // SDL_UpdateTexture, SDL_LockTexture ... SDL_UnlockTexture
+    PERF_DRAW,     // Compositing an already computed fractal (texture copies)
+    PERF_TEXT,     // Overlay text and buttons
+    PERF_PRESENT,  // SDL_RenderPresent (includes vsync wait)
+    PERF_PHASE_COUNT
+} PerfPhase;
+
+static const char* const g_perf_phase_names[PERF_PHASE_COUNT] = {
+    "compute", "upload", "draw", "text", "present"
+};
+
+typedef struct {
+    double phase_ms[PERF_PHASE_COUNT];
+    double frame_ms;
+    long long iterations;
+    long long pixels;
+    long long cache_hits;
+    long long cache_lookups;
+    double thread_busy_ms;  // Summed over worker threads
+    int threads;
+} PerfFrameStats;
+
+typedef struct {
+    int hud_visible;
+    FILE* log_file;
+    int log_csv;
+    long frame_index;
+    Uint64 session_start;
+    Uint64 frame_start;
+    Uint64 phase_start[PERF_PHASE_COUNT];
+    PerfFrameStats current;       // Being accumulated for this frame
+    PerfFrameStats last_frame;    // Previous complete frame
+    PerfFrameStats last_compute;  // Most recent frame that did compute work
+    char view[160];               // Free-form description of the current view
+} PerfHud;
+
+static PerfHud g_perf;
+
+// Every viewer defines this helper with the same signature
+void renderText(SDL_Renderer* renderer, TTF_Font* font, const char* text, int x, int y, SDL_Color color);
+
+static inline double perf_ms_between(Uint64 start, Uint64 end) {
+    return (double)(end - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+// Parses --perf-hud (start with the HUD shown), --perf-log FILE and --trace FILE
+static inline void perf_init(int argc, char* argv[]) {
+    trace_init(argc, argv);
+    memset(&g_perf, 0, sizeof(g_perf));
+    g_perf.current.threads = 1;
+    g_perf.session_start = SDL_GetPerformanceCounter();
+    g_perf.frame_start = g_perf.session_start;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--perf-hud") == 0) {
+            g_perf.hud_visible = 1;
+        } else if (strcmp(argv[i], "--perf-log") == 0 && i + 1 < argc) {
+            const char* filename = argv[++i];
+            size_t length = strlen(filename);
+            g_perf.log_csv = length >= 4 && strcmp(filename + length - 4, ".csv") == 0;
+            g_perf.log_file = fopen(filename, "w");
+            if (g_perf.log_file == NULL) {
+                perror("Failed to open performance log");
+            } else if (g_perf.log_csv) {
+                fprintf(g_perf.log_file, "frame,time_ms,frame_ms,compute_ms,upload_ms,draw_ms,text_ms,present_ms,"
+                                         "iterations,pixels,pixels_per_s,cache_hits,cache_lookups,threads,thread_util,view\n");
+            }
+        }
+    }
+}
+
+// Quotes and backslashes are replaced so the text can be written into CSV and JSON as-is
+static inline void perf_set_view(const char* view) {
+    snprintf(g_perf.view, sizeof(g_perf.view), "%s", view);
+    for (char* c = g_perf.view; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') *c = '\'';
+    }
+}
+
+static inline void perf_begin(PerfPhase phase) {
+    g_perf.phase_start[phase] = SDL_GetPerformanceCounter();
+}
+
+static inline void perf_end(PerfPhase phase) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    g_perf.current.phase_ms[phase] += perf_ms_between(g_perf.phase_start[phase], now);
+    trace_record(g_perf_phase_names[phase], g_perf.phase_start[phase], now);
+}
+
+static inline void perf_add_iterations(long long iterations) {
+    g_perf.current.iterations += iterations;
+}
+
+static inline void perf_add_pixels(long long pixels) {
+    g_perf.current.pixels += pixels;
+}
+
+static inline void perf_add_cache(int hit) {
+    g_perf.current.cache_lookups++;
+    if (hit) g_perf.current.cache_hits++;
+}
+
+// Reports how many threads did the compute phase and their summed busy time
+static inline void perf_add_thread_time(int threads, double busy_ms) {
+    g_perf.current.threads = threads;
+    g_perf.current.thread_busy_ms += busy_ms;
+}
+
+// Throughput of the compute phase in pixels (or points) per second
+static inline double perf_pixels_per_second(const PerfFrameStats* stats) {
+    if (stats->phase_ms[PERF_COMPUTE] <= 0.0) return 0.0;
+    return stats->pixels * 1000.0 / stats->phase_ms[PERF_COMPUTE];
+}
+
+// Fraction of the available thread time that was spent working during compute
+static inline double perf_thread_utilization(const PerfFrameStats* stats) {
+    if (stats->phase_ms[PERF_COMPUTE] <= 0.0 || stats->thread_busy_ms <= 0.0) return 0.0;
+    return stats->thread_busy_ms / (stats->threads * stats->phase_ms[PERF_COMPUTE]);
+}
+
+static inline void perf_write_log(const PerfFrameStats* stats) {
+    double time_ms = perf_ms_between(g_perf.session_start, g_perf.frame_start);
+    if (g_perf.log_csv) {
+        fprintf(g_perf.log_file, "%ld,%.3f,%.3f", g_perf.frame_index, time_ms, stats->frame_ms);
+        for (int i = 0; i < PERF_PHASE_COUNT; ++i) {
+            fprintf(g_perf.log_file, ",%.3f", stats->phase_ms[i]);
+        }
+        fprintf(g_perf.log_file, ",%lld,%lld,%.0f,%lld,%lld,%d,%.3f,\"%s\"\n",
+                stats->iterations, stats->pixels, perf_pixels_per_second(stats),
+                stats->cache_hits, stats->cache_lookups, stats->threads,
+                perf_thread_utilization(stats), g_perf.view);
+    } else {
+        fprintf(g_perf.log_file, "{\"frame\":%ld,\"time_ms\":%.3f,\"frame_ms\":%.3f",
+                g_perf.frame_index, time_ms, stats->frame_ms);
+        for (int i = 0; i < PERF_PHASE_COUNT; ++i) {
+            fprintf(g_perf.log_file, ",\"%s_ms\":%.3f", g_perf_phase_names[i], stats->phase_ms[i]);
+        }
+        fprintf(g_perf.log_file, ",\"iterations\":%lld,\"pixels\":%lld,\"pixels_per_s\":%.0f,"
+                                 "\"cache_hits\":%lld,\"cache_lookups\":%lld,\"threads\":%d,\"thread_util\":%.3f,"
+                                 "\"view\":\"%s\"}\n",
+                stats->iterations, stats->pixels, perf_pixels_per_second(stats),
+                stats->cache_hits, stats->cache_lookups, stats->threads,
+                perf_thread_utilization(stats), g_perf.view);
+    }
+}
+
+// Closes the frame: keeps its statistics for the HUD, appends them to the log and starts
+// the next frame. Work done before the first call (e.g. the initial render) counts as frame 0.
+static inline void perf_frame_end(void) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    g_perf.current.frame_ms = perf_ms_between(g_perf.frame_start, now);
+    trace_record("frame", g_perf.frame_start, now);
+    g_perf.last_frame = g_perf.current;
+    if (g_perf.current.phase_ms[PERF_COMPUTE] > 0.0) {
+        g_perf.last_compute = g_perf.current;
+    }
+    if (g_perf.log_file != NULL) {
+        perf_write_log(&g_perf.current);
+        if (g_perf.frame_index % 60 == 0) fflush(g_perf.log_file);
+    }
+    g_perf.frame_index++;
+    g_perf.frame_start = now;
+    memset(&g_perf.current, 0, sizeof(g_perf.current));
+    g_perf.current.threads = 1;
+}
+
+// Moves the start of the current frame to now. A viewer that slept until the next event
+// calls it on waking (framesched.h), so frame_ms covers the frame and not the idle time.
+static inline void perf_frame_restart(void) {
+    g_perf.frame_start = SDL_GetPerformanceCounter();
+}
+
+// F1 toggles the HUD, F2 trace recording. Returns true if the event was used.
+static inline bool perf_handle_event(const SDL_Event* event) {
+    if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_F1) {
+        g_perf.hud_visible = !g_perf.hud_visible;
+        return true;
+    }
+    if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_F2) {
+        trace_toggle();
+        return true;
+    }
+    return false;
+}
+
+// Draws the HUD in the bottom-right corner of the render target
+static inline void perf_draw_hud(SDL_Renderer* renderer, TTF_Font* font) {
+    if (!g_perf.hud_visible || font == NULL) {
+        return;
+    }
+    perf_begin(PERF_TEXT);
+
+    const PerfFrameStats* frame = &g_perf.last_frame;
+    // A viewer that only redraws on change computes and presents in the same frame
+    const PerfFrameStats* compute = g_perf.current.phase_ms[PERF_COMPUTE] > 0.0 ? &g_perf.current : &g_perf.last_compute;
+    char lines[6][128];
+    int line_count = 0;
+
+    snprintf(lines[line_count++], sizeof(lines[0]), "Frame: %.2f ms (%.0f fps)",
+             frame->frame_ms, frame->frame_ms > 0.0 ? 1000.0 / frame->frame_ms : 0.0);
+    snprintf(lines[line_count++], sizeof(lines[0]), "Upload %.2f  Draw %.2f  Text %.2f  Present %.2f ms",
+             frame->phase_ms[PERF_UPLOAD], frame->phase_ms[PERF_DRAW],
+             frame->phase_ms[PERF_TEXT], frame->phase_ms[PERF_PRESENT]);
+    snprintf(lines[line_count++], sizeof(lines[0]), "Last compute: %.2f ms, %lld iterations",
+             compute->phase_ms[PERF_COMPUTE], compute->iterations);
+    snprintf(lines[line_count++], sizeof(lines[0]), "Throughput: %.2f Mpx/s (%lld px)",
+             perf_pixels_per_second(compute) / 1e6, compute->pixels);
+    if (compute->cache_lookups > 0) {
+        snprintf(lines[line_count++], sizeof(lines[0]), "Cache hits: %.1f%% of %lld",
+                 100.0 * compute->cache_hits / compute->cache_lookups, compute->cache_lookups);
+    } else {
+        snprintf(lines[line_count++], sizeof(lines[0]), "Cache hits: n/a");
+    }
+    if (compute->thread_busy_ms > 0.0) {
+        snprintf(lines[line_count++], sizeof(lines[0]), "Threads: %d, %.0f%% utilized",
+                 compute->threads, 100.0 * perf_thread_utilization(compute));
+    } else {
+        snprintf(lines[line_count++], sizeof(lines[0]), "Threads: 1");
+    }
+
+    int output_width = 0, output_height = 0;
+    SDL_GetRendererOutputSize(renderer, &output_width, &output_height);
+    int line_height = TTF_FontLineSkip(font);
+    // Keep clear of the one-line key help several viewers print along the bottom edge
+    SDL_Rect background = {output_width - 425, output_height - line_count * line_height - 45, 420, line_count * line_height + 10};
+
+    SDL_BlendMode previous_mode;
+    SDL_GetRenderDrawBlendMode(renderer, &previous_mode);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
+    SDL_RenderFillRect(renderer, &background);
+    SDL_SetRenderDrawBlendMode(renderer, previous_mode);
+
+    SDL_Color hud_color = {0, 255, 128, 255};
+    for (int i = 0; i < line_count; ++i) {
+        renderText(renderer, font, lines[i], background.x + 5, background.y + 5 + i * line_height, hud_color);
+    }
+    perf_end(PERF_TEXT);
+}
+
+static inline void perf_shutdown(void) {
+    trace_shutdown();
+    if (g_perf.log_file != NULL) {
+        fclose(g_perf.log_file);
+        g_perf.log_file = NULL;
+    }
+}
+
+#endif
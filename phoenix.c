@@ -4,6 +4,9 @@
 #include <math.h>
 #include <complex.h>
 #include <SDL2/SDL_ttf.h>
+#include "tileexport.h"
+#include "golden.h"
+#include "perfhud.h"
 
 // Window dimensions
 #define WIDTH 800
@@ -98,33 +101,66 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename) {
     SDL_FreeSurface(screenshot_surface);
 }
 
+// Iterates z_n+1 = z_n^2 + c + p * z_{n-1} from z, returning the iteration count and the value at escape
+int phoenixIterations(double complex z, int max_iterations, double complex* final_z) {
+    double complex z_prev = 0.0 + 0.0 * I;
+    int iterations = 0;
+
+    while (cabs(z) < 2.0 && iterations < max_iterations) {
+        double complex z_temp = z;
+        z = z * z + g_phoenix_c + g_phoenix_p * z_prev;
+        z_prev = z_temp;
+        iterations++;
+    }
+    *final_z = z;
+    return iterations;
+}
+
+// ARGB colour of a single point, used by the strip exporter
+uint32_t phoenixPixel(double re, double im) {
+    double complex final_z;
+    int iterations = phoenixIterations(re + im * I, g_current_max_iterations, &final_z);
+    SDL_Color color = getColor(iterations, g_current_max_iterations, final_z);
+    return (color.a << 24) | (color.r << 16) | (color.g << 8) | color.b;
+}
+
+// Iteration count at (re, im) for the golden checksum
+int phoenixGoldenSample(double re, double im, int max_iterations) {
+    double complex final_z;
+    return phoenixIterations(re + im * I, max_iterations, &final_z);
+}
+
+// Fixed views pinned by 'make golden' (name, x_min, x_max, y_min, y_max, iterations)
+const GoldenView g_golden_views[] = {
+    {"full", -2.0, 2.0, -1.5, 1.5, 100},
+    {"center", -0.6, 0.6, -0.45, 0.45, 300},
+};
+
 // Function to calculate and render the global texture
 void calculateAndRenderPhoenix(SDL_Renderer* renderer, SDL_Texture* texture, uint32_t* pixels) {
+    char view[160];
+    snprintf(view, sizeof(view), "R:[%.10g, %.10g] I:[%.10g, %.10g] C:%.5f%+.5fi it=%d",
+             g_real_min, g_real_max, g_imag_min, g_imag_max, creal(g_phoenix_c), cimag(g_phoenix_c), g_current_max_iterations);
+    perf_set_view(view);
+
     int pitch;
+    perf_begin(PERF_UPLOAD);
     SDL_LockTexture(texture, NULL, (void**)&pixels, &pitch);
+    perf_end(PERF_UPLOAD);
 
     double real_width = g_real_max - g_real_min;
     double imag_height = g_imag_max - g_imag_min;
+    long long total_iterations = 0;
+    perf_begin(PERF_COMPUTE);
 
     for (int y = 0; y < HEIGHT; ++y) {
         for (int x = 0; x < WIDTH; ++x) {
             double zx_initial = g_real_min + (double)x / WIDTH * real_width;
             double zy_initial = g_imag_min + (double)y / HEIGHT * imag_height;
 
-            double complex z = zx_initial + zy_initial * I;
-            double complex z_prev = 0.0 + 0.0 * I;
-
-            int iterations = 0;
-            double complex final_z_at_escape = 0.0 + 0.0 * I;
-
-            // Phoenix fractal iteration: z_n+1 = z_n^2 + c + p * z_{n-1}
-            while (cabs(z) < 2.0 && iterations < g_current_max_iterations) {
-                double complex z_temp = z;
-                z = z * z + g_phoenix_c + g_phoenix_p * z_prev;
-                z_prev = z_temp;
-                iterations++;
-            }
-            final_z_at_escape = z;
+            double complex final_z_at_escape;
+            int iterations = phoenixIterations(zx_initial + zy_initial * I, g_current_max_iterations, &final_z_at_escape);
+            total_iterations += iterations;
 
             SDL_Color pixel_color = getColor(iterations, g_current_max_iterations, final_z_at_escape);
             
@@ -134,10 +170,34 @@ void calculateAndRenderPhoenix(SDL_Renderer* renderer, SDL_Texture* texture, uin
                                                            (pixel_color.b);
         }
     }
+    perf_end(PERF_COMPUTE);
+    perf_add_iterations(total_iterations);
+    perf_add_pixels((long long)WIDTH * HEIGHT);
+
+    perf_begin(PERF_UPLOAD);
     SDL_UnlockTexture(texture);
+    perf_end(PERF_UPLOAD);
 }
 
 int main(int argc, char* argv[]) {
+    // Golden-image regression check: render the fixed views headlessly and compare
+    GoldenOptions golden_options;
+    int golden_status = golden_parse_args(argc, argv, &golden_options);
+    if (golden_status != 0) {
+        if (golden_status < 0) return 1;
+        return golden_run(&golden_options, "phoenix", g_golden_views, GOLDEN_VIEW_COUNT(g_golden_views), phoenixGoldenSample);
+    }
+
+    // Headless poster export: render straight to disk without opening a window
+    ExportJob export_job = export_default_job(g_real_min, g_real_max, g_imag_min, g_imag_max, g_current_max_iterations);
+    int export_status = export_parse_args(argc, argv, &export_job);
+    if (export_status != 0) {
+        if (export_status < 0) return 1;
+        g_current_max_iterations = export_job.max_iterations;
+        return export_run(&export_job, phoenixPixel);
+    }
+    perf_init(argc, argv);
+
     // --- SDL Initialization ---
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         fprintf(stderr, "SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
@@ -210,6 +270,7 @@ int main(int argc, char* argv[]) {
 
     while (application_running) {
         while (SDL_PollEvent(&event)) {
+            if (perf_handle_event(&event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
@@ -221,7 +282,9 @@ int main(int argc, char* argv[]) {
                         event.button.x <= screenshotButtonRect.x + screenshotButtonRect.w &&
                         event.button.y >= screenshotButtonRect.y &&
                         event.button.y <= screenshotButtonRect.y + screenshotButtonRect.h) {
+                        Uint64 trace_start = trace_begin();
                         saveScreenshot(g_renderer, "phoenix_fractal_screenshot.bmp");
+                        trace_end("screenshot", trace_start);
                     } else if (event.button.button == SDL_BUTTON_LEFT) {
                         g_is_panning = true;
                         g_last_mouse_x = event.button.x;
@@ -304,9 +367,12 @@ int main(int argc, char* argv[]) {
         // --- Always update the screen ---
         SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 255); 
         SDL_RenderClear(g_renderer);
+        perf_begin(PERF_DRAW);
         SDL_RenderCopy(g_renderer, g_fractal_texture, NULL, NULL);
+        perf_end(PERF_DRAW);
 
         // Render text overlays
+        perf_begin(PERF_TEXT);
         if (g_font != NULL) {
             char text_buffer[200];
             SDL_Color textColor = {255, 255, 255, 255};
@@ -325,7 +391,7 @@ int main(int argc, char* argv[]) {
             snprintf(text_buffer, sizeof(text_buffer), "Imag: [%.5f, %.5f]", g_imag_min, g_imag_max);
             renderText(g_renderer, g_font, text_buffer, 10, 90, textColor);
 
-            renderText(g_renderer, g_font, "Left Drag: Pan, Wheel: Zoom, R: Reset", 10, HEIGHT - 30, textColor);
+            renderText(g_renderer, g_font, "Left Drag: Pan, Wheel: Zoom, R: Reset, F1: Perf HUD", 10, HEIGHT - 30, textColor);
 
             SDL_Rect screenshotButtonRect = {WIDTH - 120, 10, 110, 30};
             SDL_SetRenderDrawColor(g_renderer, 50, 50, 50, 255); 
@@ -336,12 +402,18 @@ int main(int argc, char* argv[]) {
             SDL_Color buttonTextColor = {255, 255, 255, 255};
             renderText(g_renderer, g_font, "Save", screenshotButtonRect.x + 8, screenshotButtonRect.y + 7, buttonTextColor);
         }
+        perf_end(PERF_TEXT);
+        perf_draw_hud(g_renderer, g_font);
 
+        perf_begin(PERF_PRESENT);
         SDL_RenderPresent(g_renderer);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
         SDL_Delay(1);
     }
 
     // --- Cleanup ---
+    perf_shutdown();
     if (g_pixels != NULL) {
         free(g_pixels);
     }
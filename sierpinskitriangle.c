@@ -1,30 +1,114 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <SDL2/SDL.h>
 #include <stdbool.h>
 #include <math.h>
 #include <SDL2/SDL_ttf.h>
+#include "perfhud.h"
+#include "linebatch.h"
+#include "deepview.h"
+#include "golden.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIERPINSKI_SSE2 1
+#endif
 
 #define WIDTH 800
 #define HEIGHT 800
 
 #define MAX_RECURSION_DEPTH 7
 
-// Global variables for zoom and pan
-double g_zoom = 1.0;     
-double g_offset_x = 0.0; 
-double g_offset_y = 0.0; 
+// Depth the Up arrow can reach. Triangles outside the window are skipped and triangles
+// smaller than SIERPINSKI_LOD_PIXELS are plotted as one pixel, so deep levels only cost
+// anything when zoomed in.
+#define SIERPINSKI_DEPTH_LIMIT DEEP_VIEW_MAX_LEVELS
+#define SIERPINSKI_LOD_PIXELS 1.0
+
+// Outline lists kept below the anchor level; sub-pixel termination stops far earlier
+#define SIERPINSKI_LIST_LEVELS 64
+
+// Outline edges are clipped to the window plus this margin before conversion to int
+#define SIERPINSKI_CLIP_MARGIN 16.0
+
+#define SIERPINSKI_MAX_THREADS 64
+
+// Camera in (u, v) coordinates: u runs along the base and v towards the top vertex of
+// the outer triangle, which is the lower-left half of the root cell
+DeepView g_view;
 
 // For mouse drag panning
 int g_mouse_down_x = 0;
 int g_mouse_down_y = 0;
 bool g_is_panning = false;
 
+LineBatch g_line_batch;
+
 // Structure to represent a 2D point
 typedef struct {
     double x;
     double y;
 } Point;
 
+// Visible triangle outline, in screen space
+typedef struct {
+    Point p1, p2, p3;
+} SierpinskiTriangle;
+
+typedef struct {
+    SierpinskiTriangle* triangles;
+    long long count;
+    long long capacity;
+} SierpinskiLevel;
+
+// Outlines of the current view grouped by recursion level below the anchor, so each
+// level is drawn with one colour change. Sub-pixel triangles are collected in
+// g_sierpinski_dots.
+SierpinskiLevel g_sierpinski_levels[SIERPINSKI_LIST_LEVELS];
+SDL_Point* g_sierpinski_dots = NULL;
+long long g_sierpinski_dot_count = 0;
+long long g_sierpinski_dot_capacity = 0;
+long long g_sierpinski_nodes = 0;  // Triangles visited in the current redraw
+bool g_sierpinski_out_of_memory = false;
+
+typedef enum {
+    SIERPINSKI_CELL_EMPTY,
+    SIERPINSKI_CELL_TRIANGLE,  // Lower-left half is a triangle of the anchor level
+    SIERPINSKI_CELL_FULL       // Inside a triangle of the recursion depth
+} SierpinskiCellState;
+
+// Cells around the anchor: g_sierpinski_cells[j + 1][i + 1] is the cell i steps along
+// the base and j steps towards the top from the anchor. When the anchor is below the
+// recursion depth, the edge flags mark cell edges that lie on the outline of a
+// triangle of that depth.
+typedef struct {
+    SierpinskiCellState state;
+    bool bottom_edge;
+    bool left_edge;
+    bool diagonal_edge;
+} SierpinskiCell;
+
+SierpinskiCell g_sierpinski_cells[3][3];
+
+// Filled mode ('F') decides membership per pixel instead of drawing outlines
+bool g_sierpinski_filled = false;
+int g_sierpinski_thread_count = 1;
+uint32_t* g_sierpinski_pixels = NULL;
+
+// Offset of u from the first pixel of a row for every pixel column in filled mode. The
+// camera is sheared, so u itself and its grid cell change from row to row.
+_Alignas(16) double g_sierpinski_column_u[WIDTH];
+
+typedef struct {
+    int index;
+    int first_row;
+    int end_row;
+    int levels;
+    uint32_t color;
+    long long filled;
+    double busy_ms;
+} SierpinskiWorker;
+
 // Function to get a color based on the recursion depth (iteration level)
 SDL_Color getDepthColor(int current_recursion_depth, int max_possible_depth) {
     SDL_Color colors[] = {
@@ -45,34 +129,476 @@ SDL_Color getDepthColor(int current_recursion_depth, int max_possible_depth) {
     return colors[color_idx];
 }
 
-// Function to draw a line segment, applying current zoom and offset
-void drawLine(SDL_Renderer* renderer, Point p1, Point p2) {
-    SDL_RenderDrawLine(renderer,
-                       (int)((p1.x * g_zoom) + g_offset_x),
-                       (int)((p1.y * g_zoom) + g_offset_y),
-                       (int)((p2.x * g_zoom) + g_offset_x),
-                       (int)((p2.y * g_zoom) + g_offset_y));
+// Clips p1-p2 to the window plus SIERPINSKI_CLIP_MARGIN (Liang-Barsky). Returns false
+// if nothing is left.
+bool clipSierpinskiSegment(Point* p1, Point* p2) {
+    double t0 = 0.0, t1 = 1.0;
+    double dx = p2->x - p1->x, dy = p2->y - p1->y;
+    double p[4] = {-dx, dx, -dy, dy};
+    double q[4] = {p1->x + SIERPINSKI_CLIP_MARGIN, WIDTH + SIERPINSKI_CLIP_MARGIN - p1->x,
+                   p1->y + SIERPINSKI_CLIP_MARGIN, HEIGHT + SIERPINSKI_CLIP_MARGIN - p1->y};
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0.0) {
+            if (q[i] < 0.0) return false;
+        } else {
+            double t = q[i] / p[i];
+            if (p[i] < 0.0) {
+                if (t > t1) return false;
+                if (t > t0) t0 = t;
+            } else {
+                if (t < t0) return false;
+                if (t < t1) t1 = t;
+            }
+        }
+    }
+    Point start = {p1->x + t0 * dx, p1->y + t0 * dy};
+    Point end = {p1->x + t1 * dx, p1->y + t1 * dy};
+    *p1 = start;
+    *p2 = end;
+    return true;
+}
+
+// Points are in screen space
+void drawLine(LineBatch* batch, Point p1, Point p2) {
+    if (!clipSierpinskiSegment(&p1, &p2)) {
+        return;
+    }
+    line_batch_add(batch, (int)p1.x, (int)p1.y, (int)p2.x, (int)p2.y);
+}
+
+void addSierpinskiTriangle(SierpinskiLevel* level, Point p1, Point p2, Point p3) {
+    if (level->count == level->capacity) {
+        long long capacity = level->capacity > 0 ? level->capacity * 2 : 1024;
+        SierpinskiTriangle* triangles = realloc(level->triangles, (size_t)capacity * sizeof(SierpinskiTriangle));
+        if (triangles == NULL) {
+            g_sierpinski_out_of_memory = true;
+            return;
+        }
+        level->triangles = triangles;
+        level->capacity = capacity;
+    }
+    level->triangles[level->count++] = (SierpinskiTriangle){p1, p2, p3};
 }
 
-void drawSierpinskiTriangle(SDL_Renderer* renderer, Point p1, Point p2, Point p3, int depth, int max_display_depth) {
-    SDL_Color lineColor = getDepthColor(max_display_depth - depth, max_display_depth);
-    SDL_SetRenderDrawColor(renderer, lineColor.r, lineColor.g, lineColor.b, lineColor.a);
+void addSierpinskiDot(int x, int y) {
+    if (g_sierpinski_dot_count == g_sierpinski_dot_capacity) {
+        long long capacity = g_sierpinski_dot_capacity > 0 ? g_sierpinski_dot_capacity * 2 : 4096;
+        SDL_Point* dots = realloc(g_sierpinski_dots, (size_t)capacity * sizeof(SDL_Point));
+        if (dots == NULL) {
+            g_sierpinski_out_of_memory = true;
+            return;
+        }
+        g_sierpinski_dots = dots;
+        g_sierpinski_dot_capacity = capacity;
+    }
+    g_sierpinski_dots[g_sierpinski_dot_count++] = (SDL_Point){x, y};
+}
 
-    // Draw the current triangle's outline
-    drawLine(renderer, p1, p2);
-    drawLine(renderer, p2, p3);
-    drawLine(renderer, p3, p1);
+// Collects the visible part of the triangle p1, p2, p3 (screen space) and its
+// subdivisions down to 'depth'. 'list' is the level counted from the anchor.
+void collectSierpinskiTriangle(Point p1, Point p2, Point p3, int level, int list, int depth) {
+    g_sierpinski_nodes++;
+
+    // Every subdivision stays inside the triangle, so one that misses the window is done
+    double min_x = fmin(p1.x, fmin(p2.x, p3.x));
+    double max_x = fmax(p1.x, fmax(p2.x, p3.x));
+    double min_y = fmin(p1.y, fmin(p2.y, p3.y));
+    double max_y = fmax(p1.y, fmax(p2.y, p3.y));
+    if (max_x < 0.0 || min_x >= WIDTH || max_y < 0.0 || min_y >= HEIGHT) {
+        return;
+    }
 
-    if (depth > 0) {
+    // Below a pixel the outlines of all deeper levels fill it; the deepest one is drawn last
+    if (max_x - min_x < SIERPINSKI_LOD_PIXELS && max_y - min_y < SIERPINSKI_LOD_PIXELS) {
+        addSierpinskiDot((int)((min_x + max_x) / 2.0), (int)((min_y + max_y) / 2.0));
+        return;
+    }
+
+    addSierpinskiTriangle(&g_sierpinski_levels[list], p1, p2, p3);
+
+    if (level < depth && list + 1 < SIERPINSKI_LIST_LEVELS) {
         // Calculate the midpoints of each side
         Point mid12 = {(p1.x + p2.x) / 2.0, (p1.y + p2.y) / 2.0};
         Point mid23 = {(p2.x + p3.x) / 2.0, (p2.y + p3.y) / 2.0};
         Point mid31 = {(p3.x + p1.x) / 2.0, (p3.y + p1.y) / 2.0};
 
-        drawSierpinskiTriangle(renderer, p1, mid12, mid31, depth - 1, max_display_depth); // Top-left
-        drawSierpinskiTriangle(renderer, mid12, p2, mid23, depth - 1, max_display_depth); // Top-right
-        drawSierpinskiTriangle(renderer, mid31, mid23, p3, depth - 1, max_display_depth); // Bottom
+        collectSierpinskiTriangle(p1, mid12, mid31, level + 1, list + 1, depth); // Top-left
+        collectSierpinskiTriangle(mid12, p2, mid23, level + 1, list + 1, depth); // Top-right
+        collectSierpinskiTriangle(mid31, mid23, p3, level + 1, list + 1, depth); // Bottom
+    }
+}
+
+void resetSierpinskiView(void) {
+    // Define the initial outer equilateral triangle vertices
+    double side_length = 700.0; // Size of the base triangle
+    double height = side_length * sqrt(3.0) / 2.0;
+    Point p2 = {WIDTH / 2.0 - side_length / 2.0, 50.0 + height}; // Bottom-left vertex
+
+    // v = (p2.y - y) / height, u = (x - p2.x) / side_length - v / 2
+    deep_view_init(&g_view, 2, WIDTH, HEIGHT,
+                   -p2.x / side_length - p2.y / (2.0 * height), 1.0 / side_length, 0.5 / height,
+                   p2.y / height, 0.0, -1.0 / height);
+}
+
+// Screen position of the cell corner (u, v), in anchor cells
+Point sierpinskiCorner(double u, double v) {
+    Point p;
+    deep_view_screen(&g_view, u, v, &p.x, &p.y);
+    return p;
+}
+
+// Compares the low bits of a cell address, levels [first, levels): returns the sign of
+// v_low - (all ones - u_low). Zero means the cell straddles the diagonal of the
+// triangle they belong to.
+int compareSierpinskiDiagonal(const unsigned char* u_digits, const unsigned char* v_digits, int first, int levels) {
+    for (int k = first; k < levels; ++k) {
+        int complement = 1 - u_digits[k];
+        if (v_digits[k] != complement) {
+            return v_digits[k] < complement ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// Fills g_sierpinski_cells for the anchor. Cells are checked down to the recursion
+// depth: a level keeps a cell when its u and v digits are not both 1.
+void classifySierpinskiCells(int depth) {
+    static unsigned char u_digits[3][DEEP_VIEW_MAX_LEVELS];
+    static unsigned char v_digits[3][DEEP_VIEW_MAX_LEVELS];
+    bool u_valid[3], v_valid[3];
+    for (int i = 0; i < 3; ++i) {
+        u_valid[i] = deep_view_neighbor(&g_view, g_view.x_digits, i - 1, u_digits[i]);
+        v_valid[i] = deep_view_neighbor(&g_view, g_view.y_digits, i - 1, v_digits[i]);
+    }
+
+    int levels = g_view.levels;
+    int prefix = levels < depth ? levels : depth;
+    for (int j = 0; j < 3; ++j) {
+        for (int i = 0; i < 3; ++i) {
+            SierpinskiCell* cell = &g_sierpinski_cells[j][i];
+            *cell = (SierpinskiCell){SIERPINSKI_CELL_EMPTY, false, false, false};
+            bool member = u_valid[i] && v_valid[j];
+            for (int k = 0; member && k < prefix; ++k) {
+                member = !(u_digits[i][k] && v_digits[j][k]);
+            }
+            if (!member) {
+                continue;
+            }
+            if (levels <= depth) {
+                cell->state = SIERPINSKI_CELL_TRIANGLE;
+                continue;
+            }
+
+            // Below the depth: where does the cell sit inside its depth-level triangle?
+            int side = compareSierpinskiDiagonal(u_digits[i], v_digits[j], depth, levels);
+            if (side > 0) {
+                continue;
+            }
+            cell->state = side < 0 ? SIERPINSKI_CELL_FULL : SIERPINSKI_CELL_TRIANGLE;
+            cell->diagonal_edge = side == 0;
+            cell->bottom_edge = true;
+            cell->left_edge = true;
+            for (int k = depth; k < levels; ++k) {
+                if (v_digits[j][k]) cell->bottom_edge = false;
+                if (u_digits[i][k]) cell->left_edge = false;
+            }
+        }
+    }
+}
+
+// Draws the current view. Levels go from the anchor inwards so deeper outlines end up
+// on top of the edges they share with their parents, as in a depth-first draw.
+void drawSierpinskiTriangle(LineBatch* batch, SDL_Renderer* renderer, int depth) {
+    deep_view_normalize(&g_view);
+    classifySierpinskiCells(depth);
+
+    for (int list = 0; list < SIERPINSKI_LIST_LEVELS; ++list) {
+        g_sierpinski_levels[list].count = 0;
+    }
+    g_sierpinski_dot_count = 0;
+    g_sierpinski_nodes = 0;
+    g_sierpinski_out_of_memory = false;
+    if (g_view.levels <= depth) {
+        for (int j = -1; j <= 1; ++j) {
+            for (int i = -1; i <= 1; ++i) {
+                if (g_sierpinski_cells[j + 1][i + 1].state == SIERPINSKI_CELL_TRIANGLE) {
+                    collectSierpinskiTriangle(sierpinskiCorner(i, j + 1), sierpinskiCorner(i, j),
+                                              sierpinskiCorner(i + 1, j), g_view.levels, 0, depth);
+                }
+            }
+        }
+    }
+    if (g_sierpinski_out_of_memory) {
+        printf("Out of memory while collecting triangles; the image is incomplete.\n");
+    }
+
+    line_batch_begin(batch, renderer);
+    for (int list = 0; list < SIERPINSKI_LIST_LEVELS; ++list) {
+        const SierpinskiLevel* triangles = &g_sierpinski_levels[list];
+        if (triangles->count == 0) {
+            continue;
+        }
+        SDL_Color lineColor = getDepthColor(g_view.levels + list, depth);
+        line_batch_set_color(batch, lineColor.r, lineColor.g, lineColor.b, lineColor.a);
+        for (long long i = 0; i < triangles->count; ++i) {
+            const SierpinskiTriangle* triangle = &triangles->triangles[i];
+
+            // Draw the triangle's outline (one closed polyline)
+            drawLine(batch, triangle->p1, triangle->p2);
+            drawLine(batch, triangle->p2, triangle->p3);
+            drawLine(batch, triangle->p3, triangle->p1);
+        }
+    }
+
+    // Zoomed in below the depth, only the outlines of depth-level triangles are left
+    if (g_view.levels > depth) {
+        SDL_Color lineColor = getDepthColor(depth, depth);
+        line_batch_set_color(batch, lineColor.r, lineColor.g, lineColor.b, lineColor.a);
+        for (int j = -1; j <= 1; ++j) {
+            for (int i = -1; i <= 1; ++i) {
+                const SierpinskiCell* cell = &g_sierpinski_cells[j + 1][i + 1];
+                if (cell->bottom_edge) {
+                    drawLine(batch, sierpinskiCorner(i, j), sierpinskiCorner(i + 1, j));
+                }
+                if (cell->left_edge) {
+                    drawLine(batch, sierpinskiCorner(i, j), sierpinskiCorner(i, j + 1));
+                }
+                if (cell->diagonal_edge) {
+                    drawLine(batch, sierpinskiCorner(i + 1, j), sierpinskiCorner(i, j + 1));
+                }
+            }
+        }
     }
+    line_batch_end(batch);
+
+    if (g_sierpinski_dot_count > 0) {
+        SDL_Color dotColor = getDepthColor(depth, depth);
+        SDL_SetRenderDrawColor(renderer, dotColor.r, dotColor.g, dotColor.b, dotColor.a);
+        SDL_RenderDrawPoints(renderer, g_sierpinski_dots, (int)g_sierpinski_dot_count);
+    }
+}
+
+// --- Per-Pixel Membership (filled mode) ---
+// With (u, v) the coordinates of a point along the base and towards the top vertex
+// (u, v >= 0, u + v <= 1), level L keeps the corner triangles of the 2^L grid cells
+// whose integer coordinates have no set bit in common (Pascal's triangle mod 2). Inside
+// such a cell the point must also lie below the cell's diagonal.
+
+// Levels to resolve below the anchor: the rest of the recursion depth, but no level
+// whose triangles are a pixel or smaller
+int sierpinskiVisibleLevels(int depth) {
+    double side_pixels = 1.0 / hypot(g_view.xx, g_view.yx);
+    int levels = 0;
+    while (g_view.levels + levels < depth && levels < 52 && side_pixels > 1.0) {
+        side_pixels /= 2.0;
+        levels++;
+    }
+    return levels;
+}
+
+#ifdef SIERPINSKI_SSE2
+// Per-row constants of the SSE2 membership test
+typedef struct {
+    __m128d u_start, cells, v_frac;
+    __m128i cell_v;
+    __m128d full[3], triangle[3];  // All ones in both lanes when the cell has that state
+} SierpinskiRow2;
+
+// Membership of two neighbouring pixels, the scalar test below on two double lanes.
+// SSE2 has no floor(), so u_cells (below 2^52) is rounded to an integer by adding 2^52
+// and corrected downwards; the low bits of u_floor + 2^52 are then the grid column.
+static inline __m128d sierpinskiMember2(const SierpinskiRow2* r, const double* column_u) {
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d magic = _mm_set1_pd(4503599627370496.0);  // 2^52
+    __m128d u = _mm_add_pd(r->u_start, _mm_load_pd(column_u));
+    __m128d past0 = _mm_cmpge_pd(u, _mm_setzero_pd());
+    __m128d past1 = _mm_cmpge_pd(u, one);
+    __m128d inside = _mm_and_pd(_mm_cmpge_pd(u, _mm_set1_pd(-1.0)), _mm_cmplt_pd(u, _mm_set1_pd(2.0)));
+    __m128d in_left = _mm_andnot_pd(past0, inside);
+    __m128d in_middle = _mm_andnot_pd(past1, past0);
+    __m128d in_right = _mm_and_pd(past1, inside);
+    __m128d full = _mm_or_pd(_mm_or_pd(_mm_and_pd(in_left, r->full[0]), _mm_and_pd(in_middle, r->full[1])),
+                             _mm_and_pd(in_right, r->full[2]));
+    __m128d triangle = _mm_or_pd(_mm_or_pd(_mm_and_pd(in_left, r->triangle[0]),
+                                           _mm_and_pd(in_middle, r->triangle[1])),
+                                 _mm_and_pd(in_right, r->triangle[2]));
+
+    __m128d i = _mm_add_pd(_mm_set1_pd(-1.0), _mm_add_pd(_mm_and_pd(past0, one), _mm_and_pd(past1, one)));
+    __m128d u_cells = _mm_mul_pd(_mm_sub_pd(u, i), r->cells);
+    __m128d rounded = _mm_sub_pd(_mm_add_pd(u_cells, magic), magic);
+    __m128d u_floor = _mm_sub_pd(rounded, _mm_and_pd(_mm_cmpgt_pd(rounded, u_cells), one));
+    __m128d below = _mm_cmplt_pd(_mm_add_pd(_mm_sub_pd(u_cells, u_floor), r->v_frac), one);
+
+    // (u_floor & cell_v) == 0 per 64-bit lane, from the two 32-bit halves
+    __m128i common = _mm_and_si128(_mm_castpd_si128(_mm_add_pd(u_floor, magic)), r->cell_v);
+    __m128i disjoint = _mm_cmpeq_epi32(common, _mm_setzero_si128());
+    disjoint = _mm_and_si128(disjoint, _mm_shuffle_epi32(disjoint, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    triangle = _mm_and_pd(_mm_and_pd(triangle, below), _mm_castsi128_pd(disjoint));
+    return _mm_or_pd(full, triangle);
+}
+#endif
+
+void fillSierpinskiRows(SierpinskiWorker* worker) {
+    const uint32_t background = 0xFF000000;
+    double cells = ldexp(1.0, worker->levels);
+    long long filled = 0;
+
+    for (int y = worker->first_row; y < worker->end_row; ++y) {
+        uint32_t* row = g_sierpinski_pixels + (size_t)y * WIDTH;
+
+        // The view is never rotated, so v is constant along a row and u grows linearly
+        double u_start, v;
+        deep_view_local(&g_view, 0.5, y + 0.5, &u_start, &v);
+        double j = floor(v);
+        const SierpinskiCell* cells_row = j >= -1.0 && j <= 1.0 ? g_sierpinski_cells[(int)j + 1] : NULL;
+        double v_cells = (v - j) * cells;
+        double v_floor = floor(v_cells);
+        uint64_t cell_v = (uint64_t)v_floor;
+        double v_frac = v_cells - v_floor;
+
+        int x = 0;
+#ifdef SIERPINSKI_SSE2
+        SierpinskiRow2 r;
+        r.u_start = _mm_set1_pd(u_start);
+        r.cells = _mm_set1_pd(cells);
+        r.v_frac = _mm_set1_pd(v_frac);
+        r.cell_v = _mm_set_epi32((int)(cell_v >> 32), (int)cell_v, (int)(cell_v >> 32), (int)cell_v);
+        for (int i = 0; i < 3; ++i) {
+            SierpinskiCellState state = cells_row != NULL ? cells_row[i].state : SIERPINSKI_CELL_EMPTY;
+            r.full[i] = _mm_castsi128_pd(_mm_set1_epi32(state == SIERPINSKI_CELL_FULL ? -1 : 0));
+            r.triangle[i] = _mm_castsi128_pd(_mm_set1_epi32(state == SIERPINSKI_CELL_TRIANGLE ? -1 : 0));
+        }
+        const __m128i color4 = _mm_set1_epi32((int)worker->color);
+        const __m128i background4 = _mm_set1_epi32((int)background);
+        __m128i members4 = _mm_setzero_si128();  // Minus the number of members in each lane
+        for (; x + 4 <= WIDTH; x += 4) {
+            __m128d member01 = sierpinskiMember2(&r, g_sierpinski_column_u + x);
+            __m128d member23 = sierpinskiMember2(&r, g_sierpinski_column_u + x + 2);
+            // Both halves of a 64-bit mask are equal, so keep the low ones
+            __m128i member = _mm_castps_si128(_mm_shuffle_ps(_mm_castpd_ps(member01), _mm_castpd_ps(member23),
+                                                             _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_si128((__m128i*)(row + x),
+                             _mm_or_si128(_mm_and_si128(member, color4), _mm_andnot_si128(member, background4)));
+            members4 = _mm_add_epi32(members4, member);
+        }
+        _Alignas(16) int32_t lane_counts[4];
+        _mm_store_si128((__m128i*)lane_counts, members4);
+        filled -= (long long)lane_counts[0] + lane_counts[1] + lane_counts[2] + lane_counts[3];
+#endif
+        for (; x < WIDTH; ++x) {
+            double u = u_start + g_sierpinski_column_u[x];
+            bool member = false;
+            if (cells_row != NULL && u >= -1.0 && u < 2.0) {
+                double i = floor(u);
+                SierpinskiCellState state = cells_row[(int)i + 1].state;
+                if (state == SIERPINSKI_CELL_FULL) {
+                    member = true;
+                } else if (state == SIERPINSKI_CELL_TRIANGLE) {
+                    // Same test as the anchor digits, on the levels below it
+                    double u_cells = (u - i) * cells;
+                    double u_floor = floor(u_cells);
+                    member = ((uint64_t)u_floor & cell_v) == 0 && (u_cells - u_floor) + v_frac < 1.0;
+                }
+            }
+            row[x] = member ? worker->color : background;
+            filled += member;
+        }
+    }
+    worker->filled = filled;
+}
+
+int sierpinskiWorkerThread(void* data) {
+    SierpinskiWorker* worker = (SierpinskiWorker*)data;
+    Uint64 start = SDL_GetPerformanceCounter();
+    char lane_name[32];
+    snprintf(lane_name, sizeof(lane_name), "sierpinski worker %d", worker->index);
+    trace_set_thread_name(lane_name);
+
+    fillSierpinskiRows(worker);
+
+    Uint64 end = SDL_GetPerformanceCounter();
+    worker->busy_ms = perf_ms_between(start, end);
+    trace_record("fill rows", start, end);
+    return 0;
+}
+
+// Fills g_sierpinski_pixels for the current view in bands of rows, worker 0 on this
+// thread
+void fillSierpinskiFrame(int depth) {
+    deep_view_normalize(&g_view);
+    classifySierpinskiCells(depth);
+    int levels = sierpinskiVisibleLevels(depth);
+    SDL_Color color = getDepthColor(depth, depth);
+    for (int x = 0; x < WIDTH; ++x) {
+        g_sierpinski_column_u[x] = x * g_view.xx;
+    }
+
+    SierpinskiWorker workers[SIERPINSKI_MAX_THREADS];
+    for (int t = 0; t < g_sierpinski_thread_count; ++t) {
+        workers[t].index = t;
+        workers[t].first_row = HEIGHT * t / g_sierpinski_thread_count;
+        workers[t].end_row = HEIGHT * (t + 1) / g_sierpinski_thread_count;
+        workers[t].levels = levels;
+        workers[t].color = 0xFF000000u | ((uint32_t)color.r << 16) | ((uint32_t)color.g << 8) | color.b;
+    }
+
+    perf_begin(PERF_COMPUTE);
+    SDL_Thread* threads[SIERPINSKI_MAX_THREADS];
+    for (int t = 1; t < g_sierpinski_thread_count; ++t) {
+        threads[t] = SDL_CreateThread(sierpinskiWorkerThread, "sierpinski worker", &workers[t]);
+        if (threads[t] == NULL) {
+            sierpinskiWorkerThread(&workers[t]);  // Fall back to running it inline
+        }
+    }
+    sierpinskiWorkerThread(&workers[0]);
+    trace_set_thread_name("main");
+
+    double busy_ms = workers[0].busy_ms;
+    for (int t = 1; t < g_sierpinski_thread_count; ++t) {
+        if (threads[t] != NULL) {
+            SDL_WaitThread(threads[t], NULL);
+        }
+        busy_ms += workers[t].busy_ms;
+    }
+    perf_end(PERF_COMPUTE);
+    perf_add_iterations((long long)WIDTH * HEIGHT);
+    perf_add_pixels((long long)WIDTH * HEIGHT);
+    perf_add_thread_time(g_sierpinski_thread_count, busy_ms);
+}
+
+// Fills the current view and uploads it to 'texture'
+void drawSierpinskiFilled(SDL_Texture* texture, int depth) {
+    fillSierpinskiFrame(depth);
+    perf_begin(PERF_UPLOAD);
+    SDL_UpdateTexture(texture, NULL, g_sierpinski_pixels, WIDTH * sizeof(uint32_t));
+    perf_end(PERF_UPLOAD);
+}
+
+// Fixed filled-mode views pinned by 'make golden' (name, x_min, x_max, y_min, y_max,
+// depth), in a plane where the outer triangle has a unit base from (0, 0) to (1, 0)
+const GoldenView g_golden_views[] = {
+    {"whole", -0.05, 1.05, -0.1, 1.0, 8},
+    {"corner", -0.001, 0.009, -0.002, 0.008, 20},
+    {"edge", 0.3749, 0.3751, -0.00005, 0.00015, 60},
+};
+
+// Renders a golden view in filled mode through the same row fill as the window
+const uint32_t* renderSierpinskiGoldenView(const GoldenView* golden_view, int* pixel_count) {
+    if (g_sierpinski_pixels == NULL) {
+        g_sierpinski_pixels = (uint32_t*)malloc(sizeof(uint32_t) * WIDTH * HEIGHT);
+        if (g_sierpinski_pixels == NULL) return NULL;
+    }
+    // The view's y axis points up and v = 2 y / sqrt(3), u = x - v / 2
+    double pixel_w = (golden_view->x_max - golden_view->x_min) / WIDTH;
+    double pixel_h = (golden_view->y_max - golden_view->y_min) / HEIGHT;
+    double v_top = golden_view->y_max * 2.0 / sqrt(3.0);
+    deep_view_init(&g_view, 2, WIDTH, HEIGHT,
+                   golden_view->x_min - v_top / 2.0, pixel_w, pixel_h / sqrt(3.0),
+                   v_top, 0.0, -pixel_h * 2.0 / sqrt(3.0));
+    fillSierpinskiFrame(golden_view->max_iterations);
+    *pixel_count = WIDTH * HEIGHT;
+    return g_sierpinski_pixels;
 }
 
 // Function to render text on the screen
@@ -126,13 +652,26 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename) {
     SDL_FreeSurface(screenshot);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Golden-image regression check: render the fixed views headlessly and compare
+    GoldenOptions golden_options;
+    int golden_status = golden_parse_args(argc, argv, &golden_options);
+    if (golden_status != 0) {
+        if (golden_status < 0) return 1;
+        return golden_run_frames(&golden_options, "sierpinskitriangle", g_golden_views,
+                                 GOLDEN_VIEW_COUNT(g_golden_views), renderSierpinskiGoldenView);
+    }
+
+    perf_init(argc, argv);
+
     printf("Sierpinski Triangle Viewer\n");
     printf("Press 'Up' arrow to increase recursion depth.\n");
     printf("Press 'Down' arrow to decrease recursion depth.\n");
     printf("Use Mouse Wheel to zoom in/out.\n");
     printf("Click and Drag with Left Mouse Button to pan.\n");
     printf("Press 'R' to reset zoom, pan, and depth.\n");
+    printf("Press 'F' to toggle filled (per-pixel) rendering.\n");
+    printf("Press 'F1' to toggle the performance HUD.\n");
     printf("Click 'Screenshot' button in top-right to save an image.\n");
     printf("Current Depth: %d\n", MAX_RECURSION_DEPTH);
 
@@ -181,6 +720,40 @@ int main() {
         printf("Failed to load font! SDL_ttf Error: %s\n", TTF_GetError());
     }
 
+    // The triangle is drawn into this texture and only redrawn when depth, zoom or
+    // pan change; idle frames just copy it
+    SDL_Texture* sierpinski_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                                        SDL_TEXTUREACCESS_TARGET, WIDTH, HEIGHT);
+    if (sierpinski_texture == NULL) {
+        printf("Failed to create the Sierpinski texture! SDL_Error: %s\n", SDL_GetError());
+        if (font != NULL) TTF_CloseFont(font);
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(pwindow);
+        TTF_Quit();
+        SDL_Quit();
+        return 1;
+    }
+    SDL_Texture* filled_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                                    SDL_TEXTUREACCESS_STREAMING, WIDTH, HEIGHT);
+    g_sierpinski_pixels = (uint32_t*)malloc(sizeof(uint32_t) * WIDTH * HEIGHT);
+    if (filled_texture == NULL || g_sierpinski_pixels == NULL) {
+        printf("Failed to create the filled-mode buffers! SDL_Error: %s\n", SDL_GetError());
+        free(g_sierpinski_pixels);
+        if (filled_texture != NULL) SDL_DestroyTexture(filled_texture);
+        SDL_DestroyTexture(sierpinski_texture);
+        if (font != NULL) TTF_CloseFont(font);
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(pwindow);
+        TTF_Quit();
+        SDL_Quit();
+        return 1;
+    }
+    bool needs_redraw = true;
+
+    g_sierpinski_thread_count = SDL_GetCPUCount();
+    if (g_sierpinski_thread_count < 1) g_sierpinski_thread_count = 1;
+    if (g_sierpinski_thread_count > SIERPINSKI_MAX_THREADS) g_sierpinski_thread_count = SIERPINSKI_MAX_THREADS;
+
     // Define the screenshot button's position and size
     SDL_Rect screenshotButtonRect = {WIDTH - 120, 10, 110, 30};
 
@@ -192,32 +765,43 @@ int main() {
 
     while (application_running) {
         while (SDL_PollEvent(&event)) {
+            if (perf_handle_event(&event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
                     break;
+                case SDL_RENDER_TARGETS_RESET:
+                case SDL_RENDER_DEVICE_RESET:
+                    // Target texture contents are lost
+                    needs_redraw = true;
+                    break;
                 case SDL_KEYDOWN:
                     if (event.key.keysym.sym == SDLK_UP) {
-                        if (current_depth < 9) {
+                        if (current_depth < SIERPINSKI_DEPTH_LIMIT) {
                             current_depth++;
+                            needs_redraw = true;
                             printf("Current Depth: %d\n", current_depth);
                         } else {
-                            printf("Max depth reached (9).\n");
+                            printf("Max depth reached (%d).\n", SIERPINSKI_DEPTH_LIMIT);
                         }
                     } else if (event.key.keysym.sym == SDLK_DOWN) {
                         if (current_depth > 0) {
                             current_depth--;
+                            needs_redraw = true;
                             printf("Current Depth: %d\n", current_depth);
                         } else {
                             printf("Min depth reached (0).\n");
                         }
                     } else if (event.key.keysym.sym == SDLK_r) {
                         // Reset zoom, pan, and depth
-                        g_zoom = 1.0;
-                        g_offset_x = 0.0;
-                        g_offset_y = 0.0;
+                        resetSierpinskiView();
                         current_depth = MAX_RECURSION_DEPTH;
+                        needs_redraw = true;
                         printf("Resetting zoom, pan, and depth.\n");
+                    } else if (event.key.keysym.sym == SDLK_f) {
+                        g_sierpinski_filled = !g_sierpinski_filled;
+                        needs_redraw = true;
+                        printf("Filled rendering: %s\n", g_sierpinski_filled ? "on" : "off");
                     }
                     break;
                 case SDL_MOUSEWHEEL:
@@ -227,14 +811,11 @@ int main() {
                         SDL_GetMouseState(&mouse_x, &mouse_y);
 
                         if (event.wheel.y > 0) { // Scroll up (zoom in)
-                            g_offset_x = mouse_x - ((mouse_x - g_offset_x) * zoom_factor);
-                            g_offset_y = mouse_y - ((mouse_y - g_offset_y) * zoom_factor);
-                            g_zoom *= zoom_factor;
+                            deep_view_zoom(&g_view, mouse_x, mouse_y, zoom_factor);
                         } else if (event.wheel.y < 0) { // Scroll down (zoom out)
-                            g_offset_x = mouse_x - ((mouse_x - g_offset_x) / zoom_factor);
-                            g_offset_y = mouse_y - ((mouse_y - g_offset_y) / zoom_factor);
-                            g_zoom /= zoom_factor;
+                            deep_view_zoom(&g_view, mouse_x, mouse_y, 1.0 / zoom_factor);
                         }
+                        needs_redraw = true;
                     }
                     break;
                 case SDL_MOUSEBUTTONDOWN:
@@ -243,7 +824,9 @@ int main() {
                             event.button.x <= screenshotButtonRect.x + screenshotButtonRect.w &&
                             event.button.y >= screenshotButtonRect.y &&
                             event.button.y <= screenshotButtonRect.y + screenshotButtonRect.h) {
+                            Uint64 trace_start = trace_begin();
                             saveScreenshot(renderer, "sierpinski_screenshot.bmp");
+                            trace_end("screenshot", trace_start);
                         } else {
                             g_is_panning = true;
                             g_mouse_down_x = event.button.x;
@@ -258,29 +841,41 @@ int main() {
                     break;
                 case SDL_MOUSEMOTION:
                     if (g_is_panning) {
-                        g_offset_x += (event.motion.x - g_mouse_down_x);
-                        g_offset_y += (event.motion.y - g_mouse_down_y);
+                        deep_view_pan(&g_view, event.motion.x - g_mouse_down_x, event.motion.y - g_mouse_down_y);
                         g_mouse_down_x = event.motion.x;
                         g_mouse_down_y = event.motion.y;
+                        needs_redraw = true;
                     }
                     break;
             }
         }
 
-        // Clear the screen
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
-
-        // Define the initial outer equilateral triangle vertices
-        double side_length = 700.0; // Size of the base triangle
-        Point p1 = {WIDTH / 2.0, 50.0}; // Top vertex
-        Point p2 = {WIDTH / 2.0 - side_length / 2.0, 50.0 + side_length * sqrt(3.0) / 2.0}; // Bottom-left vertex
-        Point p3 = {WIDTH / 2.0 + side_length / 2.0, 50.0 + side_length * sqrt(3.0) / 2.0}; // Bottom-right vertex
-
-        // Draw the Sierpinski triangle
-        drawSierpinskiTriangle(renderer, p1, p2, p3, current_depth, current_depth);
+        if (needs_redraw && g_sierpinski_filled) {
+            drawSierpinskiFilled(filled_texture, current_depth);
+            needs_redraw = false;
+        } else if (needs_redraw) {
+            SDL_SetRenderTarget(renderer, sierpinski_texture);
+
+            // Clear the screen
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+            SDL_RenderClear(renderer);
+
+            // Draw the Sierpinski triangle
+            perf_begin(PERF_COMPUTE);
+            drawSierpinskiTriangle(&g_line_batch, renderer, current_depth);
+            perf_end(PERF_COMPUTE);
+            perf_add_iterations(g_sierpinski_nodes);
+            perf_add_pixels(g_line_batch.segments + g_sierpinski_dot_count);
+
+            SDL_SetRenderTarget(renderer, NULL);
+            needs_redraw = false;
+        }
+        perf_begin(PERF_DRAW);
+        SDL_RenderCopy(renderer, g_sierpinski_filled ? filled_texture : sierpinski_texture, NULL, NULL);
+        perf_end(PERF_DRAW);
 
         // Render current depth and zoom level
+        perf_begin(PERF_TEXT);
         if (font != NULL) {
             char text_buffer[100];
             SDL_Color textColor = {255, 255, 255, 255};
@@ -288,7 +883,12 @@ int main() {
             snprintf(text_buffer, sizeof(text_buffer), "Depth: %d", current_depth);
             renderText(renderer, font, text_buffer, 10, 10, textColor);
 
-            snprintf(text_buffer, sizeof(text_buffer), "Zoom: %.2fx", g_zoom);
+            double zoom_log10 = deep_view_zoom_log10(&g_view, 700.0);
+            if (zoom_log10 < 6.0) {
+                snprintf(text_buffer, sizeof(text_buffer), "Zoom: %.2fx", pow(10.0, zoom_log10));
+            } else {
+                snprintf(text_buffer, sizeof(text_buffer), "Zoom: 10^%.1fx", zoom_log10);
+            }
             renderText(renderer, font, text_buffer, 10, 40, textColor);
 
             // Draw and render text for the screenshot button
@@ -300,11 +900,24 @@ int main() {
             SDL_Color buttonTextColor = {255, 255, 255, 255}; 
             renderText(renderer, font, "Save", screenshotButtonRect.x + 8, screenshotButtonRect.y + 5, buttonTextColor);
         }
+        perf_end(PERF_TEXT);
+        perf_draw_hud(renderer, font);
 
+        perf_begin(PERF_PRESENT);
         SDL_RenderPresent(renderer);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
     }
 
     // --- Cleanup ---
+    perf_shutdown();
+    for (int list = 0; list < SIERPINSKI_LIST_LEVELS; ++list) {
+        free(g_sierpinski_levels[list].triangles);
+    }
+    free(g_sierpinski_dots);
+    free(g_sierpinski_pixels);
+    SDL_DestroyTexture(filled_texture);
+    SDL_DestroyTexture(sierpinski_texture);
     if (font != NULL) {
         TTF_CloseFont(font);
     }
@@ -0,0 +1,214 @@
+#ifndef TILEEXPORT_H
+#define TILEEXPORT_H
+
+// Strip-streamed poster export for the escape-time fractals.
+//
+// The image is computed in horizontal strips whose height is chosen so that
+// the strip buffer never exceeds the memory budget. Each finished strip is
+// appended to a binary PPM (P6) file, so peak memory stays constant no matter
+// how large the output is (e.g. 50000x50000).
+//
+// Usage from the command line of any escape-time program:
+//   bin/mandelbrot --export 50000x50000 poster.ppm [--budget-mb 256]
+//                  [--supersample 2] [--iterations 2000]
+//                  [--view re_min re_max im_min im_max]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define EXPORT_DEFAULT_BUDGET_MB 64
+#define EXPORT_MAX_SUPERSAMPLE 8
+
+// Returns the ARGB colour of the fractal at plane coordinate (x, y)
+typedef uint32_t (*ExportPixelFunc)(double x, double y);
+
+typedef struct {
+    const char* filename;
+    int width;
+    int height;
+    int supersample;     // Samples per axis per pixel (1 = off)
+    size_t budget_bytes; // Upper bound for the strip buffer
+    int max_iterations;
+    double x_min, x_max; // Plane bounds mapped onto the full image
+    double y_min, y_max;
+} ExportJob;
+
+static ExportJob export_default_job(double x_min, double x_max, double y_min, double y_max, int max_iterations) {
+    ExportJob job;
+    job.filename = NULL;
+    job.width = 0;
+    job.height = 0;
+    job.supersample = 1;
+    job.budget_bytes = (size_t)EXPORT_DEFAULT_BUDGET_MB * 1024 * 1024;
+    job.max_iterations = max_iterations;
+    job.x_min = x_min;
+    job.x_max = x_max;
+    job.y_min = y_min;
+    job.y_max = y_max;
+    return job;
+}
+
+static void export_print_usage(const char* program) {
+    fprintf(stderr, "Usage: %s --export WIDTHxHEIGHT FILE.ppm [--budget-mb N] [--supersample N]\n"
+                    "       [--iterations N] [--view X_MIN X_MAX Y_MIN Y_MAX]\n", program);
+}
+
+// Parses the export options.
+// Returns 0 if no export was requested, 1 if 'job' holds a valid export, -1 on bad arguments.
+static int export_parse_args(int argc, char* argv[], ExportJob* job) {
+    int export_index = -1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--export") == 0) {
+            export_index = i;
+            break;
+        }
+    }
+    if (export_index < 0) {
+        return 0;
+    }
+
+    if (export_index + 2 >= argc ||
+        sscanf(argv[export_index + 1], "%dx%d", &job->width, &job->height) != 2 ||
+        job->width <= 0 || job->height <= 0) {
+        export_print_usage(argv[0]);
+        return -1;
+    }
+    job->filename = argv[export_index + 2];
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--budget-mb") == 0 && i + 1 < argc) {
+            long budget_mb = strtol(argv[++i], NULL, 10);
+            if (budget_mb < 1) budget_mb = 1;
+            job->budget_bytes = (size_t)budget_mb * 1024 * 1024;
+        } else if (strcmp(argv[i], "--supersample") == 0 && i + 1 < argc) {
+            job->supersample = atoi(argv[++i]);
+            if (job->supersample < 1) job->supersample = 1;
+            if (job->supersample > EXPORT_MAX_SUPERSAMPLE) job->supersample = EXPORT_MAX_SUPERSAMPLE;
+        } else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            job->max_iterations = atoi(argv[++i]);
+            if (job->max_iterations < 1) job->max_iterations = 1;
+        } else if (strcmp(argv[i], "--view") == 0 && i + 4 < argc) {
+            job->x_min = atof(argv[++i]);
+            job->x_max = atof(argv[++i]);
+            job->y_min = atof(argv[++i]);
+            job->y_max = atof(argv[++i]);
+        }
+    }
+    return 1;
+}
+
+// Widens the shorter side of the view so the output keeps square pixels
+static void export_fit_aspect(ExportJob* job) {
+    double view_width = job->x_max - job->x_min;
+    double view_height = job->y_max - job->y_min;
+    double image_aspect = (double)job->width / job->height;
+
+    if (view_width / view_height < image_aspect) {
+        double center = (job->x_min + job->x_max) / 2.0;
+        view_width = view_height * image_aspect;
+        job->x_min = center - view_width / 2.0;
+        job->x_max = center + view_width / 2.0;
+    } else {
+        double center = (job->y_min + job->y_max) / 2.0;
+        view_height = view_width / image_aspect;
+        job->y_min = center - view_height / 2.0;
+        job->y_max = center + view_height / 2.0;
+    }
+}
+
+// Computes one pixel, averaging supersample x supersample evenly spaced sub-samples
+static void export_shade_pixel(const ExportJob* job, ExportPixelFunc pixel_func, int px, int py, unsigned char* rgb_out) {
+    double pixel_w = (job->x_max - job->x_min) / job->width;
+    double pixel_h = (job->y_max - job->y_min) / job->height;
+    int ss = job->supersample;
+
+    if (ss == 1) {
+        uint32_t argb = pixel_func(job->x_min + px * pixel_w, job->y_min + py * pixel_h);
+        rgb_out[0] = (argb >> 16) & 0xFF;
+        rgb_out[1] = (argb >> 8) & 0xFF;
+        rgb_out[2] = argb & 0xFF;
+        return;
+    }
+
+    unsigned int sum_r = 0, sum_g = 0, sum_b = 0;
+    for (int sy = 0; sy < ss; ++sy) {
+        for (int sx = 0; sx < ss; ++sx) {
+            double x = job->x_min + (px + (sx + 0.5) / ss - 0.5) * pixel_w;
+            double y = job->y_min + (py + (sy + 0.5) / ss - 0.5) * pixel_h;
+            uint32_t argb = pixel_func(x, y);
+            sum_r += (argb >> 16) & 0xFF;
+            sum_g += (argb >> 8) & 0xFF;
+            sum_b += argb & 0xFF;
+        }
+    }
+    unsigned int samples = (unsigned int)(ss * ss);
+    rgb_out[0] = (unsigned char)((sum_r + samples / 2) / samples);
+    rgb_out[1] = (unsigned char)((sum_g + samples / 2) / samples);
+    rgb_out[2] = (unsigned char)((sum_b + samples / 2) / samples);
+}
+
+// Renders the job strip by strip and streams it to disk. Returns 0 on success.
+static int export_run(ExportJob* job, ExportPixelFunc pixel_func) {
+    export_fit_aspect(job);
+
+    size_t row_bytes = (size_t)job->width * 3;
+    int strip_rows = (int)(job->budget_bytes / row_bytes);
+    if (strip_rows < 1) strip_rows = 1;
+    if (strip_rows > job->height) strip_rows = job->height;
+
+    unsigned char* strip = (unsigned char*)malloc(row_bytes * strip_rows);
+    if (strip == NULL) {
+        fprintf(stderr, "Failed to allocate %zu byte export strip.\n", row_bytes * strip_rows);
+        return 1;
+    }
+
+    FILE* file = fopen(job->filename, "wb");
+    if (file == NULL) {
+        perror("Failed to open export file");
+        free(strip);
+        return 1;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", job->width, job->height);
+
+    printf("Exporting %dx%d to %s (%d rows per strip, %zu KB buffer, %dx%d supersampling)\n",
+           job->width, job->height, job->filename, strip_rows, row_bytes * strip_rows / 1024,
+           job->supersample, job->supersample);
+    printf("View: X:[%.17g, %.17g], Y:[%.17g, %.17g], Iterations: %d\n",
+           job->x_min, job->x_max, job->y_min, job->y_max, job->max_iterations);
+
+    int status = 0;
+    for (int strip_y = 0; strip_y < job->height; strip_y += strip_rows) {
+        int rows = strip_rows;
+        if (strip_y + rows > job->height) rows = job->height - strip_y;
+
+        for (int row = 0; row < rows; ++row) {
+            unsigned char* out = strip + (size_t)row * row_bytes;
+            for (int px = 0; px < job->width; ++px) {
+                export_shade_pixel(job, pixel_func, px, strip_y + row, out + (size_t)px * 3);
+            }
+        }
+
+        if (fwrite(strip, row_bytes, rows, file) != (size_t)rows) {
+            perror("Failed to write export strip");
+            status = 1;
+            break;
+        }
+        printf("  rows %d-%d of %d written (%.1f%%)\n", strip_y, strip_y + rows - 1, job->height,
+               100.0 * (strip_y + rows) / job->height);
+    }
+
+    if (fclose(file) != 0 && status == 0) {
+        perror("Failed to close export file");
+        status = 1;
+    }
+    free(strip);
+
+    if (status == 0) {
+        printf("Export complete: %s\n", job->filename);
+    }
+    return status;
+}
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Chrome trace-event export of timed scopes.
+//
+// When recording, every timed scope (the perf HUD phases, screenshots and any
+// trace_begin()/trace_end() pair) is stored as a complete ("X") event. At exit
+// the session is written as trace-event JSON that chrome://tracing and
+// https://ui.perfetto.dev open directly. Events carry the SDL thread id, so
+// worker threads show up as their own lanes next to the main thread.
+//
+// Recording starts with --trace FILE, or at runtime with F2 (written to
+// trace.json unless a file was given). Timestamps use the SDL performance
+// counter; nothing is recorded while tracing is off.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#define TRACE_DEFAULT_FILE "trace.json"
+#define TRACE_INITIAL_EVENTS 4096
+#define TRACE_MAX_EVENTS (1 << 21)  // About 48 MB; later events are dropped
+#define TRACE_MAX_THREADS 64
+
+typedef struct {
+    const char* name;  // Must be a string literal (stored by pointer)
+    Uint64 start;
+    Uint64 end;
+    int lane;
+} TraceEvent;
+
+typedef struct {
+    int enabled;
+    const char* filename;
+    TraceEvent* events;
+    int event_count;
+    int event_capacity;
+    long dropped_events;
+    Uint64 session_start;
+    SDL_SpinLock lock;  // Guards everything below 'enabled' once worker threads record
+    SDL_threadID thread_ids[TRACE_MAX_THREADS];
+    char thread_names[TRACE_MAX_THREADS][32];
+    int thread_count;
+} TraceLog;
+
+static TraceLog g_trace;
+
+// Parses --trace FILE. The calling thread becomes the "main" lane.
+static inline void trace_init(int argc, char* argv[]) {
+    memset(&g_trace, 0, sizeof(g_trace));
+    g_trace.filename = TRACE_DEFAULT_FILE;
+    g_trace.session_start = SDL_GetPerformanceCounter();
+    g_trace.thread_ids[0] = SDL_ThreadID();
+    snprintf(g_trace.thread_names[0], sizeof(g_trace.thread_names[0]), "main");
+    g_trace.thread_count = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            g_trace.filename = argv[++i];
+            g_trace.enabled = 1;
+        }
+    }
+}
+
+// Lane of the calling thread, registering it on first use. Call with the lock held.
+static inline int trace_lane_locked(void) {
+    SDL_threadID id = SDL_ThreadID();
+    for (int i = 0; i < g_trace.thread_count; ++i) {
+        if (g_trace.thread_ids[i] == id) return i;
+    }
+    if (g_trace.thread_count == TRACE_MAX_THREADS) {
+        return TRACE_MAX_THREADS - 1;
+    }
+    int lane = g_trace.thread_count++;
+    g_trace.thread_ids[lane] = id;
+    snprintf(g_trace.thread_names[lane], sizeof(g_trace.thread_names[lane]), "thread %d", lane);
+    return lane;
+}
+
+// Names the lane of the calling thread, e.g. "worker 3"
+static inline void trace_set_thread_name(const char* name) {
+    SDL_AtomicLock(&g_trace.lock);
+    int lane = trace_lane_locked();
+    snprintf(g_trace.thread_names[lane], sizeof(g_trace.thread_names[lane]), "%s", name);
+    SDL_AtomicUnlock(&g_trace.lock);
+}
+
+// Stores one complete event. Safe to call from worker threads.
+static inline void trace_record(const char* name, Uint64 start, Uint64 end) {
+    if (!g_trace.enabled) {
+        return;
+    }
+    SDL_AtomicLock(&g_trace.lock);
+    if (g_trace.event_count == g_trace.event_capacity) {
+        int capacity = g_trace.event_capacity == 0 ? TRACE_INITIAL_EVENTS : g_trace.event_capacity * 2;
+        TraceEvent* events = NULL;
+        if (capacity <= TRACE_MAX_EVENTS) {
+            events = (TraceEvent*)realloc(g_trace.events, (size_t)capacity * sizeof(TraceEvent));
+        }
+        if (events == NULL) {
+            g_trace.dropped_events++;
+            SDL_AtomicUnlock(&g_trace.lock);
+            return;
+        }
+        g_trace.events = events;
+        g_trace.event_capacity = capacity;
+    }
+    TraceEvent* event = &g_trace.events[g_trace.event_count++];
+    event->name = name;
+    event->start = start;
+    event->end = end;
+    event->lane = trace_lane_locked();
+    SDL_AtomicUnlock(&g_trace.lock);
+}
+
+// Scoped marker: Uint64 t = trace_begin(); ... trace_end("name", t);
+static inline Uint64 trace_begin(void) {
+    return g_trace.enabled ? SDL_GetPerformanceCounter() : 0;
+}
+
+static inline void trace_end(const char* name, Uint64 start) {
+    if (start != 0) {
+        trace_record(name, start, SDL_GetPerformanceCounter());
+    }
+}
+
+static inline void trace_toggle(void) {
+    g_trace.enabled = !g_trace.enabled;
+    printf("Trace recording %s (%d events so far, written to %s on exit)\n",
+           g_trace.enabled ? "started" : "paused", g_trace.event_count, g_trace.filename);
+}
+
+static inline double trace_us(Uint64 counter) {
+    return (double)(counter - g_trace.session_start) * 1e6 / (double)SDL_GetPerformanceFrequency();
+}
+
+// Writes the recorded events as trace-event JSON. Returns 0 on success.
+static inline int trace_write(const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (file == NULL) {
+        perror("Failed to open trace file");
+        return 1;
+    }
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"fractal\"}}");
+    for (int i = 0; i < g_trace.thread_count; ++i) {
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                i, g_trace.thread_names[i]);
+    }
+    for (int i = 0; i < g_trace.event_count; ++i) {
+        const TraceEvent* event = &g_trace.events[i];
+        double start_us = trace_us(event->start);
+        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                event->name, event->lane, start_us, trace_us(event->end) - start_us);
+    }
+    fprintf(file, "\n]}\n");
+    if (fclose(file) != 0) {
+        perror("Failed to close trace file");
+        return 1;
+    }
+    printf("Trace with %d events written to %s", g_trace.event_count, filename);
+    if (g_trace.dropped_events > 0) {
+        printf(" (%ld events dropped)", g_trace.dropped_events);
+    }
+    printf("\n");
+    return 0;
+}
+
+static inline void trace_shutdown(void) {
+    g_trace.enabled = 0;
+    if (g_trace.event_count > 0) {
+        trace_write(g_trace.filename);
+    }
+    free(g_trace.events);
+    g_trace.events = NULL;
+    g_trace.event_count = 0;
+    g_trace.event_capacity = 0;
+}
+
+#endif
@@ -5,6 +5,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include "tileexport.h"
+#include "golden.h"
+#include "perfhud.h"
 
 // Initial Window dimensions
 #define INITIAL_WIDTH 800
@@ -45,8 +48,8 @@ void map_complex_to_pixel(double c_re, double c_im, int* px, int* py, int textur
     *py = (int)round(texture_height / 2.0 + (c_im - g_view_center_im) * g_view_scale);
 }
 
-SDL_Color getColor(int iterations) {
-    if (iterations == MAX_ITERATIONS) {
+SDL_Color getColor(int iterations, int max_iterations) {
+    if (iterations == max_iterations) {
         return (SDL_Color){0, 0, 0, 255};
     }
 
@@ -120,6 +123,48 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename, int window_wid
     SDL_FreeSurface(screenshot);
 }
 
+// Returns the number of iterations before the orbit of c = c_re + i*c_im escapes
+int tricornIterations(double c_re, double c_im, int max_iterations) {
+    double z_re = 0.0; // Initial z_re (a)
+    double z_im = 0.0; // Initial z_im (b)
+    double z_re_squared; // For optimization: z_re*z_re
+    double z_im_squared; // For optimization: z_im*z_im
+
+    int iterations = 0;
+    while (iterations < max_iterations) {
+        z_re_squared = z_re * z_re;
+        z_im_squared = z_im * z_im;
+
+        if (z_re_squared + z_im_squared > BAILOUT_RADIUS_SQUARED) {
+            break;
+        }
+
+        double next_z_re = z_re_squared - z_im_squared + c_re;
+        double next_z_im = -2.0 * z_re * z_im + c_im;
+
+        z_re = next_z_re;
+        z_im = next_z_im;
+
+        iterations++;
+    }
+    return iterations;
+}
+
+// Iteration limit used by the strip exporter (--iterations)
+int g_export_max_iterations = MAX_ITERATIONS;
+
+// ARGB colour of a single point, used by the strip exporter
+uint32_t tricornPixel(double c_re, double c_im) {
+    SDL_Color color = getColor(tricornIterations(c_re, c_im, g_export_max_iterations), g_export_max_iterations);
+    return (color.a << 24) | (color.r << 16) | (color.g << 8) | color.b;
+}
+
+// Fixed views pinned by 'make golden' (name, x_min, x_max, y_min, y_max, iterations)
+const GoldenView g_golden_views[] = {
+    {"full", -2.0, 2.0, -1.5, 1.5, 200},
+    {"edge", -1.6, -1.0, -0.225, 0.225, 500},
+};
+
 // --- Function to draw the Tricorn fractal onto g_fractal_texture ---
 void drawTricornToTexture() {
     if (!g_renderer || !g_fractal_texture) {
@@ -133,6 +178,13 @@ void drawTricornToTexture() {
     int texture_width, texture_height;
     SDL_QueryTexture(g_fractal_texture, NULL, NULL, &texture_width, &texture_height);
 
+    char view[160];
+    snprintf(view, sizeof(view), "center:(%.10g, %.10g) scale:%.6g it=%d",
+             g_view_center_re, g_view_center_im, g_view_scale, MAX_ITERATIONS);
+    perf_set_view(view);
+    perf_begin(PERF_COMPUTE);
+    long long total_iterations = 0;
+
     SDL_SetRenderTarget(g_renderer, g_fractal_texture);
     SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 255);
     SDL_RenderClear(g_renderer);
@@ -143,30 +195,10 @@ void drawTricornToTexture() {
             double c_re, c_im;
             map_pixel_to_complex(px, py, &c_re, &c_im, texture_width, texture_height);
 
-            double z_re = 0.0; // Initial z_re (a)
-            double z_im = 0.0; // Initial z_im (b)
-            double z_re_squared; // For optimization: z_re*z_re
-            double z_im_squared; // For optimization: z_im*z_im
-
-            int iterations = 0;
-            while (iterations < MAX_ITERATIONS) {
-                z_re_squared = z_re * z_re;
-                z_im_squared = z_im * z_im;
-
-                if (z_re_squared + z_im_squared > BAILOUT_RADIUS_SQUARED) {
-                    break;
-                }
-
-                double next_z_re = z_re_squared - z_im_squared + c_re;
-                double next_z_im = -2.0 * z_re * z_im + c_im;
-
-                z_re = next_z_re;
-                z_im = next_z_im;
+            int iterations = tricornIterations(c_re, c_im, MAX_ITERATIONS);
+            total_iterations += iterations;
 
-                iterations++;
-            }
-
-            SDL_Color color = getColor(iterations);
+            SDL_Color color = getColor(iterations, MAX_ITERATIONS);
             SDL_SetRenderDrawColor(g_renderer, color.r, color.g, color.b, color.a);
             SDL_RenderDrawPoint(g_renderer, px, py);
         }
@@ -174,6 +206,9 @@ void drawTricornToTexture() {
 
     // Restore default render target
     SDL_SetRenderTarget(g_renderer, NULL);
+    perf_end(PERF_COMPUTE);
+    perf_add_iterations(total_iterations);
+    perf_add_pixels((long long)texture_width * texture_height);
     printf("Tricorn fractal drawing to texture complete.\n");
 }
 
@@ -187,10 +222,33 @@ void reset_view() {
 }
 
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Golden-image regression check: render the fixed views headlessly and compare
+    GoldenOptions golden_options;
+    int golden_status = golden_parse_args(argc, argv, &golden_options);
+    if (golden_status != 0) {
+        if (golden_status < 0) return 1;
+        return golden_run(&golden_options, "tricorn", g_golden_views, GOLDEN_VIEW_COUNT(g_golden_views), tricornIterations);
+    }
+
+    // Headless poster export: render straight to disk without opening a window
+    double half_width = INITIAL_WIDTH / 2.0 / g_view_scale;
+    double half_height = INITIAL_HEIGHT / 2.0 / g_view_scale;
+    ExportJob export_job = export_default_job(g_view_center_re - half_width, g_view_center_re + half_width,
+                                              g_view_center_im - half_height, g_view_center_im + half_height,
+                                              MAX_ITERATIONS);
+    int export_status = export_parse_args(argc, argv, &export_job);
+    if (export_status != 0) {
+        if (export_status < 0) return 1;
+        g_export_max_iterations = export_job.max_iterations;
+        return export_run(&export_job, tricornPixel);
+    }
+    perf_init(argc, argv);
+
     printf("Left Click + Drag: Pan the view\n");
     printf("Mouse Wheel: Zoom in/out\n");
     printf("R: Reset View\n");
+    printf("F1: Toggle performance HUD\n");
     printf("Click 'Save' button to save an image.\n");
 
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -267,6 +325,7 @@ int main() {
         screenshotButtonRect = (SDL_Rect){current_window_width - 120, 10, 110, 30};
 
         while (SDL_PollEvent(&event)){
+            if (perf_handle_event(&event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
@@ -300,7 +359,9 @@ int main() {
                             mouseX <= screenshotButtonRect.x + screenshotButtonRect.w &&
                             mouseY >= screenshotButtonRect.y &&
                             mouseY <= screenshotButtonRect.y + screenshotButtonRect.h) {
+                            Uint64 trace_start = trace_begin();
                             saveScreenshot(g_renderer, "tricorn_fractal_screenshot.bmp", current_window_width, current_window_height);
+                            trace_end("screenshot", trace_start);
                         } else if (event.button.button == SDL_BUTTON_LEFT) {
                             g_is_panning = true;
                             g_last_mouse_x = mouseX;
@@ -370,9 +431,12 @@ int main() {
         }
 
         // --- Rendering ---
+        perf_begin(PERF_DRAW);
         SDL_RenderCopy(g_renderer, g_fractal_texture, NULL, NULL);
+        perf_end(PERF_DRAW);
 
         // Render UI elements on top
+        perf_begin(PERF_TEXT);
         if (g_font != NULL) {
             char text_buffer[200];
             SDL_Color textColor = {255, 255, 255, 255};
@@ -397,11 +461,17 @@ int main() {
             SDL_Color buttonTextColor = {255, 255, 255, 255};
             renderText(g_renderer, g_font, "Save", screenshotButtonRect.x + 8, screenshotButtonRect.y + 5, buttonTextColor);
         }
+        perf_end(PERF_TEXT);
+        perf_draw_hud(g_renderer, g_font);
 
+        perf_begin(PERF_PRESENT);
         SDL_RenderPresent(g_renderer);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
     }
 
     // --- Cleanup ---
+    perf_shutdown();
     if (g_fractal_texture != NULL) {
         SDL_DestroyTexture(g_fractal_texture);
     }
@@ -0,0 +1,230 @@
+#ifndef VECMATH_H
+#define VECMATH_H
+
+// 4x4 matrices and batched point transforms for the 3D viewers.
+//
+// Matrices act on column vectors (p' = M p) and are stored by columns, 16-byte
+// aligned, so with SSE a matrix-vector product is four broadcast multiply-adds.
+// Rotations are built once per frame by mat4_rotation_*(), which is the only place
+// that evaluates sin and cos; everything per point is multiply-adds.
+//
+// Points that are transformed in bulk are kept as a structure of arrays (VecSoA).
+// mat4_transform_points() then handles four points per SSE instruction, with the
+// matrix entries broadcast across the lanes. Without SSE the same functions run as
+// scalar loops and give the same results up to rounding.
+//
+// Functions are 'static inline' like perfhud.h.
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define VECMATH_SSE 1
+#endif
+
+typedef struct {
+    _Alignas(16) float c[4][4];  // c[column][row]
+} Mat4;
+
+// Points as separate coordinate arrays. The arrays are 16-byte aligned and their
+// capacity is a multiple of four.
+typedef struct {
+    float* x;
+    float* y;
+    float* z;
+    float* w;
+    int count;
+    int capacity;
+} VecSoA;
+
+static inline void mat4_identity(Mat4* m) {
+    for (int col = 0; col < 4; ++col) {
+        for (int row = 0; row < 4; ++row) {
+            m->c[col][row] = col == row ? 1.0f : 0.0f;
+        }
+    }
+}
+
+static inline void mat4_translation(Mat4* m, float x, float y, float z) {
+    mat4_identity(m);
+    m->c[3][0] = x;
+    m->c[3][1] = y;
+    m->c[3][2] = z;
+}
+
+static inline void mat4_scale(Mat4* m, float x, float y, float z) {
+    mat4_identity(m);
+    m->c[0][0] = x;
+    m->c[1][1] = y;
+    m->c[2][2] = z;
+}
+
+// Right-handed rotations by 'angle' radians about the x, y and z axes
+static inline void mat4_rotation_x(Mat4* m, double angle) {
+    float c = (float)cos(angle), s = (float)sin(angle);
+    mat4_identity(m);
+    m->c[1][1] = c;  m->c[2][1] = -s;
+    m->c[1][2] = s;  m->c[2][2] = c;
+}
+
+static inline void mat4_rotation_y(Mat4* m, double angle) {
+    float c = (float)cos(angle), s = (float)sin(angle);
+    mat4_identity(m);
+    m->c[0][0] = c;  m->c[2][0] = s;
+    m->c[0][2] = -s; m->c[2][2] = c;
+}
+
+static inline void mat4_rotation_z(Mat4* m, double angle) {
+    float c = (float)cos(angle), s = (float)sin(angle);
+    mat4_identity(m);
+    m->c[0][0] = c;  m->c[1][0] = -s;
+    m->c[0][1] = s;  m->c[1][1] = c;
+}
+
+// Perspective projection with w = z: x and y are scaled by x_scale and y_scale, and
+// z runs from 0 at z_near to w at z_far
+static inline void mat4_perspective(Mat4* m, float x_scale, float y_scale, float z_near, float z_far) {
+    for (int col = 0; col < 4; ++col) {
+        for (int row = 0; row < 4; ++row) {
+            m->c[col][row] = 0.0f;
+        }
+    }
+    m->c[0][0] = x_scale;
+    m->c[1][1] = y_scale;
+    m->c[2][2] = z_far / (z_far - z_near);
+    m->c[3][2] = -z_far * z_near / (z_far - z_near);
+    m->c[2][3] = 1.0f;
+}
+
+// out = a * b, i.e. b is applied first. 'out' may be 'a' or 'b'.
+static inline void mat4_multiply(Mat4* out, const Mat4* a, const Mat4* b) {
+    Mat4 result;
+#ifdef VECMATH_SSE
+    __m128 a0 = _mm_load_ps(a->c[0]), a1 = _mm_load_ps(a->c[1]);
+    __m128 a2 = _mm_load_ps(a->c[2]), a3 = _mm_load_ps(a->c[3]);
+    for (int col = 0; col < 4; ++col) {
+        __m128 sum = _mm_mul_ps(a0, _mm_set1_ps(b->c[col][0]));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_set1_ps(b->c[col][1])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_set1_ps(b->c[col][2])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(a3, _mm_set1_ps(b->c[col][3])));
+        _mm_store_ps(result.c[col], sum);
+    }
+#else
+    for (int col = 0; col < 4; ++col) {
+        for (int row = 0; row < 4; ++row) {
+            result.c[col][row] = a->c[0][row] * b->c[col][0] + a->c[1][row] * b->c[col][1] +
+                                 a->c[2][row] * b->c[col][2] + a->c[3][row] * b->c[col][3];
+        }
+    }
+#endif
+    *out = result;
+}
+
+// Transforms one vector (x, y, z, w); out receives x, y, z, w
+static inline void mat4_transform(const Mat4* m, float x, float y, float z, float w, float out[4]) {
+#ifdef VECMATH_SSE
+    __m128 sum = _mm_mul_ps(_mm_load_ps(m->c[0]), _mm_set1_ps(x));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(m->c[1]), _mm_set1_ps(y)));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(m->c[2]), _mm_set1_ps(z)));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(m->c[3]), _mm_set1_ps(w)));
+    _mm_storeu_ps(out, sum);
+#else
+    for (int row = 0; row < 4; ++row) {
+        out[row] = m->c[0][row] * x + m->c[1][row] * y + m->c[2][row] * z + m->c[3][row] * w;
+    }
+#endif
+}
+
+static inline void vec_soa_free(VecSoA* points) {
+    free(points->x);  // One block holds all four arrays
+    points->x = points->y = points->z = points->w = NULL;
+    points->count = 0;
+    points->capacity = 0;
+}
+
+// Makes room for 'count' points, keeping the first 'count' of the existing ones
+static inline bool vec_soa_reserve(VecSoA* points, int count) {
+    if (count <= points->capacity) {
+        return true;
+    }
+    int capacity = (count + 3) & ~3;
+    float* block = aligned_alloc(16, (size_t)capacity * 4 * sizeof(float));
+    if (block == NULL) {
+        printf("Failed to allocate %d points.\n", count);
+        return false;
+    }
+    float* arrays[4] = {block, block + capacity, block + 2 * (size_t)capacity, block + 3 * (size_t)capacity};
+    const float* old[4] = {points->x, points->y, points->z, points->w};
+    for (int k = 0; k < 4; ++k) {
+        for (int i = 0; i < points->count; ++i) {
+            arrays[k][i] = old[k][i];
+        }
+    }
+    free(points->x);
+    points->x = arrays[0];
+    points->y = arrays[1];
+    points->z = arrays[2];
+    points->w = arrays[3];
+    points->capacity = capacity;
+    return true;
+}
+
+// Copies 'count' interleaved points (x, y, z at 'xyz', 'stride' floats apart) with w = 1
+static inline bool vec_soa_gather(VecSoA* points, const float* xyz, int stride, int count) {
+    points->count = 0;
+    if (!vec_soa_reserve(points, count)) {
+        return false;
+    }
+    for (int i = 0; i < count; ++i, xyz += stride) {
+        points->x[i] = xyz[0];
+        points->y[i] = xyz[1];
+        points->z[i] = xyz[2];
+        points->w[i] = 1.0f;
+    }
+    points->count = count;
+    return true;
+}
+
+// out = m * in for every point. Returns false if 'out' could not grow.
+static inline bool mat4_transform_points(const Mat4* m, const VecSoA* in, VecSoA* out) {
+    out->count = 0;
+    if (!vec_soa_reserve(out, in->count)) {
+        return false;
+    }
+    int i = 0;
+#ifdef VECMATH_SSE
+    __m128 e[4][4];
+    for (int col = 0; col < 4; ++col) {
+        for (int row = 0; row < 4; ++row) {
+            e[col][row] = _mm_set1_ps(m->c[col][row]);
+        }
+    }
+    for (; i + 4 <= in->count; i += 4) {
+        __m128 x = _mm_load_ps(in->x + i), y = _mm_load_ps(in->y + i);
+        __m128 z = _mm_load_ps(in->z + i), w = _mm_load_ps(in->w + i);
+        float* rows[4] = {out->x + i, out->y + i, out->z + i, out->w + i};
+        for (int row = 0; row < 4; ++row) {
+            __m128 sum = _mm_mul_ps(e[0][row], x);
+            sum = _mm_add_ps(sum, _mm_mul_ps(e[1][row], y));
+            sum = _mm_add_ps(sum, _mm_mul_ps(e[2][row], z));
+            sum = _mm_add_ps(sum, _mm_mul_ps(e[3][row], w));
+            _mm_store_ps(rows[row], sum);
+        }
+    }
+#endif
+    for (; i < in->count; ++i) {
+        float result[4];
+        mat4_transform(m, in->x[i], in->y[i], in->z[i], in->w[i], result);
+        out->x[i] = result[0];
+        out->y[i] = result[1];
+        out->z[i] = result[2];
+        out->w[i] = result[3];
+    }
+    out->count = in->count;
+    return true;
+}
+
+#endif
@@ -4,25 +4,60 @@
 #include <math.h>
 #include <SDL2/SDL_ttf.h>
 #include <string.h>
+#include "perfhud.h"
+#include "deepview.h"
+#include "golden.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VICSEK_SSE2 1
+#endif
 
 #define WIDTH 800
 #define HEIGHT 800
 
 #define MAX_RECURSION_DEPTH 5
 
-typedef struct {
-    double x;
-    double y;
-} Point;
-
-double g_view_x_min = 0.0;
-double g_view_y_min = 0.0;
-double g_view_x_max = (double)WIDTH;
-double g_view_y_max = (double)HEIGHT;
+// Depth the Up arrow can reach. Membership is decided per pixel from the base-3 digits
+// of its coordinates and digits below pixel size are never looked at, so the cost of a
+// frame does not depend on the depth.
+#define VICSEK_DEPTH_LIMIT DEEP_VIEW_MAX_LEVELS
+#define VICSEK_MAX_THREADS 64
+
+// Most levels resolved below the anchor cell (bits of a digit mask)
+#define VICSEK_MASK_LEVELS 56
+
+// Set in a digit mask when the coordinate lies in one of the three anchor cells
+// (offset -1, 0, 1) along its axis
+#define VICSEK_INSIDE_BIT (1ULL << 63)
+#define VICSEK_CELL_BIT(offset) (1ULL << (61 + (offset)))
+
+// The fractal square [0, WIDTH) is the root cell of the camera
+DeepView g_view;
 int g_current_depth = MAX_RECURSION_DEPTH;
 bool g_is_panning = false;
 int g_last_mouse_x, g_last_mouse_y;
 
+int g_vicsek_thread_count = 1;
+// vicsekCellMask() of every pixel column, split into 32-bit words to match the pixel
+// store, so the row fill tests four columns per SSE2 compare
+_Alignas(16) uint32_t g_vicsek_column_low[WIDTH];
+_Alignas(16) uint32_t g_vicsek_column_high[WIDTH];
+
+// g_vicsek_cells[j + 1][i + 1] is true when the cell i, j cells away from the anchor is
+// part of the fractal down to the anchor level
+bool g_vicsek_cells[3][3];
+
+typedef struct {
+    int index;
+    int first_row;
+    int end_row;
+    int levels;
+    uint32_t* pixels;
+    long long filled;
+    double busy_ms;
+} VicsekWorker;
+
 // Function to render text on the screen
 void renderText(SDL_Renderer* renderer, TTF_Font* font, const char* text, int x, int y, SDL_Color color) {
     if (!font) {
@@ -77,82 +112,268 @@ void saveScreenshot(SDL_Renderer* renderer, const char* filename) {
     SDL_FreeSurface(screenshot);
 }
 
-// Recursive function to draw the Vicsek fractal into the pixel buffer
-void drawVicsekFractalRecursive(uint32_t* pixels, Point top_left_fractal_coord, double size_fractal_coord, int depth, SDL_Color color) {
-    // Determine the pixel coordinates corresponding to the current fractal square
-    int px_start = (int)(((top_left_fractal_coord.x - g_view_x_min) / (g_view_x_max - g_view_x_min)) * WIDTH);
-    int py_start = (int)(((top_left_fractal_coord.y - g_view_y_min) / (g_view_y_max - g_view_y_min)) * HEIGHT);
-    int px_end = (int)(((top_left_fractal_coord.x + size_fractal_coord - g_view_x_min) / (g_view_x_max - g_view_x_min)) * WIDTH);
-    int py_end = (int)(((top_left_fractal_coord.y + size_fractal_coord - g_view_y_min) / (g_view_y_max - g_view_y_min)) * HEIGHT);
-
-    // Calculate pixel dimensions
-    int pixel_width = px_end - px_start;
-    int pixel_height = py_end - py_start;
-
-    if (depth == 0 || pixel_width <= 1 || pixel_height <= 1) {
-        if (px_end <= 0 || py_end <= 0 || px_start >= WIDTH || py_start >= HEIGHT) {
-            return;
+// --- Per-Pixel Membership ---
+// A point of the unit square survives level k when its k-th base-3 digit is 1 in x or
+// in y (the middle row or column of the 3x3 grid forms the cross). Bit k - 1 of the mask
+// is set when the k-th digit of t is 1.
+uint64_t vicsekDigitMask(double t, int levels) {
+    if (!(t >= 0.0 && t < 1.0)) {
+        return 0;
+    }
+    uint64_t mask = VICSEK_INSIDE_BIT;
+    for (int k = 0; k < levels; ++k) {
+        t *= 3.0;
+        int digit = (int)t;
+        if (digit > 2) digit = 2;  // Guard against rounding up to 3.0
+        if (digit == 1) {
+            mask |= 1ULL << k;
         }
+        t -= digit;
+    }
+    return mask;
+}
 
-        // Clip to screen bounds
-        int draw_px_start = fmax(0, px_start);
-        int draw_py_start = fmax(0, py_start);
-        int draw_px_end = fmin(WIDTH, px_end);
-        int draw_py_end = fmin(HEIGHT, py_end);
+void resetVicsekView(void) {
+    deep_view_init(&g_view, 3, WIDTH, HEIGHT,
+                   0.0, 1.0 / WIDTH, 0.0,
+                   0.0, 0.0, 1.0 / HEIGHT);
+}
+
+// View bounds in fractal coordinates, rounded to double (for display)
+void getVicsekViewBounds(double* x_min, double* x_max, double* y_min, double* y_max) {
+    deep_view_root(&g_view, g_view.x0, g_view.y0, x_min, y_min);
+    deep_view_root(&g_view, g_view.x0 + WIDTH * g_view.xx, g_view.y0 + HEIGHT * g_view.yy, x_max, y_max);
+    *x_min *= WIDTH; *x_max *= WIDTH;
+    *y_min *= WIDTH; *y_max *= WIDTH;
+}
 
-        uint32_t pixel_color_val = (color.a << 24) | (color.r << 16) | (color.g << 8) | (color.b);
+// The anchor address only needs checking down to the recursion depth
+void classifyVicsekCells(void) {
+    static unsigned char x_digits[3][DEEP_VIEW_MAX_LEVELS];
+    static unsigned char y_digits[3][DEEP_VIEW_MAX_LEVELS];
+    bool x_valid[3], y_valid[3];
+    for (int i = 0; i < 3; ++i) {
+        x_valid[i] = deep_view_neighbor(&g_view, g_view.x_digits, i - 1, x_digits[i]);
+        y_valid[i] = deep_view_neighbor(&g_view, g_view.y_digits, i - 1, y_digits[i]);
+    }
 
-        for (int y_pixel = draw_py_start; y_pixel < draw_py_end; y_pixel++) {
-            for (int x_pixel = draw_px_start; x_pixel < draw_px_end; x_pixel++) {
-                if (x_pixel >= 0 && x_pixel < WIDTH && y_pixel >= 0 && y_pixel < HEIGHT) {
-                    pixels[y_pixel * WIDTH + x_pixel] = pixel_color_val;
-                }
+    int prefix = g_view.levels < g_current_depth ? g_view.levels : g_current_depth;
+    for (int j = 0; j < 3; ++j) {
+        for (int i = 0; i < 3; ++i) {
+            bool member = x_valid[i] && y_valid[j];
+            for (int k = 0; member && k < prefix; ++k) {
+                member = x_digits[i][k] == 1 || y_digits[j][k] == 1;
             }
+            g_vicsek_cells[j][i] = member;
         }
-    } else {
-        double new_size = size_fractal_coord / 3.0;
-
-        // Draw the 5 squares that form the cross pattern
-        // Center square
-        drawVicsekFractalRecursive(pixels, (Point){top_left_fractal_coord.x + new_size, top_left_fractal_coord.y + new_size}, new_size, depth - 1, color);
-        // Top middle square
-        drawVicsekFractalRecursive(pixels, (Point){top_left_fractal_coord.x + new_size, top_left_fractal_coord.y}, new_size, depth - 1, color);
-        // Bottom middle square
-        drawVicsekFractalRecursive(pixels, (Point){top_left_fractal_coord.x + new_size, top_left_fractal_coord.y + 2 * new_size}, new_size, depth - 1, color);
-        // Left middle square
-        drawVicsekFractalRecursive(pixels, (Point){top_left_fractal_coord.x, top_left_fractal_coord.y + new_size}, new_size, depth - 1, color);
-        // Right middle square
-        drawVicsekFractalRecursive(pixels, (Point){top_left_fractal_coord.x + 2 * new_size, top_left_fractal_coord.y + new_size}, new_size, depth - 1, color);
     }
 }
 
-// Function to orchestrate the Vicsek fractal calculation and rendering to texture
-void calculateAndRenderVicsek(SDL_Texture* texture, uint32_t* pixels) {
-    for (int i = 0; i < WIDTH * HEIGHT; ++i) {
-        pixels[i] = 0x00000000;
+// Levels to resolve below the anchor: the rest of the recursion depth, but no level
+// whose squares are a pixel or smaller, since those would cover the whole pixel anyway
+int vicsekVisibleLevels(void) {
+    double square_pixels = 1.0 / g_view.xx;
+    int levels = 0;
+    while (g_view.levels + levels < g_current_depth && levels < VICSEK_MASK_LEVELS && square_pixels > 1.0) {
+        square_pixels /= 3.0;
+        levels++;
     }
+    return levels;
+}
 
-    Point initial_fractal_top_left = {0.0, 0.0};
-    double initial_fractal_size = (double)WIDTH;
+// Digit mask of local coordinate t, tagged with the anchor cell it falls into
+uint64_t vicsekCellMask(double t, int levels) {
+    double cell = floor(t);
+    if (!(cell >= -1.0 && cell <= 1.0)) {
+        return 0;
+    }
+    return vicsekDigitMask(t - cell, levels) | VICSEK_CELL_BIT((int)cell);
+}
 
-    // White color for the fractal
-    SDL_Color fractal_color = {255, 255, 255, 255};
+void fillVicsekRows(VicsekWorker* worker) {
+    const uint32_t fractal_color = 0xFFFFFFFF;
+    uint64_t level_bits = (1ULL << worker->levels) - 1;
+    long long filled = 0;
+
+    for (int y = worker->first_row; y < worker->end_row; ++y) {
+        uint32_t* row = worker->pixels + (size_t)y * WIDTH;
+        double t = g_view.y0 + (y + 0.5) * g_view.yy;
+        double cell = floor(t);
+        if (!(cell >= -1.0 && cell <= 1.0)) {
+            memset(row, 0, WIDTH * sizeof(uint32_t));
+            continue;
+        }
+        uint64_t row_mask = vicsekDigitMask(t - cell, worker->levels);
+
+        // Levels where the row is not in the middle third need the column to be, and
+        // the column must not lie in a cell that is already empty above the anchor
+        uint64_t need = VICSEK_INSIDE_BIT | (~row_mask & level_bits);
+        uint64_t forbid = 0;
+        for (int i = 0; i < 3; ++i) {
+            if (!g_vicsek_cells[(int)cell + 1][i]) {
+                forbid |= VICSEK_CELL_BIT(i - 1);
+            }
+        }
+        const uint32_t need_low = (uint32_t)need, need_high = (uint32_t)(need >> 32);
+        const uint32_t forbid_high = (uint32_t)(forbid >> 32);  // The cell bits are all in the high word
+
+        int x = 0;
+#ifdef VICSEK_SSE2
+        const __m128i need_low4 = _mm_set1_epi32((int)need_low);
+        const __m128i need_high4 = _mm_set1_epi32((int)need_high);
+        const __m128i forbid_high4 = _mm_set1_epi32((int)forbid_high);
+        const __m128i color4 = _mm_set1_epi32((int)fractal_color);
+        const __m128i zero = _mm_setzero_si128();
+        __m128i members4 = zero;  // Minus the number of members in each lane
+        for (; x + 4 <= WIDTH; x += 4) {
+            __m128i low = _mm_load_si128((const __m128i*)(g_vicsek_column_low + x));
+            __m128i high = _mm_load_si128((const __m128i*)(g_vicsek_column_high + x));
+            __m128i member = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(low, need_low4), need_low4),
+                                           _mm_cmpeq_epi32(_mm_and_si128(high, need_high4), need_high4));
+            member = _mm_and_si128(member, _mm_cmpeq_epi32(_mm_and_si128(high, forbid_high4), zero));
+            _mm_storeu_si128((__m128i*)(row + x), _mm_and_si128(member, color4));
+            members4 = _mm_add_epi32(members4, member);
+        }
+        _Alignas(16) int32_t lane_counts[4];
+        _mm_store_si128((__m128i*)lane_counts, members4);
+        filled -= (long long)lane_counts[0] + lane_counts[1] + lane_counts[2] + lane_counts[3];
+#endif
+        for (; x < WIDTH; ++x) {
+            uint32_t low = g_vicsek_column_low[x], high = g_vicsek_column_high[x];
+            uint32_t member = ((low & need_low) == need_low) & ((high & need_high) == need_high) &
+                              ((high & forbid_high) == 0);
+            row[x] = fractal_color & (0u - member);
+            filled += member;
+        }
+    }
+    worker->filled = filled;
+}
 
-    printf("Rendering Vicsek Fractal with Depth: %d, View X: [%.2f, %.2f], Y: [%.2f, %.2f]\n", g_current_depth, g_view_x_min, g_view_x_max, g_view_y_min, g_view_y_max);
+int vicsekWorkerThread(void* data) {
+    VicsekWorker* worker = (VicsekWorker*)data;
+    Uint64 start = SDL_GetPerformanceCounter();
+    char lane_name[32];
+    snprintf(lane_name, sizeof(lane_name), "vicsek worker %d", worker->index);
+    trace_set_thread_name(lane_name);
 
-    drawVicsekFractalRecursive(pixels, initial_fractal_top_left, initial_fractal_size, g_current_depth, fractal_color);
+    fillVicsekRows(worker);
 
+    Uint64 end = SDL_GetPerformanceCounter();
+    worker->busy_ms = perf_ms_between(start, end);
+    trace_record("fill rows", start, end);
+    return 0;
+}
+
+// Fills 'pixels' for the current normalized view in bands of rows. Returns the number of
+// fractal pixels; the number of resolved levels goes to 'levels_out'.
+long long fillVicsekFrame(uint32_t* pixels, int* levels_out) {
+    classifyVicsekCells();
+    int levels = vicsekVisibleLevels();
+    for (int x = 0; x < WIDTH; ++x) {
+        uint64_t column_mask = vicsekCellMask(g_view.x0 + (x + 0.5) * g_view.xx, levels);
+        g_vicsek_column_low[x] = (uint32_t)column_mask;
+        g_vicsek_column_high[x] = (uint32_t)(column_mask >> 32);
+    }
+
+    // Each worker fills a band of rows; worker 0 runs on this thread
+    VicsekWorker workers[VICSEK_MAX_THREADS];
+    for (int t = 0; t < g_vicsek_thread_count; ++t) {
+        workers[t].index = t;
+        workers[t].first_row = HEIGHT * t / g_vicsek_thread_count;
+        workers[t].end_row = HEIGHT * (t + 1) / g_vicsek_thread_count;
+        workers[t].levels = levels;
+        workers[t].pixels = pixels;
+    }
+    SDL_Thread* threads[VICSEK_MAX_THREADS];
+    for (int t = 1; t < g_vicsek_thread_count; ++t) {
+        threads[t] = SDL_CreateThread(vicsekWorkerThread, "vicsek worker", &workers[t]);
+        if (threads[t] == NULL) {
+            vicsekWorkerThread(&workers[t]);  // Fall back to running it inline
+        }
+    }
+    vicsekWorkerThread(&workers[0]);
+    trace_set_thread_name("main");
+
+    double busy_ms = workers[0].busy_ms;
+    long long filled = workers[0].filled;
+    for (int t = 1; t < g_vicsek_thread_count; ++t) {
+        if (threads[t] != NULL) {
+            SDL_WaitThread(threads[t], NULL);
+        }
+        busy_ms += workers[t].busy_ms;
+        filled += workers[t].filled;
+    }
+    perf_add_iterations((long long)WIDTH * HEIGHT * levels);
+    perf_add_pixels((long long)WIDTH * HEIGHT);
+    perf_add_thread_time(g_vicsek_thread_count, busy_ms);
+    *levels_out = levels;
+    return filled;
+}
+
+// Function to orchestrate the Vicsek fractal calculation and rendering to texture
+void calculateAndRenderVicsek(SDL_Texture* texture, uint32_t* pixels) {
+    deep_view_normalize(&g_view);
+    double x_min, x_max, y_min, y_max;
+    getVicsekViewBounds(&x_min, &x_max, &y_min, &y_max);
+    printf("Rendering Vicsek Fractal with Depth: %d, View X: [%.2f, %.2f], Y: [%.2f, %.2f], Anchor Level: %d\n", g_current_depth, x_min, x_max, y_min, y_max, g_view.levels);
+
+    char view[160];
+    snprintf(view, sizeof(view), "X:[%.10g, %.10g] Y:[%.10g, %.10g] depth=%d anchor=%d zoom=1e%.2f",
+             x_min, x_max, y_min, y_max, g_current_depth, g_view.levels,
+             deep_view_zoom_log10(&g_view, WIDTH));
+    perf_set_view(view);
+    perf_begin(PERF_COMPUTE);
+    int levels;
+    long long filled = fillVicsekFrame(pixels, &levels);
+    perf_end(PERF_COMPUTE);
+
+    perf_begin(PERF_UPLOAD);
     SDL_UpdateTexture(texture, NULL, pixels, WIDTH * sizeof(uint32_t));
-    printf("Vicsek Fractal rendering complete.\n");
+    perf_end(PERF_UPLOAD);
+    printf("Vicsek Fractal rendering complete (%d levels, %lld pixels filled).\n", levels, filled);
+}
+
+// Fixed views pinned by 'make golden' (name, x_min, x_max, y_min, y_max, depth), in the
+// window coordinates of the reset view
+const GoldenView g_golden_views[] = {
+    {"whole", 0.0, 800.0, 0.0, 800.0, 5},
+    {"arm", 520.0, 560.0, 380.0, 420.0, 9},
+    {"deep", 533.33, 533.3302, 399.9999, 400.0001, 24},
+};
+
+// Renders a golden view through the same row fill as the window
+const uint32_t* renderVicsekGoldenView(const GoldenView* golden_view, int* pixel_count) {
+    static uint32_t pixels[WIDTH * HEIGHT];
+    deep_view_init(&g_view, 3, WIDTH, HEIGHT,
+                   golden_view->x_min / WIDTH, (golden_view->x_max - golden_view->x_min) / WIDTH / WIDTH, 0.0,
+                   golden_view->y_min / WIDTH, 0.0, (golden_view->y_max - golden_view->y_min) / HEIGHT / WIDTH);
+    deep_view_normalize(&g_view);
+    g_current_depth = golden_view->max_iterations;
+    int levels;
+    fillVicsekFrame(pixels, &levels);
+    *pixel_count = WIDTH * HEIGHT;
+    return pixels;
 }
 
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Golden-image regression check: render the fixed views headlessly and compare
+    GoldenOptions golden_options;
+    int golden_status = golden_parse_args(argc, argv, &golden_options);
+    if (golden_status != 0) {
+        if (golden_status < 0) return 1;
+        return golden_run_frames(&golden_options, "vicsek", g_golden_views, GOLDEN_VIEW_COUNT(g_golden_views),
+                                 renderVicsekGoldenView);
+    }
+
+    perf_init(argc, argv);
+
     printf("Vicsek Fractal Viewer\n");
     printf("Left Click + Drag: Pan the view\n");
     printf("Mouse Wheel: Zoom in/out (centered on mouse cursor)\n");
     printf("Up/Down Arrows: Adjust recursion depth\n");
     printf("R: Reset view\n");
+    printf("F1: Toggle performance HUD\n");
     printf("Click 'Save' button to save an image.\n");
 
     SDL_SetHint(SDL_HINT_RENDER_DRIVER, "wayland");
@@ -214,7 +435,12 @@ int main() {
 
     uint32_t pixels[WIDTH * HEIGHT];
 
+    g_vicsek_thread_count = SDL_GetCPUCount();
+    if (g_vicsek_thread_count < 1) g_vicsek_thread_count = 1;
+    if (g_vicsek_thread_count > VICSEK_MAX_THREADS) g_vicsek_thread_count = VICSEK_MAX_THREADS;
+
     // Initial calculation and render
+    resetVicsekView();
     calculateAndRenderVicsek(fractalTexture, pixels);
 
     SDL_Rect screenshotButtonRect = {WIDTH - 120, 10, 110, 30};
@@ -224,6 +450,7 @@ int main() {
 
     while (application_running) {
         while (SDL_PollEvent(&event)){
+            if (perf_handle_event(&event)) continue;
             switch (event.type) {
                 case SDL_QUIT:
                     application_running = false;
@@ -238,7 +465,9 @@ int main() {
                             mouseX <= screenshotButtonRect.x + screenshotButtonRect.w &&
                             mouseY >= screenshotButtonRect.y &&
                             mouseY <= screenshotButtonRect.y + screenshotButtonRect.h) {
+                            Uint64 trace_start = trace_begin();
                             saveScreenshot(renderer, "vicsek_fractal_screenshot.bmp");
+                            trace_end("screenshot", trace_start);
                         } else if (event.button.button == SDL_BUTTON_LEFT) {
                             g_is_panning = true;
                             g_last_mouse_x = mouseX;
@@ -256,21 +485,8 @@ int main() {
                         int mouseX = event.motion.x;
                         int mouseY = event.motion.y;
 
-                        // Calculate pixel difference
-                        int dx = mouseX - g_last_mouse_x;
-                        int dy = mouseY - g_last_mouse_y;
-
-                        // Map pixel difference to fractal coordinate difference
-                        double fractal_width = g_view_x_max - g_view_x_min;
-                        double fractal_height = g_view_y_max - g_view_y_min;
-
-                        double dx_fractal = (dx / (double)WIDTH) * fractal_width;
-                        double dy_fractal = (dy / (double)HEIGHT) * fractal_height;
-
-                        g_view_x_min -= dx_fractal;
-                        g_view_x_max -= dx_fractal;
-                        g_view_y_min -= dy_fractal;
-                        g_view_y_max -= dy_fractal;
+                        // Move the content with the mouse
+                        deep_view_pan(&g_view, mouseX - g_last_mouse_x, mouseY - g_last_mouse_y);
 
                         g_last_mouse_x = mouseX;
                         g_last_mouse_y = mouseY;
@@ -283,42 +499,29 @@ int main() {
                         int mouseX, mouseY;
                         SDL_GetMouseState(&mouseX, &mouseY);
 
-                        // Map mouse position to current fractal coordinates
-                        double current_fractal_x = g_view_x_min + (mouseX / (double)WIDTH) * (g_view_x_max - g_view_x_min);
-                        double current_fractal_y = g_view_y_min + (mouseY / (double)HEIGHT) * (g_view_y_max - g_view_y_min);
-
                         double zoom_factor;
                         if (event.wheel.y > 0) {
-                            zoom_factor = 0.8;
-                        } else if (event.wheel.y < 0) {
                             zoom_factor = 1.25;
+                        } else if (event.wheel.y < 0) {
+                            zoom_factor = 0.8;
                         } else {
                             break;
                         }
 
-                        // Calculate new view dimensions
-                        double new_width = (g_view_x_max - g_view_x_min) * zoom_factor;
-                        double new_height = (g_view_y_max - g_view_y_min) * zoom_factor;
-
-                        // Adjust view limits to zoom around the mouse cursor
-                        g_view_x_min = current_fractal_x - (new_width / 2.0);
-                        g_view_x_max = current_fractal_x + (new_width / 2.0);
-                        g_view_y_min = current_fractal_y - (new_height / 2.0);
-                        g_view_y_max = current_fractal_y + (new_height / 2.0);
+                        // Zoom around the point under the mouse and move it to the centre
+                        deep_view_zoom(&g_view, mouseX, mouseY, zoom_factor);
+                        deep_view_pan(&g_view, WIDTH / 2.0 - mouseX, HEIGHT / 2.0 - mouseY);
 
                         calculateAndRenderVicsek(fractalTexture, pixels);
                     }
                     break;
                 case SDL_KEYDOWN:
                     if (event.key.keysym.sym == SDLK_r) {
-                        g_view_x_min = 0.0;
-                        g_view_y_min = 0.0;
-                        g_view_x_max = (double)WIDTH;
-                        g_view_y_max = (double)HEIGHT;
+                        resetVicsekView();
                         g_current_depth = MAX_RECURSION_DEPTH;
                         calculateAndRenderVicsek(fractalTexture, pixels);
                     } else if (event.key.keysym.sym == SDLK_UP) {
-                        if (g_current_depth < MAX_RECURSION_DEPTH) {
+                        if (g_current_depth < VICSEK_DEPTH_LIMIT) {
                             g_current_depth++;
                             calculateAndRenderVicsek(fractalTexture, pixels);
                         }
@@ -335,27 +538,34 @@ int main() {
         // --- Rendering ---
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
+        perf_begin(PERF_DRAW);
         SDL_RenderCopy(renderer, fractalTexture, NULL, NULL);
+        perf_end(PERF_DRAW);
 
         // Render current view information
+        perf_begin(PERF_TEXT);
         if (font != NULL) {
             char text_buffer[200];
             SDL_Color textColor = {255, 255, 255, 255};
 
-            double initial_width = (double)WIDTH;
-            double current_width = g_view_x_max - g_view_x_min;
-            double current_zoom_level = initial_width / current_width;
+            double x_min, x_max, y_min, y_max;
+            getVicsekViewBounds(&x_min, &x_max, &y_min, &y_max);
+            double zoom_log10 = deep_view_zoom_log10(&g_view, WIDTH);
 
-            snprintf(text_buffer, sizeof(text_buffer), "View X: [%.2f, %.2f]", g_view_x_min, g_view_x_max);
+            snprintf(text_buffer, sizeof(text_buffer), "View X: [%.2f, %.2f]", x_min, x_max);
             renderText(renderer, font, text_buffer, 10, 10, textColor);
 
-            snprintf(text_buffer, sizeof(text_buffer), "View Y: [%.2f, %.2f]", g_view_y_min, g_view_y_max);
+            snprintf(text_buffer, sizeof(text_buffer), "View Y: [%.2f, %.2f]", y_min, y_max);
             renderText(renderer, font, text_buffer, 10, 40, textColor);
 
-            snprintf(text_buffer, sizeof(text_buffer), "Depth: %d (Max %d)", g_current_depth, MAX_RECURSION_DEPTH);
+            snprintf(text_buffer, sizeof(text_buffer), "Depth: %d (Max %d)", g_current_depth, VICSEK_DEPTH_LIMIT);
             renderText(renderer, font, text_buffer, 10, 70, textColor);
 
-            snprintf(text_buffer, sizeof(text_buffer), "Zoom: %.2fx", current_zoom_level);
+            if (zoom_log10 < 6.0) {
+                snprintf(text_buffer, sizeof(text_buffer), "Zoom: %.2fx", pow(10.0, zoom_log10));
+            } else {
+                snprintf(text_buffer, sizeof(text_buffer), "Zoom: 10^%.1fx", zoom_log10);
+            }
             renderText(renderer, font, text_buffer, 10, 100, textColor);
 
             renderText(renderer, font, "Left Click + Drag: Pan, Mouse Wheel: Zoom, Up/Down: Depth, R: Reset", 10, HEIGHT - 20, textColor);
@@ -370,11 +580,17 @@ int main() {
             SDL_Color buttonTextColor = {255, 255, 255, 255};
             renderText(renderer, font, "Save", screenshotButtonRect.x + 8, screenshotButtonRect.y + 5, buttonTextColor);
         }
+        perf_end(PERF_TEXT);
+        perf_draw_hud(renderer, font);
 
+        perf_begin(PERF_PRESENT);
         SDL_RenderPresent(renderer);
+        perf_end(PERF_PRESENT);
+        perf_frame_end();
     }
 
     // --- Cleanup ---
+    perf_shutdown();
     SDL_DestroyTexture(fractalTexture);
     if (font != NULL) {
         TTF_CloseFont(font);